@@ -20,10 +20,23 @@
 #include "system_interrupts.h"
 #include "system_control.h"
 #include "system_stdlib.h"
+#include "system_gdc_io.h"
+#include "system_firmware.h"
+#include "system_debugfs.h"
+#include "system_spinlock.h"
+#include "system_dma_alloc.h"
+#include "system_fence.h"
+#include "system_timer.h"
 #include "system_log.h"
 
 //gdc api functions
 #include "acamera_gdc_api.h"
+#include "acamera_gdc_seq.h"
+#include "acamera_gdc_cache.h"
+#include "acamera_gdc_upload.h"
+#include "acamera_gdc_sched.h"
+#include "acamera_gdc_pool.h"
+#include "acamera_gdc_dmabuf.h"
 
 #if HAS_FPGA_WRAPPER
 //fpga related functions
@@ -31,12 +44,6 @@
 #endif
 
 
-//gdc configuration sequences
-#include "gdc_config_seq_semiplanar_yuv420.h"
-#include "gdc_config_seq_plane_y.h"
-#include "gdc_config_seq_planar_yuv420.h"
-#include "gdc_config_seq_planar_rgb444.h"
-
 //test cases available
 enum test_cases{
 	test_yuv420_semiplanar=0,
@@ -48,10 +55,8 @@ enum test_cases{
 };
 
 struct _gdc_test_param{
-	const unsigned char * gdc_sequence;
-	uint32_t gdc_sequence_size;
+	const char * gdc_format; //configuration sequence loaded as firmware for this format and the output resolution
 	uint32_t total_planes;
-	uint32_t input_addresses[ACAMERA_GDC_MAX_INPUT];
 	uint8_t  sequential_mode;
 	uint8_t  div_width; //use in dividing UV dimensions; actually a shift right
 	uint8_t  div_height; //use in dividing UV dimensions; actually a shift right
@@ -60,50 +65,40 @@ struct _gdc_test_param{
 //settings for each test case
 struct _gdc_test_param gdc_test_param[max_gdc_test_cases]={
 	{//test_yuv420_semiplanar
-		.gdc_sequence=semiplanar_yuv420_1920x1080_seq, //gdc_sequence
-		.gdc_sequence_size=sizeof(semiplanar_yuv420_1920x1080_seq),
+		.gdc_format="semiplanar_yuv420", //gdc_format
 		.total_planes=2, 		//total_planes
-		.input_addresses={0x1000000, 0x2000000},//input_addresses
 		.sequential_mode=0, 		//plane_sequential_processing
 		.div_width=0, 		//div_width
 		.div_height=1 		//div_height
 
 	},
 	{//test_y_plane
-		.gdc_sequence=y_plane_1920x1080_seq, //gdc_sequence
-		.gdc_sequence_size=sizeof(y_plane_1920x1080_seq),
+		.gdc_format="y_plane", //gdc_format
 		.total_planes=1, 		//total_planes
-		.input_addresses={0x1000000},//input_addresses
 		.sequential_mode=0, 		//plane_sequential_processing
 		.div_width=0, 		//div_width
 		.div_height=0 		//div_height
 
 	},
 	{//test_yuv420_planar
-		.gdc_sequence=planar_yuv420_1920x1080_seq, //gdc_sequence
-		.gdc_sequence_size=sizeof(planar_yuv420_1920x1080_seq),
+		.gdc_format="planar_yuv420", //gdc_format
 		.total_planes=3, 		//total_planes
-		.input_addresses={0x1000000, 0x2000000,0x3000000},//input_addresses
 		.sequential_mode=0, 		//plane_sequential_processing
 		.div_width=1, 		//div_width
 		.div_height=1 		//div_height
 
 	},
 	{//test_rgb_444_planar
-		.gdc_sequence=planar_rgb444_1920x1080_seq, //gdc_sequence
-		.gdc_sequence_size=sizeof(planar_rgb444_1920x1080_seq),
+		.gdc_format="planar_rgb444", //gdc_format
 		.total_planes=3, 		//total_planes
-		.input_addresses={0x1000000, 0x2000000,0x3000000},//input_addresses
 		.sequential_mode=0, 		//plane_sequential_processing
 		.div_width=0, 		//div_width
 		.div_height=0 		//div_height
 
 	},
 	{//test_sequential_planes
-		.gdc_sequence=y_plane_1920x1080_seq, //gdc_sequence is same as the single plane Y sequence
-		.gdc_sequence_size=sizeof(y_plane_1920x1080_seq),
+		.gdc_format="y_plane", //gdc_format is same as the single plane Y sequence
 		.total_planes=3, 		//total_planes
-		.input_addresses={0x1000000, 0x2000000,0x3000000},//input_addresses
 		.sequential_mode=1, 		//plane_sequential_processing
 		.div_width=0, 		//div_width
 		.div_height=0 		//div_height
@@ -121,109 +116,678 @@ static void get_frame_buffer_callback(  uint32_t total_input, uint32_t * out_add
 }
 
 
-//this is the main interrupt handler, for demo purposes gdc status and data are currently not passed
-static void interrupt_handler( void *param, uint32_t mask )
+//one gdc_settings_t per core, frames are spread over the cores by the scheduler
+static gdc_settings_t gdc_settings[GDC_NUM_CORES];
+static gdc_sched_t gdc_sched;
+//cores whose registers were found, gdc_fw_exit only touches those
+static uint32_t gdc_cores_found;
+
+//output frames come from the memory of core 0, whichever core writes them
+static gdc_pool_t gdc_output_pool;
+
+//frame handed to the display, its slot goes back to the pool when the next frame replaces it
+static uint32_t gdc_shown_addr;
+
+//memory of the block, the platform places it and hands back the addresses the block uses
+static sys_dma_mem gdc_config_mem;
+static sys_dma_mem gdc_input_mem;
+static sys_dma_mem gdc_output_mem;
+
+//planes of the test input frame, written by the fpga dma writers on the target
+#define GDC_INPUT_PLANE_SIZE ( 1920 * 1080 )
+
+//input frames the fpga dma writers cycle through: one for each frame in flight, the one being
+//written, the last complete one and a spare, so capture never waits for the gdc
+#if HAS_FPGA_WRAPPER
+#define GDC_INPUT_BUFFERS ( 2 * GDC_NUM_CORES + 3 )
+#if GDC_INPUT_BUFFERS > ACAMERA_FPGA_RING_MAX_BUFFERS
+#error "the fpga writer ring has no buffer for every frame in flight"
+#endif
+#else
+#define GDC_INPUT_BUFFERS 1
+#endif
+static uint32_t gdc_input_addr[ACAMERA_GDC_MAX_INPUT];
+
+//stream of the test frames
+#define GDC_TEST_STREAM 0
+
+//in plane split mode a frame runs as a luma part and a chroma part on different cores
+#define GDC_SPLIT_PARTS 2
+static const uint8_t gdc_split_channels[GDC_SPLIT_PARTS] = {0x1, 0x6};
+static int gdc_plane_split;
+static struct {
+    uint32_t config_addr;
+    uint32_t config_size;
+} gdc_split_config[GDC_SPLIT_PARTS];
+
+//queues a frame on the scheduler, the configuration is that of core 0
+static int gdc_submit_frame( uint32_t stream, const uint32_t *in_addr, const uint32_t *out_addr, sys_fence in_fence, sys_fence out_fence )
 {
-    //handle the start of frame with acamera_gdc_process
-    gdc_settings_t *gdc_settings = (gdc_settings_t *)param;
+    gdc_job_t job[GDC_SPLIT_PARTS];
+    uint32_t i;
+
+    system_memset( &job[0], 0, sizeof( job[0] ) );
+    job[0].in_fence = in_fence;
+    job[0].out_fence = out_fence;
+    job[0].num_input = gdc_test_param[GDC_TEST_RUN].total_planes;
+    for ( i = 0; i < job[0].num_input; i++ ) {
+        job[0].input_addr[i] = in_addr[i];
+        job[0].output_addr[i] = out_addr[i];
+    }
+    job[0].config_addr = gdc_settings[0].gdc_config.config_addr;
+    job[0].config_size = gdc_settings[0].gdc_config.config_size;
+    if ( !gdc_plane_split ) {
+        return acamera_gdc_sched_submit( &gdc_sched, stream, &job[0] );
+    }
+    //every part addresses all planes, its sequence only has the tiles of its channels
+    for ( i = 0; i < GDC_SPLIT_PARTS; i++ ) {
+        job[i] = job[0];
+        job[i].config_addr = gdc_split_config[i].config_addr;
+        job[i].config_size = gdc_split_config[i].config_size;
+    }
+    return acamera_gdc_sched_submit_split( &gdc_sched, stream, job, GDC_SPLIT_PARTS );
+}
 
-    //gdc block has finished processing
-    if ( mask ) { //can filter mask
-        //gdc will save the new frame reader settings
-        //will update the frame reader settings via callback
+//queues a frame writing to a slot of the output pool
+static int gdc_queue_frame( uint32_t *in_addr )
+{
+    uint32_t out_addr[ACAMERA_GDC_MAX_INPUT];
 
-        if ( acamera_gdc_get_frame( gdc_settings,gdc_test_param[GDC_TEST_RUN].total_planes ) != 0 ) {
-        	return;
-        }
+    if ( acamera_gdc_pool_acquire( &gdc_output_pool, out_addr ) != 0 ) {
+        LOG( LOG_DEBUG, "No free GDC output slot, retrying" );
+        return -1;
+    }
+    if ( gdc_submit_frame( GDC_TEST_STREAM, in_addr, out_addr, NULL, NULL ) != 0 ) {
+        LOG( LOG_DEBUG, "GDC scheduler refused the frame, retrying" );
+        acamera_gdc_pool_release( &gdc_output_pool, out_addr[0] );
+        return -1;
+    }
+    return 0;
+}
 
+//queues the next test frame, on the fpga the last frame of the dma writers, kept from them until it has completed
+static int gdc_queue_next_frame( void )
+{
 #if HAS_FPGA_WRAPPER
-        //get gdc buffer input from fpga writer output
-        uint32_t in_addr[gdc_test_param[GDC_TEST_RUN].total_planes];
-        uint32_t in_lineoffset[gdc_test_param[GDC_TEST_RUN].total_planes];
-        if(acamera_fpga_get_frame_writer( gdc_test_param[GDC_TEST_RUN].total_planes,in_addr,in_lineoffset )!=0){
-			LOG( LOG_CRIT, "Cannot get frame_writer_addresses" );
-		}else if( acamera_gdc_process( gdc_settings, gdc_test_param[GDC_TEST_RUN].total_planes,in_addr ) != 0 ) {
-			LOG( LOG_CRIT, "GDC missed an interrupt" );
-		}
+    uint32_t in_addr[ACAMERA_GDC_MAX_INPUT];
+    uint32_t in_lineoffset[ACAMERA_GDC_MAX_INPUT];
 
+    //before the first frame and when the writer just started on the buffer
+    if ( acamera_fpga_get_frame_writer( gdc_test_param[GDC_TEST_RUN].total_planes, in_addr, in_lineoffset ) != 0 ) {
+        LOG( LOG_DEBUG, "No complete frame from the fpga dma writers yet" );
+        return -1;
+    }
+    if ( gdc_queue_frame( in_addr ) != 0 ) {
+        acamera_fpga_release_frame( in_addr[0] );
+        return -1;
+    }
+    return 0;
 #else
-        if ( acamera_gdc_process( gdc_settings,gdc_test_param[GDC_TEST_RUN].total_planes, gdc_test_param[GDC_TEST_RUN].input_addresses) != 0 ) {
-			LOG( LOG_CRIT, "GDC missed an interrupt" );
-		}
+    return gdc_queue_frame( gdc_input_addr );
 #endif
+}
+
+//test frames owed to the loop, a refill that found no input or no room is tried again
+//by the next completion or by the retry timer so the loop keeps all its frames
+#define GDC_REFILL_RETRY_NS 1000000
+static uint32_t gdc_refill_owed;
+static sys_spinlock gdc_refill_lock;
+static sys_timer gdc_refill_timer;
+
+//queues frames owed to the test loop, the queueing runs unlocked as it may complete other frames
+static void gdc_refill( uint32_t frames )
+{
+    unsigned long flags;
+    int rc = 0;
+
+    flags = system_spinlock_lock( gdc_refill_lock );
+    gdc_refill_owed += frames;
+    while ( gdc_refill_owed && rc == 0 ) {
+        gdc_refill_owed--;
+        system_spinlock_unlock( gdc_refill_lock, flags );
+        rc = gdc_queue_next_frame();
+        flags = system_spinlock_lock( gdc_refill_lock );
+        if ( rc != 0 ) {
+            gdc_refill_owed++;
+        }
+    }
+    if ( gdc_refill_owed && gdc_refill_timer ) {
+        system_timer_arm( gdc_refill_timer, GDC_REFILL_RETRY_NS );
+    }
+    system_spinlock_unlock( gdc_refill_lock, flags );
+}
 
+//thread handler of the retry timer
+static void gdc_refill_retry( void *param )
+{
+    gdc_refill( 0 );
+}
+
+//frames in dma-bufs of other devices, the imports are held until the frame has completed
+#define GDC_DMABUF_FRAMES 16
+
+//stream of the dma-buf frames, delivered in their own order next to the test frames
+#define GDC_DMABUF_STREAM 1
+
+typedef struct gdc_dmabuf_job {
+    int used;
+    int pooled;                 //output in a slot of the pool, shown like the test frames
+    uint32_t output_addr;       //first output plane, identifies the frame on completion
+    gdc_dmabuf_frame_t input;
+    gdc_dmabuf_frame_t output;
+} gdc_dmabuf_job_t;
+
+static gdc_dmabuf_job_t gdc_dmabuf_jobs[GDC_DMABUF_FRAMES];
+static sys_spinlock gdc_dmabuf_lock;
+
+static void gdc_dmabuf_job_free( gdc_dmabuf_job_t *entry )
+{
+    unsigned long flags;
+
+    acamera_gdc_dmabuf_release( &entry->input );
+    acamera_gdc_dmabuf_release( &entry->output );
+    flags = system_spinlock_lock( gdc_dmabuf_lock );
+    entry->used = 0;
+    system_spinlock_unlock( gdc_dmabuf_lock, flags );
+}
+
+/**
+ *   Queue a frame held in dma-bufs
+ *
+ *   The buffers are imported for the gdc, planes may share a buffer at
+ *   different offsets. Without output buffers the frame is written to a slot
+ *   of the output pool and shown like the test frames.
+ *
+ *   The frame can be queued before its input is written, it starts once the
+ *   in-fence signals. The out-fence signals when the output is written, or
+ *   with an error when the frame failed.
+ *
+ *   @param  in_fd - dma-buf of each input plane
+ *   @param  in_offset - byte offset of each input plane, NULL for 0
+ *   @param  out_fd - dma-buf of each output plane, NULL for a pool slot
+ *   @param  out_offset - byte offset of each output plane, NULL for 0
+ *   @param  in_fence_fd - sync_file signalled by the producer of the input, -1 when the input is ready
+ *   @param  out_fence_fd - filled with a sync_file for the consumers of the output, NULL for none
+ *
+ *   @return 0 - success
+ *           -1 - a buffer or fence cannot be used or the queue is full.
+ */
+int gdc_queue_dmabuf_frame( const int *in_fd, const uint32_t *in_offset, const int *out_fd, const uint32_t *out_offset, int in_fence_fd, int *out_fence_fd )
+{
+    uint32_t in_addr[ACAMERA_GDC_MAX_INPUT];
+    uint32_t out_addr[ACAMERA_GDC_MAX_INPUT];
+    gdc_dmabuf_job_t *entry = NULL;
+    sys_fence in_fence = NULL, out_fence = NULL, out_ref = NULL;
+    unsigned long flags;
+    uint32_t i;
+
+    if ( gdc_dmabuf_lock == NULL ) {
+        return -1;
+    }
+    flags = system_spinlock_lock( gdc_dmabuf_lock );
+    for ( i = 0; i < GDC_DMABUF_FRAMES; i++ ) {
+        if ( !gdc_dmabuf_jobs[i].used ) {
+            entry = &gdc_dmabuf_jobs[i];
+            entry->used = 1;
+            entry->output_addr = 0;
+            break;
+        }
+    }
+    system_spinlock_unlock( gdc_dmabuf_lock, flags );
+    if ( entry == NULL ) {
+        LOG( LOG_ERR, "Too many GDC dma-buf frames in flight" );
+        return -1;
+    }
+
+    //importing may sleep, the entry is reserved but not visible to the completion yet
+    system_memset( &entry->output, 0, sizeof( entry->output ) );
+    entry->pooled = out_fd == NULL;
+    if ( acamera_gdc_dmabuf_import( &entry->input, &gdc_settings[0], in_fd, in_offset, 0, in_addr ) != 0 ||
+         ( out_fd ? acamera_gdc_dmabuf_import( &entry->output, &gdc_settings[0], out_fd, out_offset, 1, out_addr )
+                  : acamera_gdc_pool_acquire( &gdc_output_pool, out_addr ) ) != 0 ) {
+        gdc_dmabuf_job_free( entry );
+        return -1;
+    }
+
+    //the scheduler drops its out-fence handle on delivery, the second one stays here for the export
+    if ( ( in_fence_fd >= 0 && system_fence_import( &in_fence, in_fence_fd ) != 0 ) ||
+         ( out_fence_fd && ( system_fence_create( &out_fence ) != 0 || system_fence_dup( out_fence, &out_ref ) != 0 ) ) ) {
+        goto fail;
+    }
+
+    flags = system_spinlock_lock( gdc_dmabuf_lock );
+    entry->output_addr = out_addr[0];
+    system_spinlock_unlock( gdc_dmabuf_lock, flags );
+
+    if ( gdc_submit_frame( GDC_DMABUF_STREAM, in_addr, out_addr, in_fence, out_fence ) != 0 ) {
+        goto fail;
+    }
+    if ( out_ref ) {
+        if ( system_fence_export( out_ref, out_fence_fd ) != 0 ) {
+            //the frame is queued, only its fence cannot be waited on
+            LOG( LOG_ERR, "Failed to export the out-fence of a GDC frame" );
+            *out_fence_fd = -1;
+        }
+        system_fence_put( out_ref );
+    }
+    return 0;
+
+fail:
+    system_fence_put( in_fence );
+    system_fence_put( out_fence );
+    system_fence_put( out_ref );
+    if ( entry->pooled ) {
+        acamera_gdc_pool_release( &gdc_output_pool, out_addr[0] );
+    }
+    gdc_dmabuf_job_free( entry );
+    return -1;
+}
+
+/**
+ *   Export a slot of the output pool as a dma-buf
+ *
+ *   Other devices and user space map the frames written to the slot through
+ *   the descriptor, plane n starts at plane_offset[n] of the pool.
+ *
+ *   @param  slot - slot number
+ *   @param  fd - filled with the descriptor
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int gdc_export_output_slot( uint32_t slot, int *fd )
+{
+    return acamera_gdc_dmabuf_export_slot( &gdc_output_pool, slot, fd );
+}
+
+//dma-buf frame a completed job belongs to, taken out of the table
+static gdc_dmabuf_job_t *gdc_dmabuf_job_take( uint32_t output_addr )
+{
+    gdc_dmabuf_job_t *entry = NULL;
+    unsigned long flags;
+    uint32_t i;
+
+    if ( gdc_dmabuf_lock == NULL ) {
+        return NULL;
+    }
+    flags = system_spinlock_lock( gdc_dmabuf_lock );
+    for ( i = 0; i < GDC_DMABUF_FRAMES; i++ ) {
+        if ( gdc_dmabuf_jobs[i].used && gdc_dmabuf_jobs[i].output_addr == output_addr ) {
+            entry = &gdc_dmabuf_jobs[i];
+            //no longer matched, the slot stays reserved until the imports are released
+            entry->output_addr = 0;
+            break;
+        }
+    }
+    system_spinlock_unlock( gdc_dmabuf_lock, flags );
+    return entry;
+}
+
+//frames handed to gdc_frame_done, the callbacks of all streams run one at a time
+static uint32_t gdc_frames_completed;
+static uint32_t gdc_frames_failed;
+
+//frames of the stream arrive here in submit order, whichever core processed them
+static void gdc_frame_done( void *ctx, const gdc_job_t *job )
+{
+    gdc_dmabuf_job_t *entry = gdc_dmabuf_job_take( job->output_addr[0] );
+    int pooled = entry == NULL || entry->pooled;
+
+    gdc_frames_completed++;
+    if ( job->status.error ) {
+        gdc_frames_failed++;
+    }
+
+    if ( entry ) {
+        //the block is done with the buffers of the other devices
+        gdc_dmabuf_job_free( entry );
+    }
+
+    if ( !pooled ) {
+        //the output belongs to the device that queued the frame
+        if ( job->status.error ) {
+            LOG( LOG_ERR, "GDC dma-buf frame %u finished with status 0x%x", job->frame, job->status.raw );
+        }
+    } else if ( job->status.error ) {
+        //a broken frame is not shown, the previous one stays on the display
+        LOG( LOG_ERR, "GDC frame %u finished with status 0x%x", job->frame, job->status.raw );
+        acamera_gdc_pool_release( &gdc_output_pool, job->output_addr[0] );
+    } else {
+        get_frame_buffer_callback( job->num_input, (uint32_t *)job->output_addr, (uint32_t *)job->output_lineoffset );
+        if ( gdc_shown_addr ) {
+            acamera_gdc_pool_release( &gdc_output_pool, gdc_shown_addr );
+        }
+        gdc_shown_addr = job->output_addr[0];
+    }
+    if ( entry ) {
+        //frames queued from dma-bufs are not part of the test loop
+        return;
+    }
+
+#if HAS_FPGA_WRAPPER
+    //the dma writers may fill the input buffer again
+    acamera_fpga_release_frame( job->input_addr[0] );
+#endif
+    //refill the queue, the next frames were already started from it
+    gdc_refill( 1 );
+}
+
+//this is the main interrupt handler of each core, it runs in interrupt context
+static void interrupt_handler( void *param, uint32_t mask )
+{
+    gdc_settings_t *gdc_settings = (gdc_settings_t *)param;
+
+    //gdc block has finished processing
+    if ( mask ) { //can filter mask
+        //the core latches the status of the completed job and starts its next job
+        acamera_gdc_latch_frame( gdc_settings );
     }
 }
 
+//threaded part of the interrupt, completed frames go to the scheduler with interrupts enabled
+static void interrupt_thread_handler( void *param, uint32_t mask )
+{
+    acamera_gdc_complete_frames( (gdc_settings_t *)param );
+}
+
+static gdc_upload_t gdc_config_upload;
+
 //we need to copy the gdc configuration sequence to the gdc config address
 uint32_t gdc_load_settings_to_memory( uint32_t * config_mem_start, uint32_t *config_settings_start, uint32_t config_size )
 {
-    uint32_t i = 0;
-    system_memcpy( config_mem_start, config_settings_start, config_size * 4 );
-    for ( i = 0; i < config_size; i++ ) {
-        if ( config_mem_start[i] != config_settings_start[i] ) {
-            LOG( LOG_CRIT, "GDC config mismatch index %ld, values %lX vs %lX\n", i, config_mem_start[i], config_settings_start[i] );
-            return 0;
+    return acamera_gdc_upload( &gdc_config_upload, config_mem_start, config_settings_start, config_size );
+}
+
+//region holding the cached configuration sequences
+#define GDC_CONFIG_REGION_SIZE 0x40000
+#define GDC_CONFIG_SLOTS 8
+
+static gdc_cache_t gdc_config_cache;
+
+//frames kept in flight, the scheduler gives each core one running and one queued
+#define GDC_QUEUED_FRAMES ( 2 * GDC_NUM_CORES )
+
+//output frames: the queued ones being written, the one on display and one for a frame queued from dma-bufs
+#define GDC_OUTPUT_SLOTS ( GDC_QUEUED_FRAMES + 2 )
+
+//hash and size of the sequence of each test case once it was loaded, so a repeat selection needs no firmware request
+static struct {
+    u64 hash;
+    uint32_t size;
+} gdc_seq_loaded[max_gdc_test_cases];
+
+//requests the configuration sequence of a test case as firmware and checks it against the gdc block
+static int gdc_request_sequence( gdc_settings_t *gdc_settings, uint32_t test_case, system_firmware_t *seq_fw, char *seq_name )
+{
+    //the configuration sequence is a firmware file selected by format and resolution
+    if ( acamera_gdc_seq_firmware_name( seq_name, ACAMERA_GDC_SEQ_NAME_SIZE, gdc_test_param[test_case].gdc_format,
+                                        gdc_settings->gdc_config.output_width, gdc_settings->gdc_config.output_height ) != 0 ||
+         system_firmware_request( seq_fw, seq_name ) != 0 ) {
+        LOG( LOG_CRIT, "GDC configuration sequence for %s not available", gdc_test_param[test_case].gdc_format );
+        return -1;
+    }
+
+    //reject a sequence the block would flag as a configuration error
+    if ( acamera_gdc_check_sequence( gdc_settings, (const uint32_t *)seq_fw->data, seq_fw->size ) != 0 ) {
+        LOG( LOG_CRIT, "GDC configuration sequence %s does not fit the gdc block", seq_name );
+        system_firmware_release( seq_fw );
+        return -1;
+    }
+    return 0;
+}
+
+//points gdc_config at the sequence of a test case, the sequence is only copied when it is not in the cache
+static int gdc_select_sequence( gdc_settings_t *gdc_settings, uint32_t test_case )
+{
+    char seq_name[ACAMERA_GDC_SEQ_NAME_SIZE];
+    system_firmware_t seq_fw;
+    uint32_t config_addr;
+    int rc;
+
+    if ( gdc_seq_loaded[test_case].size && acamera_gdc_cache_lookup( &gdc_config_cache, gdc_seq_loaded[test_case].hash, gdc_seq_loaded[test_case].size, &config_addr ) == 0 ) {
+        gdc_settings->gdc_config.config_addr = config_addr;
+        gdc_settings->gdc_config.config_size = gdc_seq_loaded[test_case].size / 4;
+        return 0;
+    }
+
+    if ( gdc_request_sequence( gdc_settings, test_case, &seq_fw, seq_name ) != 0 ) {
+        return -1;
+    }
+    rc = 0;
+    if ( acamera_gdc_cache_get( &gdc_config_cache, (const uint32_t *)seq_fw.data, seq_fw.size, &config_addr ) < 0 ) {
+        LOG( LOG_CRIT, "memory config for gdc sequence %s failed", seq_name );
+        rc = -1;
+    } else {
+        gdc_settings->gdc_config.config_addr = config_addr;
+        gdc_settings->gdc_config.config_size = seq_fw.size / 4; //size of configuration in 4bytes
+        gdc_seq_loaded[test_case].hash = acamera_gdc_cache_hash( (const uint32_t *)seq_fw.data, seq_fw.size );
+        gdc_seq_loaded[test_case].size = seq_fw.size;
+        LOG( LOG_INFO, "Done gdc load of %s to 0x%X..\n", seq_name, config_addr );
+    }
+    system_firmware_release( &seq_fw );
+    return rc;
+}
+
+//one sequence per part for plane split mode, built from the sequence of the test case
+static uint32_t gdc_split_buf[GDC_CONFIG_REGION_SIZE / GDC_CONFIG_SLOTS / 4];
+
+//loads the luma and chroma parts of the sequence of a test case into the cache
+static int gdc_select_split( gdc_settings_t *gdc_settings, uint32_t test_case )
+{
+    char seq_name[ACAMERA_GDC_SEQ_NAME_SIZE];
+    system_firmware_t seq_fw;
+    gdc_seq_t seq;
+    uint32_t i, size;
+    int rc = 0;
+
+    if ( gdc_request_sequence( gdc_settings, test_case, &seq_fw, seq_name ) != 0 ) {
+        return -1;
+    }
+    if ( acamera_gdc_seq_parse( seq_fw.data, seq_fw.size, &seq ) != 0 ) {
+        rc = -1;
+    }
+    for ( i = 0; rc == 0 && i < GDC_SPLIT_PARTS; i++ ) {
+        size = acamera_gdc_seq_split( &seq, gdc_split_channels[i], gdc_split_buf, sizeof( gdc_split_buf ) );
+        if ( size == 0 || acamera_gdc_cache_get( &gdc_config_cache, gdc_split_buf, size, &gdc_split_config[i].config_addr ) < 0 ) {
+            LOG( LOG_CRIT, "GDC sequence %s cannot be split for channels 0x%X", seq_name, gdc_split_channels[i] );
+            rc = -1;
+        } else {
+            gdc_split_config[i].config_size = size / 4;
+        }
+    }
+    system_firmware_release( &seq_fw );
+    return rc;
+}
+
+//mode switch to the sequence of another test case with the same planes, frames queued afterwards use it
+int gdc_fw_switch_sequence( uint32_t test_case )
+{
+    uint32_t core;
+
+    if ( test_case >= max_gdc_test_cases || gdc_test_param[test_case].total_planes != gdc_settings[0].gdc_config.total_planes ) {
+        LOG( LOG_ERR, "GDC test case %u cannot replace the running one", test_case );
+        return -1;
+    }
+    if ( gdc_select_sequence( &gdc_settings[0], test_case ) != 0 ||
+         ( gdc_plane_split && gdc_select_split( &gdc_settings[0], test_case ) != 0 ) ) {
+        return -1;
+    }
+    for ( core = 0; core < GDC_NUM_CORES; core++ ) {
+        if ( acamera_gdc_set_config( &gdc_settings[core], gdc_settings[0].gdc_config.config_addr, gdc_settings[0].gdc_config.config_size ) != 0 ) {
+            return -1;
         }
     }
+    return 0;
+}
+
+static sys_debugfs gdc_latency_file;
 
-    return config_size * 4;
+//latency report of every core, p50/p99 are the upper ends of their log2 buckets
+static uint32_t gdc_latency_show( void *param, char *buf, uint32_t size )
+{
+    gdc_stats_t stats;
+    uint32_t core, stage, pos = 0;
+
+    for ( core = 0; core < GDC_NUM_CORES && pos < size; core++ ) {
+        acamera_gdc_stats_get( &gdc_settings[core].stats, &stats );
+        pos += snprintf( buf + pos, size - pos, "core %u: %u jobs\n%-10s %12s %12s %12s\n", core,
+                         stats.stages[ACAMERA_GDC_STAGE_TOTAL].count, "stage", "p50 ns", "p99 ns", "max ns" );
+        for ( stage = 0; stage < ACAMERA_GDC_STAGES && pos < size; stage++ ) {
+            const gdc_hist_t *hist = &stats.stages[stage];
+            pos += snprintf( buf + pos, size - pos, "%-10s %12llu %12llu %12llu\n", acamera_gdc_stats_stage_name( stage ),
+                             acamera_gdc_stats_percentile( hist, 50 ), acamera_gdc_stats_percentile( hist, 99 ), hist->max_ns );
+        }
+    }
+    return pos < size ? pos : size;
 }
 
+//writing to the report starts a new measurement
+static void gdc_latency_clear( void *param )
+{
+    uint32_t core;
+
+    for ( core = 0; core < GDC_NUM_CORES; core++ ) {
+        acamera_gdc_stats_clear( &gdc_settings[core].stats );
+    }
+}
+
+static void gdc_free_memory( void )
+{
+    system_dma_free( gdc_config_mem );
+    system_dma_free( gdc_input_mem );
+    system_dma_free( gdc_output_mem );
+    gdc_config_mem = gdc_input_mem = gdc_output_mem = NULL;
+}
+
+//configuration region, input frame and output frames, each one contiguous
+static int gdc_alloc_memory( uint32_t planes, uint32_t output_size, void **config_mem, uint32_t *config_addr, uint32_t *output_addr )
+{
+    uint32_t i, input_addr;
+    void *virt;
+
+    if ( system_dma_alloc( &gdc_config_mem, GDC_CONFIG_REGION_SIZE, config_mem, config_addr ) != 0 ||
+         system_dma_alloc( &gdc_input_mem, GDC_INPUT_BUFFERS * planes * GDC_INPUT_PLANE_SIZE, &virt, &input_addr ) != 0 ||
+         system_dma_alloc( &gdc_output_mem, output_size, &virt, output_addr ) != 0 ) {
+        gdc_free_memory();
+        return -1;
+    }
+    for ( i = 0; i < planes; i++ ) {
+        gdc_input_addr[i] = input_addr + i * GDC_INPUT_PLANE_SIZE;
+    }
+    return 0;
+}
+
+int gdc_fw_exit( void );
+
 // The basic example of usage gdc is given below.
 int gdc_fw_init( void )
 {
-
-    static gdc_settings_t gdc_settings;
+    gdc_settings_t *cores[GDC_NUM_CORES];
+    uint32_t core;
+    //room for every output slot, each plane padded to a burst boundary and each slot to a page
+    uint32_t output_size = GDC_OUTPUT_SLOTS * ( ( 1920 * 1080 + ACAMERA_GDC_POOL_ALIGN ) * gdc_test_param[GDC_TEST_RUN].total_planes + ACAMERA_GDC_POOL_SLOT_ALIGN );
+    uint32_t output_addr, config_addr;
+    void *config_mem;
 
     // The custom platform must be ready to run
     // any system routines from ./platform folder.
     // So bsp_init allows to initialise the system if necessary.
     // This function may be omitted if no initialisation is required
     bsp_init();
-    system_interrupts_disable();
-    //configure gdc config, buffer address and resolution
-    gdc_settings.base_gdc = 0;
-    gdc_settings.buffer_addr = 0x8000000;
-    gdc_settings.buffer_size = 1920*1080*gdc_test_param[GDC_TEST_RUN].total_planes;
-    gdc_settings.get_frame_buffer = get_frame_buffer_callback;
-    gdc_settings.current_addr = gdc_settings.buffer_addr;
-    gdc_settings.seq_planes_pos = 0;
-    gdc_settings.ddr_mem = system_ddr_mem_init(); //opaque pointer to memory and system dependent
-    acamera_gdc_stop( &gdc_settings );
-
-    //set the gdc config
-    gdc_settings.gdc_config.config_addr = 0x4000;
-    gdc_settings.gdc_config.config_size = gdc_test_param[GDC_TEST_RUN].gdc_sequence_size / 4; //size of configuration in 4bytes
-    gdc_settings.gdc_config.output_width = 1920;
-    gdc_settings.gdc_config.output_height = 1080;
-    gdc_settings.gdc_config.total_planes = gdc_test_param[GDC_TEST_RUN].total_planes;
-    gdc_settings.gdc_config.sequential_mode=gdc_test_param[GDC_TEST_RUN].sequential_mode;
-    gdc_settings.gdc_config.div_width = gdc_test_param[GDC_TEST_RUN].div_width;
-    gdc_settings.gdc_config.div_height = gdc_test_param[GDC_TEST_RUN].div_height;
-
-    uint32_t memory_used = gdc_load_settings_to_memory( (uint32_t *)((uintptr_t)gdc_settings.ddr_mem + gdc_settings.gdc_config.config_addr) , (uint32_t *)gdc_test_param[GDC_TEST_RUN].gdc_sequence, gdc_settings.gdc_config.config_size );
-    if ( memory_used != gdc_settings.gdc_config.config_size * 4 ) {
+    gdc_frames_completed = gdc_frames_failed = 0;
+    gdc_cores_found = 0;
+    if ( gdc_alloc_memory( gdc_test_param[GDC_TEST_RUN].total_planes, output_size, &config_mem, &config_addr, &output_addr ) != 0 ) {
+        LOG( LOG_CRIT, "Failed to allocate GDC memory" );
+        goto fail;
+    }
+    for ( core = 0; core < GDC_NUM_CORES; core++ ) {
+        system_interrupts_disable( core );
+        //configure gdc config, buffer address and resolution, the registers and ddr come from the device of the core
+        if ( system_gdc_io_core( core, &gdc_settings[core].base_gdc, &gdc_settings[core].ddr_mem ) != 0 ) {
+            LOG( LOG_CRIT, "GDC core %u is not provided by any device", core );
+            goto fail;
+        }
+        gdc_cores_found = core + 1;
+        gdc_settings[core].buffer_addr = output_addr;
+        gdc_settings[core].buffer_size = output_size;
+        gdc_settings[core].current_addr = gdc_settings[core].buffer_addr;
+        gdc_settings[core].seq_planes_pos = 0;
+        if ( acamera_gdc_stop( &gdc_settings[core] ) != 0 ) {
+            LOG( LOG_CRIT, "GDC core %u is busy and does not stop", core );
+            goto fail;
+        }
+
+        //set the gdc config, config_addr/config_size come from the sequence cache
+        gdc_settings[core].gdc_config.input_width = 1920;
+        gdc_settings[core].gdc_config.input_height = 1080;
+        gdc_settings[core].gdc_config.output_width = 1920;
+        gdc_settings[core].gdc_config.output_height = 1080;
+        gdc_settings[core].gdc_config.total_planes = gdc_test_param[GDC_TEST_RUN].total_planes;
+        gdc_settings[core].gdc_config.sequential_mode=gdc_test_param[GDC_TEST_RUN].sequential_mode;
+        gdc_settings[core].gdc_config.div_width = gdc_test_param[GDC_TEST_RUN].div_width;
+        gdc_settings[core].gdc_config.div_height = gdc_test_param[GDC_TEST_RUN].div_height;
+        cores[core] = &gdc_settings[core];
+    }
+
+    //luma and chroma planes on different cores for the three plane formats
+    gdc_plane_split = GDC_PLANE_SPLIT && GDC_NUM_CORES > 1 && gdc_test_param[GDC_TEST_RUN].total_planes == 3 &&
+                      !gdc_test_param[GDC_TEST_RUN].sequential_mode;
+
+    //the cores share the configuration region, the sequence is loaded once
+    if ( acamera_gdc_upload_init( &gdc_config_upload, GDC_CONFIG_UPLOAD_VERIFY, GDC_CONFIG_UPLOAD_DMA ) != 0 ||
+         acamera_gdc_cache_init( &gdc_config_cache, config_mem, config_addr, GDC_CONFIG_REGION_SIZE, GDC_CONFIG_SLOTS, gdc_load_settings_to_memory ) != 0 ||
+         gdc_select_sequence( &gdc_settings[0], GDC_TEST_RUN ) != 0 ||
+         ( gdc_plane_split && gdc_select_split( &gdc_settings[0], GDC_TEST_RUN ) != 0 ) ) {
         //memory config for gdc ifnitialization failed
         LOG( LOG_CRIT, "memory config for gdc initialization 1 failed" );
-        return -1;
+        goto fail;
     }
-    LOG( LOG_INFO, "Done gdc load..\n");
 
 #if HAS_FPGA_WRAPPER
     //fpga initialization with resolution and intended buffers for dma writer output
     //YUV 420 demo
-    uint32_t in_lineoffset[]={gdc_settings.gdc_config.output_width,gdc_settings.gdc_config.output_width};
-    if ( acamera_fpga_init( gdc_settings.gdc_config.output_width,gdc_settings.gdc_config.output_height,gdc_settings.gdc_config.total_planes,gdc_test_param[GDC_TEST_RUN].input_addresses,in_lineoffset) != 0 ) {
+    uint32_t in_lineoffset[]={gdc_settings[0].gdc_config.output_width,gdc_settings[0].gdc_config.output_width};
+    if ( acamera_fpga_init( gdc_settings[0].gdc_config.output_width,gdc_settings[0].gdc_config.output_height,gdc_settings[0].gdc_config.total_planes,gdc_input_addr,in_lineoffset,
+                           GDC_INPUT_BUFFERS,gdc_settings[0].gdc_config.total_planes * GDC_INPUT_PLANE_SIZE) != 0 ) {
 		LOG( LOG_ERR, "Wrong initialisation parameters for fpga reader block" );
-		return -1;
+		goto fail;
 	}
 #endif
 
-    //initialise the gdc by the first configuration
-    if ( acamera_gdc_init( &gdc_settings ) != 0 ) {
-        LOG( LOG_ERR, "Failed to initialise GDC block" );
-        return -1;
+    //initialise each gdc core by the first configuration
+    for ( core = 0; core < GDC_NUM_CORES; core++ ) {
+        gdc_settings[core].gdc_config.config_addr = gdc_settings[0].gdc_config.config_addr;
+        gdc_settings[core].gdc_config.config_size = gdc_settings[0].gdc_config.config_size;
+        if ( acamera_gdc_init( &gdc_settings[core] ) != 0 ) {
+            LOG( LOG_ERR, "Failed to initialise GDC core %u", core );
+            goto fail;
+        }
+    }
+    if ( acamera_gdc_pool_init( &gdc_output_pool, &gdc_settings[0], GDC_OUTPUT_SLOTS ) != 0 ) {
+        LOG( LOG_ERR, "Failed to initialise GDC output buffers" );
+        goto fail;
+    }
+    if ( system_spinlock_init( &gdc_dmabuf_lock ) != 0 ) {
+        LOG( LOG_ERR, "Failed to create the GDC dma-buf frame lock" );
+        goto fail;
+    }
+    gdc_refill_owed = 0;
+    if ( system_spinlock_init( &gdc_refill_lock ) != 0 ) {
+        LOG( LOG_ERR, "Failed to create the GDC refill lock" );
+        goto fail;
+    }
+    if ( system_timer_init( &gdc_refill_timer, NULL, NULL ) != 0 ) {
+        LOG( LOG_WARNING, "No GDC refill timer, frames without input are not retried" );
+        gdc_refill_timer = NULL;
+    } else {
+        system_timer_set_thread_handler( gdc_refill_timer, gdc_refill_retry );
+    }
+    if ( acamera_gdc_sched_init( &gdc_sched, cores, GDC_NUM_CORES, gdc_frame_done, NULL ) != 0 ) {
+        LOG( LOG_ERR, "Failed to initialise GDC scheduler" );
+        goto fail;
+    }
+    if ( system_debugfs_create( &gdc_latency_file, "latency", gdc_latency_show, gdc_latency_clear, NULL ) != 0 ) {
+        LOG( LOG_WARNING, "No latency report for GDC" );
     }
 
     LOG( LOG_INFO, "Done gdc config..\n" );
@@ -233,21 +797,101 @@ int gdc_fw_init( void )
     // function whenever the interrupt happens.
     // This interrupt handling procedure is only advisable and is used in demo application.
     // It can be changed by a customer discretion.
-    system_interrupt_set_handler( interrupt_handler, &gdc_settings );
-
-    //enable the interrupts
-    system_interrupts_enable();
+    for ( core = 0; core < GDC_NUM_CORES; core++ ) {
+        system_interrupt_set_handler( core, interrupt_handler, &gdc_settings[core] );
+        system_interrupt_set_thread_handler( core, interrupt_thread_handler, &gdc_settings[core] );
 
-    //start gdc process
+        //enable the interrupts
+        system_interrupts_enable( core );
+    }
 
-    acamera_gdc_process( &gdc_settings,gdc_test_param[GDC_TEST_RUN].total_planes, gdc_test_param[GDC_TEST_RUN].input_addresses);
+    //start gdc process, the queued frames run back to back and every completion queues a new one
+    gdc_refill( GDC_QUEUED_FRAMES );
 
     return 0;
+
+fail:
+    //gdc_fw_exit releases whatever was set up so far
+    gdc_fw_exit();
+    return -1;
+}
+
+
+//frames completed since gdc_fw_init and the recoveries of the watchdog on all cores
+void gdc_fw_get_counters( uint32_t *completed, uint32_t *failed, uint32_t *timeouts, uint32_t *errors, uint32_t *resubmits )
+{
+    uint32_t core;
+
+    *completed = gdc_frames_completed;
+    *failed = gdc_frames_failed;
+    *timeouts = *errors = *resubmits = 0;
+    for ( core = 0; core < GDC_NUM_CORES; core++ ) {
+        *timeouts += gdc_settings[core].watchdog.timeouts;
+        *errors += gdc_settings[core].watchdog.errors;
+        *resubmits += gdc_settings[core].watchdog.resubmits;
+    }
 }
 
 
+//also releases what a failed gdc_fw_init set up, every step skips what does not exist
 int gdc_fw_exit( void )
 {
+    uint32_t core, i;
+    int stuck = 0;
+
+    for ( core = 0; core < GDC_NUM_CORES; core++ ) {
+        system_interrupts_disable( core );
+    }
+    //no frame is queued again, the timer is armed under the refill lock
+    if ( gdc_refill_timer ) {
+        sys_timer timer = gdc_refill_timer;
+        unsigned long flags = system_spinlock_lock( gdc_refill_lock );
+        gdc_refill_timer = NULL;
+        system_spinlock_unlock( gdc_refill_lock, flags );
+        system_timer_destroy( timer );
+    }
+    //no job may still access memory when its fences, imports and buffers go away
+    for ( core = 0; core < gdc_cores_found; core++ ) {
+        if ( acamera_gdc_stop( &gdc_settings[core] ) != 0 ) {
+            stuck = 1;
+        }
+    }
+    system_debugfs_remove( gdc_latency_file );
+    gdc_latency_file = NULL;
+    acamera_gdc_sched_deinit( &gdc_sched );
+#if HAS_FPGA_WRAPPER
+    acamera_fpga_deinit();
+#endif
+    for ( core = 0; core < gdc_cores_found; core++ ) {
+        acamera_gdc_deinit( &gdc_settings[core] );
+    }
+    gdc_cores_found = 0;
+    //frames still in flight keep their imports until now, a core that did not stop may still write them
+    for ( i = 0; i < GDC_DMABUF_FRAMES && !stuck; i++ ) {
+        if ( gdc_dmabuf_jobs[i].used ) {
+            acamera_gdc_dmabuf_release( &gdc_dmabuf_jobs[i].input );
+            acamera_gdc_dmabuf_release( &gdc_dmabuf_jobs[i].output );
+            gdc_dmabuf_jobs[i].used = 0;
+        }
+    }
+    system_dmabuf_flush();
+    system_fence_flush();
+    if ( gdc_dmabuf_lock ) {
+        system_spinlock_destroy( gdc_dmabuf_lock );
+        gdc_dmabuf_lock = NULL;
+    }
+    if ( gdc_refill_lock ) {
+        system_spinlock_destroy( gdc_refill_lock );
+        gdc_refill_lock = NULL;
+    }
+    acamera_gdc_pool_deinit( &gdc_output_pool );
+    gdc_shown_addr = 0;
+    acamera_gdc_upload_deinit( &gdc_config_upload );
+    if ( stuck ) {
+        LOG( LOG_CRIT, "A GDC core did not stop, its memory stays allocated" );
+    } else {
+        gdc_free_memory();
+    }
 
     bsp_destroy();
     return 0;
@@ -25,16 +25,26 @@
 #include <linux/uio_driver.h>
 #include <asm/io.h>
 
+#include "acamera_driver_config.h"
 #include "system_log.h"
+#include "system_gdc_io.h"
+#include "system_dmabuf.h"
+#include "system_dma_alloc.h"
 
 //entry functions to gdc_main
 extern int gdc_fw_init( void );
 extern void gdc_fw_exit( void );
 
 //need to set system dependent irq and memory area
-extern void system_interrupts_set_irq( int irq_num, int flags );
-extern int32_t init_gdc_io( resource_size_t addr , resource_size_t size );
+extern void system_interrupts_set_irq( int id, int irq_num, int flags );
+extern void close_gdc_io( void );
 
+//configuration sequences are requested as firmware on behalf of the platform device
+extern void system_firmware_init( void *context );
+
+//devices probed so far, each one becomes the next io instance
+static uint32_t gdc_instances = 0;
+static uint32_t gdc_cores = 0;
 
 static const struct of_device_id gdc_dt_match[] = {
     {.compatible = "arm,gdc"},
@@ -52,38 +62,69 @@ static struct platform_driver gdc_platform_driver = {
 
 static int32_t gdc_platform_probe( struct platform_device *pdev )
 {
-    int32_t rc = 0;
     struct resource *gdc_res;
-
-    // Initialize irq
-    gdc_res = platform_get_resource_byname( pdev,
-                                            IORESOURCE_IRQ, "GDC" );
-
-    if ( gdc_res ) {
-        LOG( LOG_INFO, "Juno gdc irq = %d, flags = 0x%x !\n", (int)gdc_res->start, (int)gdc_res->flags );
-        system_interrupts_set_irq( gdc_res->start, gdc_res->flags );
-    } else {
-        LOG( LOG_ERR, "Error, no gdc irq found from DT\n" );
-        return -1;
+    system_gdc_io_ctx_t *ctx;
+    uint32_t instance = gdc_instances;
+    int irq[SYSTEM_GDC_IO_MAX_CORES], irq_flags[SYSTEM_GDC_IO_MAX_CORES];
+    char irq_name[8];
+    int core, num_cores;
+
+    if ( instance >= SYSTEM_GDC_IO_MAX_INSTANCES ) {
+        LOG( LOG_ERR, "Error, more than %d gdc devices\n", SYSTEM_GDC_IO_MAX_INSTANCES );
+        return -ENODEV;
     }
 
-
-    gdc_res = platform_get_resource( pdev,
-    		IORESOURCE_MEM, 0 );
-    if(gdc_res){
-    	LOG( LOG_INFO, "Juno gdc address = 0x%x, end = 0x%x !\n", (int)gdc_res->start, (int)gdc_res->end );
-    	if(init_gdc_io(gdc_res->start,gdc_res->end-gdc_res->start)!=0){
-    		LOG( LOG_ERR, "Error on mapping gdc memory! \n" );
-    	}
-    }else{
-    	LOG( LOG_ERR, "Error, no IORESOURCE_MEM DT!\n" );
+    // Count the cores by their irq, core 0 uses "GDC" and the other cores "GDC1", "GDC2"...
+    for ( num_cores = 0; num_cores < SYSTEM_GDC_IO_MAX_CORES; num_cores++ ) {
+        snprintf( irq_name, sizeof( irq_name ), num_cores ? "GDC%d" : "GDC", num_cores );
+        gdc_res = platform_get_resource_byname( pdev, IORESOURCE_IRQ, irq_name );
+        if ( gdc_res == NULL )
+            break;
+        irq[num_cores] = gdc_res->start;
+        irq_flags[num_cores] = gdc_res->flags;
+    }
+    if ( num_cores == 0 ) {
+        LOG( LOG_ERR, "Error, no gdc irq GDC found from DT\n" );
+        return -ENODEV;
     }
 
+    // registers first, then the optional ddr window the device works in
+    gdc_res = platform_get_resource( pdev, IORESOURCE_MEM, 0 );
+    if ( gdc_res == NULL ) {
+        LOG( LOG_ERR, "Error, no IORESOURCE_MEM DT!\n" );
+        return -ENODEV;
+    }
+    LOG( LOG_INFO, "Juno gdc %u address = 0x%x, end = 0x%x, %d cores !\n", instance, (int)gdc_res->start, (int)gdc_res->end, num_cores );
+    if ( system_gdc_io_open( instance, gdc_res->start, resource_size( gdc_res ), num_cores ) != 0 ) {
+        LOG( LOG_ERR, "Error on mapping gdc memory! \n" );
+        return -ENOMEM;
+    }
+    gdc_res = platform_get_resource( pdev, IORESOURCE_MEM, 1 );
+    if ( gdc_res && system_gdc_io_map_ddr( instance, gdc_res->start, resource_size( gdc_res ) ) != 0 ) {
+        LOG( LOG_ERR, "Error on mapping the ddr window of gdc %u\n", instance );
+    }
 
+    ctx = system_gdc_io_get( instance );
+    for ( core = 0; core < num_cores; core++ ) {
+        ctx->irq[core] = irq[core];
+        ctx->irq_flags[core] = irq_flags[core];
+        LOG( LOG_INFO, "Juno gdc core %u irq = %d, flags = 0x%x !\n", ctx->first_core + core, irq[core], irq_flags[core] );
+        system_interrupts_set_irq( ctx->first_core + core, irq[core], irq_flags[core] );
+    }
 
-    gdc_fw_init();
+    if ( instance == 0 ) {
+        system_firmware_init( &pdev->dev );
+        //dma-bufs shared with the gdc are attached to the first device, its memory is allocated for it
+        system_dmabuf_init( &pdev->dev );
+        if ( system_dma_alloc_init( &pdev->dev ) != 0 ) {
+            system_gdc_io_close( instance );
+            return -ENODEV;
+        }
+    }
+    gdc_instances++;
+    gdc_cores += num_cores;
 
-    return rc;
+    return 0;
 }
 
 static int __init fw_module_init( void )
@@ -95,6 +136,21 @@ static int __init fw_module_init( void )
     rc = platform_driver_probe( &gdc_platform_driver,
                                 gdc_platform_probe );
 
+    //the driver starts once every gdc device is mapped
+    if ( rc == 0 && gdc_cores < GDC_NUM_CORES ) {
+        LOG( LOG_ERR, "Error, %u gdc cores found, %d needed\n", gdc_cores, GDC_NUM_CORES );
+        rc = -ENODEV;
+    }
+    //gdc_fw_init released its memory and channels when it failed
+    if ( rc == 0 && gdc_fw_init() != 0 ) {
+        LOG( LOG_ERR, "Error, gdc firmware failed to start\n" );
+        system_dma_alloc_deinit();
+        rc = -ENODEV;
+    }
+    if ( rc != 0 && gdc_instances ) {
+        close_gdc_io();
+        platform_driver_unregister( &gdc_platform_driver );
+    }
 
     return rc;
 }
@@ -104,6 +160,8 @@ static void __exit fw_module_exit( void )
     LOG( LOG_ERR, "Juno gdc fw_module_exit\n" );
 
     gdc_fw_exit();
+    system_dma_alloc_deinit();
+    close_gdc_io();
 
     platform_driver_unregister( &gdc_platform_driver );
 }
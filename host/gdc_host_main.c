@@ -0,0 +1,334 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//userspace replacement of gdc_module.c: runs gdc_main against the simulated register file
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "acamera_driver_config.h"
+#include "system_log.h"
+#include "system_host_sim.h"
+#include "system_firmware.h"
+#include "system_debugfs.h"
+#include "system_dma_alloc.h"
+#include "system_fence.h"
+#include "acamera_gdc_api.h"
+#include "acamera_gdc_seq.h"
+
+//entry functions to gdc_main
+extern int gdc_fw_init( void );
+extern int gdc_fw_exit( void );
+extern int gdc_queue_dmabuf_frame( const int *in_fd, const uint32_t *in_offset, const int *out_fd, const uint32_t *out_offset, int in_fence_fd, int *out_fence_fd );
+extern int gdc_export_output_slot( uint32_t slot, int *fd );
+extern void gdc_fw_get_counters( uint32_t *completed, uint32_t *failed, uint32_t *timeouts, uint32_t *errors, uint32_t *resubmits );
+
+//need to set system dependent irq and memory area
+extern void system_interrupts_set_irq( int id, int irq_num, int flags );
+extern int32_t init_gdc_io( resource_size_t addr, resource_size_t size );
+extern void close_gdc_io( void );
+
+//simulated buffers of another device, the planes of a frame share one buffer
+#define HOST_DMABUF_INPUT_ADDR 0x1000000
+#define HOST_DMABUF_OUTPUT_ADDR 0x20000000
+#define HOST_DMABUF_PLANE_SIZE 0x200000
+
+//fences of the dma-buf frames in flight, the input ones are signalled by the simulated producer
+#define HOST_FENCES 64
+
+//every n-th input is never produced, its in-fence signals an error
+#define HOST_FENCE_ERROR_EVERY 10
+
+static struct {
+    sys_fence in;       //producer side of the in-fence, NULL when signalled
+    uint32_t due;       //completions after which the producer signals it
+    int out_fd;         //out-fence of the frame, -1 when checked
+} host_fences[HOST_FENCES];
+
+static struct {
+    uint32_t signalled;
+    uint32_t failed;
+    uint32_t inputs;
+} host_fence_count;
+
+//queues a frame from the simulated input buffer, every other one to the simulated output buffer,
+//with fence_delay its input is produced fence_delay completions later
+static int host_queue_dmabuf_frame( int in_fd, int out_fd, uint32_t count, uint32_t done, uint32_t fence_delay )
+{
+    const int in[ACAMERA_GDC_MAX_INPUT] = {in_fd, in_fd, in_fd};
+    const int out[ACAMERA_GDC_MAX_INPUT] = {out_fd, out_fd, out_fd};
+    const uint32_t in_offset[ACAMERA_GDC_MAX_INPUT] = {0, 0x1000000, 0x2000000};
+    const uint32_t out_offset[ACAMERA_GDC_MAX_INPUT] = {0, HOST_DMABUF_PLANE_SIZE, 2 * HOST_DMABUF_PLANE_SIZE};
+    int i, rc, in_fence_fd;
+
+    if ( fence_delay == 0 )
+        return gdc_queue_dmabuf_frame( in, in_offset, count & 1 ? out : NULL, out_offset, -1, NULL );
+
+    for ( i = 0; i < HOST_FENCES && ( host_fences[i].in || host_fences[i].out_fd >= 0 ); i++ )
+        ;
+    if ( i == HOST_FENCES || system_fence_create( &host_fences[i].in ) != 0 )
+        return -1;
+    if ( system_fence_export( host_fences[i].in, &in_fence_fd ) != 0 ) {
+        system_fence_put( host_fences[i].in );
+        host_fences[i].in = NULL;
+        return -1;
+    }
+    rc = gdc_queue_dmabuf_frame( in, in_offset, count & 1 ? out : NULL, out_offset, in_fence_fd, &host_fences[i].out_fd );
+    //the driver holds its own reference
+    system_fence_sim_close( in_fence_fd );
+    if ( rc != 0 ) {
+        system_fence_put( host_fences[i].in );
+        host_fences[i].in = NULL;
+        host_fences[i].out_fd = -1;
+        return -1;
+    }
+    host_fences[i].due = done + fence_delay;
+    return 0;
+}
+
+static int host_fences_waiting( void )
+{
+    int i;
+    for ( i = 0; i < HOST_FENCES; i++ ) {
+        if ( host_fences[i].in )
+            return 1;
+    }
+    return 0;
+}
+
+//the producer finishes the inputs that are due, the consumer picks up the signalled outputs
+static void host_run_fences( uint32_t done, int flush )
+{
+    int i;
+    for ( i = 0; i < HOST_FENCES; i++ ) {
+        if ( host_fences[i].in && ( flush || done >= host_fences[i].due ) ) {
+            host_fence_count.inputs++;
+            system_fence_signal( host_fences[i].in, host_fence_count.inputs % HOST_FENCE_ERROR_EVERY == 0 );
+            system_fence_put( host_fences[i].in );
+            host_fences[i].in = NULL;
+        }
+    }
+    for ( i = 0; i < HOST_FENCES; i++ ) {
+        int32_t status = host_fences[i].out_fd >= 0 ? system_fence_sim_status( host_fences[i].out_fd ) : 0;
+        if ( status != 0 ) {
+            if ( status > 0 )
+                host_fence_count.signalled++;
+            else
+                host_fence_count.failed++;
+            system_fence_sim_close( host_fences[i].out_fd );
+            host_fences[i].out_fd = -1;
+        }
+    }
+}
+
+static void usage( const char *name )
+{
+    printf( "usage: %s [-n frames] [-t frame_time_us] [-f firmware_dir] [-r trace] [-w n] [-e n] [-d n] [-i n]\n", name );
+    printf( "  -n  number of frames to run (default 1000)\n" );
+    printf( "  -t  simulated gdc processing time per frame in us (default 0)\n" );
+    printf( "  -f  directory holding %s/ with the configuration sequences\n", ACAMERA_GDC_SEQ_FIRMWARE_DIR );
+    printf( "  -r  save the register accesses, needs a build with GDC_MMIO_TRACE=1\n" );
+    printf( "  -w  hang every n-th frame until the watchdog stops it (default 0, never)\n" );
+    printf( "  -e  fail every n-th frame with an AXI writer error (default 0, never)\n" );
+    printf( "  -d  queue a frame from dma-bufs after every n-th completion (default 0, never)\n" );
+    printf( "  -i  the dma-buf frames wait on an in-fence signalled n completions later (default 0, no fences)\n" );
+}
+
+int main( int argc, char **argv )
+{
+    uint32_t frames = 1000;
+    u64 frame_time_us = 0, hang_every = 0, error_every = 0;
+    uint32_t dmabuf_every = 0, dmabuf_queued = 0, dmabuf_refused = 0, fence_delay = 0;
+    int in_fd = -1, out_fd = -1, slot_fd = -1;
+    const char *trace_path = NULL;
+    int opt, core;
+
+    while ( ( opt = getopt( argc, argv, "n:t:f:r:w:e:d:i:h" ) ) != -1 ) {
+        switch ( opt ) {
+        case 'n':
+            frames = strtoul( optarg, NULL, 0 );
+            break;
+        case 't':
+            frame_time_us = strtoull( optarg, NULL, 0 );
+            break;
+        case 'f':
+            system_firmware_init( optarg );
+            break;
+        case 'r':
+            trace_path = optarg;
+            break;
+        case 'w':
+            hang_every = strtoull( optarg, NULL, 0 );
+            break;
+        case 'e':
+            error_every = strtoull( optarg, NULL, 0 );
+            break;
+        case 'd':
+            dmabuf_every = strtoul( optarg, NULL, 0 );
+            break;
+        case 'i':
+            fence_delay = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            usage( argv[0] );
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if ( init_gdc_io( 0, HOST_GDC_IO_SIZE ) != 0 ) {
+        printf( "Error on mapping gdc memory\n" );
+        return 1;
+    }
+    for ( core = 0; core < GDC_NUM_CORES; core++ ) {
+        system_interrupts_set_irq( core, core + 1, 0 );
+        system_gdc_sim_set_frame_time( core, frame_time_us * 1000 );
+    }
+    system_gdc_sim_set_faults( hang_every, error_every );
+
+    if ( gdc_fw_init() != 0 ) {
+        printf( "gdc_fw_init failed\n" );
+        close_gdc_io();
+        return 1;
+    }
+
+    for ( core = 0; core < HOST_FENCES; core++ ) {
+        host_fences[core].out_fd = -1;
+    }
+    if ( dmabuf_every ) {
+        in_fd = system_dmabuf_sim_create( HOST_DMABUF_INPUT_ADDR, 3 * 0x1000000 );
+        out_fd = system_dmabuf_sim_create( HOST_DMABUF_OUTPUT_ADDR, 3 * HOST_DMABUF_PLANE_SIZE );
+        if ( gdc_export_output_slot( 0, &slot_fd ) != 0 ) {
+            printf( "cannot export output slot 0\n" );
+        }
+    }
+
+    system_gdc_sim_counters_t before, after;
+    system_gdc_sim_get_counters( &before );
+
+    //time spent in the interrupt path only, the simulated processing time is waited out separately
+    u64 total_ns = 0, min_ns = ~0ULL, max_ns = 0;
+    //frames are counted when they complete, stop interrupts and watchdog expiries only end attempts
+    uint32_t done = 0, interrupts = 0, failed, timeouts, errors, resubmits;
+    u64 hard_start = system_interrupts_sim_hard_ns();
+    u64 run_start = system_host_time_ns();
+    while ( done < frames ) {
+        u64 next = system_interrupts_sim_next_deadline();
+        if ( next == 0 && fence_delay && host_fences_waiting() ) {
+            //every queued frame waits behind an input, the producer is the only one left to make progress
+            host_run_fences( done, 1 );
+            next = system_interrupts_sim_next_deadline();
+        }
+        if ( next == 0 ) {
+            printf( "gdc stalled after %u frames, no interrupt pending\n", done );
+            break;
+        }
+        while ( system_host_time_ns() < next )
+            ;
+
+        u64 t0 = system_host_time_ns();
+        int delivered = system_interrupts_sim_dispatch( 0 );
+        u64 dt = system_host_time_ns() - t0;
+
+        if ( delivered == 0 ) {
+            continue;
+        }
+        //interrupts of several cores can be delivered by one dispatch
+        interrupts += delivered;
+        total_ns += dt;
+        dt /= delivered;
+        if ( dt < min_ns )
+            min_ns = dt;
+        if ( dt > max_ns )
+            max_ns = dt;
+        uint32_t completed;
+        gdc_fw_get_counters( &completed, &failed, &timeouts, &errors, &resubmits );
+        if ( dmabuf_every && done / dmabuf_every != completed / dmabuf_every ) {
+            if ( host_queue_dmabuf_frame( in_fd, out_fd, dmabuf_queued + dmabuf_refused, completed, fence_delay ) == 0 )
+                dmabuf_queued++;
+            else
+                dmabuf_refused++;
+        }
+        done = completed;
+        host_run_fences( done, 0 );
+    }
+    u64 run_ns = system_host_time_ns() - run_start;
+
+    system_gdc_sim_get_counters( &after );
+
+    gdc_fw_get_counters( &done, &failed, &timeouts, &errors, &resubmits );
+    if ( done > 0 ) {
+        printf( "frames:            %u on %d cores, %u failed\n", done, GDC_NUM_CORES, failed );
+        printf( "watchdog:          %u timeouts, %u errors, %u reruns\n", timeouts, errors, resubmits );
+        printf( "irq path ns/irq:   avg %llu min %llu max %llu over %u interrupts\n",
+                total_ns / interrupts, min_ns, max_ns, interrupts );
+        printf( "hard irq ns/frame: avg %llu, the rest runs in the irq thread\n",
+                ( system_interrupts_sim_hard_ns() - hard_start ) / done );
+        printf( "throughput:        %.0f frames/s\n", done * 1e9 / run_ns );
+        printf( "mmio per frame:    %.1f reads, %.1f writes, %.1f fences\n",
+                (double)( after.reads - before.reads ) / done,
+                (double)( after.writes - before.writes ) / done,
+                (double)( after.barriers - before.barriers ) / done );
+        printf( "gdc starts:        %llu\n", after.frames );
+        uint32_t allocs, alloc_bytes;
+        system_dma_alloc_usage( &allocs, &alloc_bytes );
+        printf( "gdc memory:        %u allocations, %u KiB\n", allocs, alloc_bytes >> 10 );
+
+        char report[SYSTEM_DEBUGFS_SIZE];
+        if ( system_debugfs_sim_read( "latency", report, sizeof( report ) ) > 0 ) {
+            printf( "\n%s", report );
+        }
+    }
+
+    if ( dmabuf_every ) {
+        printf( "\ndma-buf frames:    %u queued, %u refused, %u imports held\n", dmabuf_queued, dmabuf_refused, system_dmabuf_sim_imports() );
+    }
+
+    gdc_fw_exit();
+    if ( fence_delay ) {
+        //frames still waiting were failed by the driver on exit
+        host_run_fences( done, 1 );
+        printf( "fences:            %u inputs produced, %u outputs signalled, %u failed\n",
+                host_fence_count.inputs, host_fence_count.signalled, host_fence_count.failed );
+        if ( system_fence_sim_count() != 0 ) {
+            printf( "%u fences leaked\n", system_fence_sim_count() );
+            done = 0;
+        }
+    }
+    if ( dmabuf_every ) {
+        system_dmabuf_sim_close( in_fd );
+        system_dmabuf_sim_close( out_fd );
+        system_dmabuf_sim_close( slot_fd );
+        if ( system_dmabuf_sim_imports() != 0 ) {
+            printf( "%u dma-buf imports leaked\n", system_dmabuf_sim_imports() );
+            done = 0;
+        }
+    }
+    uint32_t allocs, alloc_bytes;
+    system_dma_alloc_usage( &allocs, &alloc_bytes );
+    if ( allocs != 0 ) {
+        printf( "%u gdc allocations of %u bytes leaked\n", allocs, alloc_bytes );
+        done = 0;
+    }
+    if ( trace_path && system_gdc_trace_save( trace_path ) != 0 ) {
+        printf( "cannot save the register trace to %s\n", trace_path );
+    }
+    close_gdc_io();
+
+    return done >= frames ? 0 : 1;
+}
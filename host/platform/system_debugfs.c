@@ -0,0 +1,92 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//host implementation of the debugfs layer, files are read back with system_debugfs_sim_read
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "system_debugfs.h"
+#include "system_host_sim.h"
+
+typedef struct system_debugfs {
+    struct system_debugfs *next;
+    char name[64];
+    system_debugfs_show_t show;
+    system_debugfs_clear_t clear;
+    void *param;
+} system_debugfs_t;
+
+static system_debugfs_t *sim_files;
+
+static system_debugfs_t *sim_find( const char *name )
+{
+    system_debugfs_t *f;
+    for ( f = sim_files; f != NULL; f = f->next ) {
+        if ( strcmp( f->name, name ) == 0 )
+            return f;
+    }
+    return NULL;
+}
+
+int32_t system_debugfs_create( sys_debugfs *file, const char *name, system_debugfs_show_t show, system_debugfs_clear_t clear, void *param )
+{
+    system_debugfs_t *f;
+
+    *file = NULL;
+    if ( strlen( name ) >= sizeof( f->name ) || sim_find( name ) != NULL )
+        return -1;
+    f = calloc( 1, sizeof( system_debugfs_t ) );
+    if ( f == NULL )
+        return -1;
+    strcpy( f->name, name );
+    f->show = show;
+    f->clear = clear;
+    f->param = param;
+    f->next = sim_files;
+    sim_files = f;
+    *file = f;
+    return 0;
+}
+
+void system_debugfs_remove( sys_debugfs file )
+{
+    system_debugfs_t **f;
+    for ( f = &sim_files; *f != NULL; f = &( *f )->next ) {
+        if ( *f == file ) {
+            *f = ( *f )->next;
+            free( file );
+            return;
+        }
+    }
+}
+
+uint32_t system_debugfs_sim_read( const char *name, char *buf, uint32_t size )
+{
+    system_debugfs_t *f = sim_find( name );
+    uint32_t len;
+
+    if ( f == NULL || size == 0 )
+        return 0;
+    len = f->show( f->param, buf, size - 1 );
+    if ( len > size - 1 )
+        len = size - 1;
+    buf[len] = '\0';
+    return len;
+}
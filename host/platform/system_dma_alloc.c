@@ -0,0 +1,160 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//host implementation of the gdc memory allocator, a first fit allocator over an mmap'd arena
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "system_dma_alloc.h"
+#include "system_host_sim.h"
+#include "system_log.h"
+
+#define SIM_DMA_PAGE 4096
+
+//allocations sorted by address
+typedef struct sim_dma_mem {
+    struct sim_dma_mem *next;
+    uint32_t offset;    //offset in the arena
+    uint32_t size;
+} sim_dma_mem_t;
+
+static uint8_t *sim_arena;
+static sim_dma_mem_t *sim_allocs;
+static uint32_t sim_count;
+static uint32_t sim_bytes;
+static pthread_mutex_t sim_lock = PTHREAD_MUTEX_INITIALIZER;
+
+int32_t system_dma_alloc_init( void *device )
+{
+    return 0;
+}
+
+void system_dma_alloc_deinit( void )
+{
+}
+
+int32_t system_dma_alloc( sys_dma_mem *mem, uint32_t size, void **virt, uint32_t *addr )
+{
+    sim_dma_mem_t **pos, *m;
+    uint32_t start = 0;
+
+    *mem = NULL;
+    if ( size == 0 || size > HOST_DMA_ARENA_SIZE )
+        return -1;
+    size = ( size + SIM_DMA_PAGE - 1 ) & ~( SIM_DMA_PAGE - 1 );
+
+    pthread_mutex_lock( &sim_lock );
+    //pages are only backed once touched, the arena costs nothing up front
+    if ( sim_arena == NULL ) {
+        void *p = mmap( NULL, HOST_DMA_ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+        sim_arena = p == MAP_FAILED ? NULL : p;
+    }
+    for ( pos = &sim_allocs; sim_arena && *pos != NULL; pos = &( *pos )->next ) {
+        if ( ( *pos )->offset - start >= size )
+            break;
+        start = ( *pos )->offset + ( *pos )->size;
+    }
+    m = sim_arena && HOST_DMA_ARENA_SIZE - start >= size ? calloc( 1, sizeof( sim_dma_mem_t ) ) : NULL;
+    if ( m == NULL ) {
+        pthread_mutex_unlock( &sim_lock );
+        LOG( LOG_ERR, "Failed to allocate %u bytes of GDC memory", size );
+        return -1;
+    }
+    m->offset = start;
+    m->size = size;
+    m->next = *pos;
+    *pos = m;
+    sim_count++;
+    sim_bytes += size;
+    pthread_mutex_unlock( &sim_lock );
+
+    memset( sim_arena + start, 0, size );
+    *virt = sim_arena + start;
+    *addr = HOST_DMA_ARENA_ADDR + start;
+    *mem = m;
+    return 0;
+}
+
+void system_dma_free( sys_dma_mem mem )
+{
+    sim_dma_mem_t **pos;
+
+    pthread_mutex_lock( &sim_lock );
+    for ( pos = &sim_allocs; mem && *pos != NULL; pos = &( *pos )->next ) {
+        if ( *pos == mem ) {
+            *pos = ( *pos )->next;
+            sim_count--;
+            sim_bytes -= ( (sim_dma_mem_t *)mem )->size;
+            //give the pages back, a later allocation gets them zeroed
+            madvise( sim_arena + ( (sim_dma_mem_t *)mem )->offset, ( (sim_dma_mem_t *)mem )->size, MADV_DONTNEED );
+            free( mem );
+            break;
+        }
+    }
+    pthread_mutex_unlock( &sim_lock );
+}
+
+int32_t system_dma_alloc_lookup( uint32_t addr, uint32_t size, void **virt )
+{
+    sim_dma_mem_t *m;
+    uint32_t offset = addr - HOST_DMA_ARENA_ADDR;
+    int32_t rc = -1;
+
+    pthread_mutex_lock( &sim_lock );
+    for ( m = sim_allocs; addr >= HOST_DMA_ARENA_ADDR && m != NULL; m = m->next ) {
+        if ( offset >= m->offset && offset - m->offset < m->size && size <= m->size - ( offset - m->offset ) ) {
+            *virt = sim_arena + offset;
+            rc = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock( &sim_lock );
+    return rc;
+}
+
+int32_t system_dma_alloc_find( uint32_t addr, uint32_t size, void **base_virt, uint32_t *base_addr, uint32_t *base_size )
+{
+    sim_dma_mem_t *m;
+    uint32_t offset = addr - HOST_DMA_ARENA_ADDR;
+    int32_t rc = -1;
+
+    pthread_mutex_lock( &sim_lock );
+    for ( m = sim_allocs; addr >= HOST_DMA_ARENA_ADDR && m != NULL; m = m->next ) {
+        if ( offset >= m->offset && offset - m->offset < m->size && size <= m->size - ( offset - m->offset ) ) {
+            *base_virt = sim_arena + m->offset;
+            *base_addr = HOST_DMA_ARENA_ADDR + m->offset;
+            *base_size = m->size;
+            rc = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock( &sim_lock );
+    return rc;
+}
+
+void system_dma_alloc_usage( uint32_t *count, uint32_t *bytes )
+{
+    pthread_mutex_lock( &sim_lock );
+    *count = sim_count;
+    *bytes = sim_bytes;
+    pthread_mutex_unlock( &sim_lock );
+}
@@ -0,0 +1,125 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//host implementation of the dma-buf layer, buffers are gdc address ranges behind simulated file descriptors
+
+#include <stdlib.h>
+
+#include "system_dmabuf.h"
+#include "system_host_sim.h"
+#include "system_log.h"
+
+#define SIM_DMABUF_MAX 64
+
+//simulated descriptors start here so they do not look like stdin/stdout
+#define SIM_DMABUF_FD_BASE 100
+
+typedef struct sim_dmabuf {
+    int open;           //the descriptor is valid
+    uint32_t refs;      //descriptor and imports holding the buffer
+    uint32_t addr;
+    uint32_t size;
+} sim_dmabuf_t;
+
+static sim_dmabuf_t sim_bufs[SIM_DMABUF_MAX];
+static uint32_t sim_imports;
+
+static sim_dmabuf_t *sim_get( int fd )
+{
+    if ( fd < SIM_DMABUF_FD_BASE || fd >= SIM_DMABUF_FD_BASE + SIM_DMABUF_MAX )
+        return NULL;
+    return sim_bufs[fd - SIM_DMABUF_FD_BASE].open ? &sim_bufs[fd - SIM_DMABUF_FD_BASE] : NULL;
+}
+
+static void sim_put( sim_dmabuf_t *b )
+{
+    if ( --b->refs == 0 )
+        b->size = 0;
+}
+
+void system_dmabuf_init( void *device )
+{
+}
+
+int system_dmabuf_sim_create( uint32_t addr, uint32_t size )
+{
+    int i;
+    for ( i = 0; i < SIM_DMABUF_MAX; i++ ) {
+        if ( !sim_bufs[i].open && sim_bufs[i].refs == 0 ) {
+            sim_bufs[i].open = 1;
+            sim_bufs[i].refs = 1;
+            sim_bufs[i].addr = addr;
+            sim_bufs[i].size = size;
+            return SIM_DMABUF_FD_BASE + i;
+        }
+    }
+    return -1;
+}
+
+void system_dmabuf_sim_close( int fd )
+{
+    sim_dmabuf_t *b = sim_get( fd );
+    if ( b ) {
+        b->open = 0;
+        sim_put( b );
+    }
+}
+
+uint32_t system_dmabuf_sim_imports( void )
+{
+    return sim_imports;
+}
+
+int32_t system_dmabuf_import( sys_dmabuf *buf, int fd, int write, uint32_t *addr, uint32_t *size )
+{
+    sim_dmabuf_t *b = sim_get( fd );
+
+    *buf = NULL;
+    if ( b == NULL ) {
+        LOG( LOG_ERR, "File descriptor %d is not a dma-buf", fd );
+        return -1;
+    }
+    b->refs++;
+    sim_imports++;
+    *addr = b->addr;
+    *size = b->size;
+    *buf = b;
+    return 0;
+}
+
+void system_dmabuf_release( sys_dmabuf buf )
+{
+    if ( buf ) {
+        sim_imports--;
+        sim_put( buf );
+    }
+}
+
+void system_dmabuf_flush( void )
+{
+}
+
+int32_t system_dmabuf_export( uint32_t addr, uint32_t size, int *fd )
+{
+    int rc;
+    if ( size == 0 || ( rc = system_dmabuf_sim_create( addr, size ) ) < 0 )
+        return -1;
+    *fd = rc;
+    return 0;
+}
@@ -0,0 +1,202 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//host implementation of the fence layer, sync_files are simulated descriptors and handlers run when the fence is signalled
+
+#include <stdlib.h>
+
+#include "system_fence.h"
+#include "system_host_sim.h"
+#include "system_log.h"
+
+#define SIM_FENCE_MAX 256
+
+//simulated descriptors start here, after the dma-buf ones
+#define SIM_FENCE_FD_BASE 1000
+
+typedef struct sim_fence {
+    uint32_t refs;      //handles and descriptors
+    int32_t status;     //system_fence_status
+} sim_fence_t;
+
+typedef struct system_fence {
+    struct system_fence *next;  //armed handles
+    sim_fence_t *fence;
+    system_fence_handler_t handler;
+    void *param;
+} system_fence_t;
+
+static sim_fence_t *sim_fds[SIM_FENCE_MAX];
+static system_fence_t *sim_armed;
+static uint32_t sim_live;
+
+static void sim_fence_put( sim_fence_t *fence )
+{
+    if ( --fence->refs == 0 ) {
+        free( fence );
+        sim_live--;
+    }
+}
+
+static system_fence_t *sim_handle( sim_fence_t *fence )
+{
+    system_fence_t *f = calloc( 1, sizeof( system_fence_t ) );
+    if ( f ) {
+        f->fence = fence;
+        fence->refs++;
+    }
+    return f;
+}
+
+static sim_fence_t *sim_get( int fd )
+{
+    if ( fd < SIM_FENCE_FD_BASE || fd >= SIM_FENCE_FD_BASE + SIM_FENCE_MAX )
+        return NULL;
+    return sim_fds[fd - SIM_FENCE_FD_BASE];
+}
+
+int32_t system_fence_import( sys_fence *fence, int fd )
+{
+    sim_fence_t *f = sim_get( fd );
+
+    *fence = NULL;
+    if ( f == NULL ) {
+        LOG( LOG_ERR, "File descriptor %d is not a sync_file", fd );
+        return -1;
+    }
+    *fence = sim_handle( f );
+    return *fence ? 0 : -1;
+}
+
+int32_t system_fence_create( sys_fence *fence )
+{
+    sim_fence_t *f = calloc( 1, sizeof( sim_fence_t ) );
+
+    *fence = NULL;
+    if ( f == NULL )
+        return -1;
+    sim_live++;
+    *fence = sim_handle( f );
+    if ( *fence == NULL ) {
+        free( f );
+        sim_live--;
+        return -1;
+    }
+    return 0;
+}
+
+int32_t system_fence_dup( sys_fence fence, sys_fence *dup )
+{
+    *dup = sim_handle( ( (system_fence_t *)fence )->fence );
+    return *dup ? 0 : -1;
+}
+
+int32_t system_fence_export( sys_fence fence, int *fd )
+{
+    int i;
+    for ( i = 0; i < SIM_FENCE_MAX; i++ ) {
+        if ( sim_fds[i] == NULL ) {
+            sim_fds[i] = ( (system_fence_t *)fence )->fence;
+            sim_fds[i]->refs++;
+            *fd = SIM_FENCE_FD_BASE + i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void system_fence_signal( sys_fence fence, int error )
+{
+    sim_fence_t *f = ( (system_fence_t *)fence )->fence;
+    system_fence_t **pos = &sim_armed;
+
+    if ( f->status != 0 )
+        return;
+    f->status = error ? -1 : 1;
+    //handlers may drop handles and arm others, take one at a time from the start
+    while ( *pos != NULL ) {
+        system_fence_t *h = *pos;
+        if ( h->fence != f ) {
+            pos = &h->next;
+            continue;
+        }
+        *pos = h->next;
+        h->next = NULL;
+        h->handler( h->param );
+        pos = &sim_armed;
+    }
+}
+
+int32_t system_fence_status( sys_fence fence )
+{
+    return ( (system_fence_t *)fence )->fence->status;
+}
+
+int32_t system_fence_notify( sys_fence fence, system_fence_handler_t handler, void *param )
+{
+    system_fence_t *f = fence;
+
+    if ( f->fence->status != 0 )
+        return -1;
+    f->handler = handler;
+    f->param = param;
+    f->next = sim_armed;
+    sim_armed = f;
+    return 0;
+}
+
+void system_fence_put( sys_fence fence )
+{
+    system_fence_t **pos;
+
+    if ( fence == NULL )
+        return;
+    for ( pos = &sim_armed; *pos != NULL; pos = &( *pos )->next ) {
+        if ( *pos == fence ) {
+            *pos = ( *pos )->next;
+            break;
+        }
+    }
+    sim_fence_put( ( (system_fence_t *)fence )->fence );
+    free( fence );
+}
+
+void system_fence_flush( void )
+{
+}
+
+int32_t system_fence_sim_status( int fd )
+{
+    sim_fence_t *f = sim_get( fd );
+    return f ? f->status : -1;
+}
+
+void system_fence_sim_close( int fd )
+{
+    sim_fence_t *f = sim_get( fd );
+    if ( f ) {
+        sim_fds[fd - SIM_FENCE_FD_BASE] = NULL;
+        sim_fence_put( f );
+    }
+}
+
+uint32_t system_fence_sim_count( void )
+{
+    return sim_live;
+}
@@ -0,0 +1,81 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//host implementation of firmware loading, files are read from a directory
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "system_firmware.h"
+#include "system_log.h"
+
+//set by the host makefile to the directory it writes the firmware files to
+#ifndef HOST_FIRMWARE_DIR
+#define HOST_FIRMWARE_DIR "firmware"
+#endif
+
+static const char *firmware_dir = HOST_FIRMWARE_DIR;
+
+void system_firmware_init( void *context )
+{
+    if ( context ) {
+        firmware_dir = context;
+    }
+}
+
+int32_t system_firmware_request( system_firmware_t *fw, const char *name )
+{
+    char path[512];
+    void *data = NULL;
+    long size = 0;
+    FILE *f;
+
+    snprintf( path, sizeof( path ), "%s/%s", firmware_dir, name );
+    f = fopen( path, "rb" );
+    if ( f == NULL ) {
+        LOG( LOG_ERR, "Cannot load firmware %s.\n", path );
+        return -1;
+    }
+    if ( fseek( f, 0, SEEK_END ) == 0 && ( size = ftell( f ) ) > 0 && fseek( f, 0, SEEK_SET ) == 0 ) {
+        //malloc returns memory aligned for any type, like the pages of request_firmware
+        data = malloc( size );
+        if ( data && fread( data, 1, size, f ) != (size_t)size ) {
+            free( data );
+            data = NULL;
+        }
+    }
+    fclose( f );
+    if ( data == NULL ) {
+        LOG( LOG_ERR, "Cannot read firmware %s.\n", path );
+        return -1;
+    }
+
+    fw->data = data;
+    fw->size = size;
+    fw->priv = data;
+    return 0;
+}
+
+void system_firmware_release( system_firmware_t *fw )
+{
+    free( fw->priv );
+    fw->data = NULL;
+    fw->size = 0;
+    fw->priv = NULL;
+}
@@ -0,0 +1,301 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//host implementation of the gdc io layer backed by an in-memory register file
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "acamera_driver_config.h"
+#include "system_log.h"
+#include "system_gdc_io_ctx.h"
+#include "system_gdc_shadow.h"
+#include "system_gdc_trace.h"
+#include "system_host_sim.h"
+
+//register offsets within a gdc core used by the simulated hardware
+#define HOST_GDC_STATUS_OFFSET ( 0x60 )
+#define HOST_GDC_CONTROL_OFFSET ( 0x64 )
+#define HOST_GDC_STATUS_BUSY ( 0x1 )
+#define HOST_GDC_STATUS_ERROR ( 0x2 )
+#define HOST_GDC_STATUS_USER_ABORT ( 0x200 )
+#define HOST_GDC_STATUS_AXI_WRITER_ERROR ( 0x800 )
+#define HOST_GDC_CONTROL_START ( 0x1 )
+#define HOST_GDC_CONTROL_STOP ( 0x2 )
+#define HOST_GDC_CAPABILITY_OFFSET ( 0x68 )
+
+//capability mask of the simulated block: 8/10 bit, grayscale, planar 444, semiplanar, bicubic,
+//64 line output cache, 256 cluster tile cache, 8 filter banks, 128 bit axi
+#define HOST_GDC_CAPABILITIES ( 0x137 | ( 1 << 16 ) | ( 8 << 19 ) | ( 3 << 24 ) | ( 2 << 27 ) )
+
+static u64 sim_frame_time[HOST_GDC_MAX_CORES];
+static u64 sim_done_time[HOST_GDC_MAX_CORES];   //the busy bit reads 0 from this time on
+static uint32_t sim_done_status[HOST_GDC_MAX_CORES]; //error bits the running frame completes with
+static u64 sim_hang_every, sim_error_every;
+static system_gdc_sim_counters_t sim_counters;
+
+u64 system_host_time_ns( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//every instance gets its own register file, addr is ignored
+int32_t system_gdc_io_open( uint32_t instance, resource_size_t addr, resource_size_t size, uint32_t num_cores )
+{
+    system_gdc_io_ctx_t *ctx;
+    uint32_t core;
+
+    if ( instance >= SYSTEM_GDC_IO_MAX_INSTANCES || num_cores > SYSTEM_GDC_IO_MAX_CORES ) {
+        return -1;
+    }
+    ctx = &system_gdc_io_ctx[instance];
+    if ( ctx->hw_base != NULL ) {
+        return -1;
+    }
+    if ( size == 0 || size > HOST_GDC_IO_SIZE ) {
+        size = HOST_GDC_IO_SIZE;
+    }
+    ctx->hw_base = calloc( 1, size );
+    if ( !ctx->hw_base ) {
+        return -1;
+    }
+    ctx->hw_size = size;
+    ctx->num_cores = num_cores;
+    system_gdc_io_number_cores( instance );
+    if ( system_gdc_io_opened() == 1 ) {
+        system_memset( &sim_counters, 0, sizeof( sim_counters ) );
+#if GDC_MMIO_TRACE
+        if ( system_gdc_trace_init() != 0 ) {
+            LOG( LOG_WARNING, "Register accesses are not recorded" );
+        }
+#endif
+    }
+    for ( core = 0; core < num_cores && core * HOST_GDC_CORE_STRIDE + HOST_GDC_CAPABILITY_OFFSET + 4 <= size; core++ ) {
+        ( (uint32_t *)ctx->hw_base )[( core * HOST_GDC_CORE_STRIDE + HOST_GDC_CAPABILITY_OFFSET ) >> 2] = HOST_GDC_CAPABILITIES;
+    }
+
+    return 0;
+}
+
+//heap arena standing for the ddr window of the device
+int32_t system_gdc_io_map_ddr( uint32_t instance, phys_addr_t addr, uint32_t size )
+{
+    system_gdc_io_ctx_t *ctx = system_gdc_io_get( instance );
+
+    if ( ctx == NULL || ctx->ddr_base != NULL ) {
+        return -1;
+    }
+    ctx->ddr_base = calloc( 1, size );
+    if ( ctx->ddr_base == NULL ) {
+        return -1;
+    }
+    ctx->ddr_phys = addr;
+    ctx->ddr_size = size;
+    return 0;
+}
+
+void system_gdc_io_close( uint32_t instance )
+{
+    system_gdc_io_ctx_t *ctx = system_gdc_io_get( instance );
+
+    if ( ctx == NULL ) {
+        return;
+    }
+    free( ctx->ddr_base );
+    free( ctx->hw_base );
+    system_memset( ctx, 0, sizeof( *ctx ) );
+#if GDC_MMIO_TRACE
+    if ( system_gdc_io_opened() == 0 ) {
+        system_gdc_trace_deinit();
+    }
+#endif
+}
+
+int32_t init_gdc_io( resource_size_t addr, resource_size_t size )
+{
+    return system_gdc_io_open( 0, addr, size, GDC_NUM_CORES );
+}
+
+void close_gdc_io( void )
+{
+    uint32_t instance;
+
+    LOG( LOG_DEBUG, "IO functionality has been closed" );
+    system_gdc_shadow_clear();
+    for ( instance = 0; instance < SYSTEM_GDC_IO_MAX_INSTANCES; instance++ ) {
+        system_gdc_io_close( instance );
+    }
+}
+
+//status register of a driver wide core, NULL for a core no instance holds
+static volatile uint32_t *sim_status( int core )
+{
+    uint32_t base;
+    void *ddr;
+    if ( core < 0 || system_gdc_io_core( core, &base, &ddr ) != 0 ) {
+        return NULL;
+    }
+    return system_gdc_io_ptr( base + HOST_GDC_STATUS_OFFSET );
+}
+
+//returns the driver wide core whose register at reg_offset lives at addr, -1 for any other register
+static int sim_core_of( uint32_t addr, uint32_t reg_offset )
+{
+    uint32_t offset = addr & SYSTEM_GDC_IO_OFFSET_MASK;
+    system_gdc_io_ctx_t *ctx = system_gdc_io_get( SYSTEM_GDC_IO_INSTANCE( addr ) );
+    uint32_t core;
+
+    if ( ctx == NULL || offset % HOST_GDC_CORE_STRIDE != reg_offset ) {
+        return -1;
+    }
+    if ( offset / HOST_GDC_CORE_STRIDE >= ctx->num_cores ) {
+        return -1;
+    }
+    core = ctx->first_core + offset / HOST_GDC_CORE_STRIDE;
+    return core < HOST_GDC_MAX_CORES ? (int)core : -1;
+}
+
+void system_gdc_sim_set_frame_time( int core, u64 ns )
+{
+    if ( core >= 0 && core < HOST_GDC_MAX_CORES ) {
+        sim_frame_time[core] = ns;
+    }
+}
+
+void system_gdc_sim_set_faults( u64 hang_every, u64 error_every )
+{
+    sim_hang_every = hang_every;
+    sim_error_every = error_every;
+}
+
+void system_gdc_sim_complete( int core )
+{
+    volatile uint32_t *status = sim_status( core );
+    if ( status != NULL && ( *status & HOST_GDC_STATUS_BUSY ) ) {
+        *status = sim_done_status[core];
+    }
+}
+
+void system_gdc_sim_get_counters( system_gdc_sim_counters_t *counters )
+{
+    *counters = sim_counters;
+}
+
+uint32_t system_gdc_read_32( uint32_t addr )
+{
+    uint32_t result = 0;
+    SYSTEM_GDC_TRACE_START( t0 );
+    if ( system_gdc_shadow_read( addr, &result ) == 0 ) {
+        SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_SHADOW, addr, result, t0 );
+        return result;
+    }
+    volatile uint32_t *reg = system_gdc_io_ptr( addr );
+    if ( reg != NULL ) {
+        int core = sim_core_of( addr, HOST_GDC_STATUS_OFFSET );
+        //a polled core finishes on time, without waiting for its interrupt to be dispatched
+        if ( core >= 0 && ( *reg & HOST_GDC_STATUS_BUSY ) && system_host_time_ns() >= sim_done_time[core] ) {
+            *reg = sim_done_status[core];
+        }
+        sim_counters.reads++;
+        result = *reg;
+    } else {
+        LOG( LOG_ERR, "Failed to read memory from address %d. Base pointer is null ", addr );
+    }
+    SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_READ, addr, result, t0 );
+    return result;
+}
+
+//ordered writes pay a full fence like iowrite32 does on arm64
+static void sim_write( uint32_t addr, uint32_t data, int ordered )
+{
+    volatile uint32_t *reg = system_gdc_io_ptr( addr );
+    if ( reg != NULL ) {
+        uint32_t prev = *reg;
+        int core = sim_core_of( addr, HOST_GDC_CONTROL_OFFSET );
+
+        if ( ordered ) {
+            __atomic_thread_fence( __ATOMIC_SEQ_CST );
+            sim_counters.barriers++;
+        }
+        sim_counters.writes++;
+        *reg = data;
+        system_gdc_shadow_write( addr, data );
+
+        //a 0->1 transition of the start flag latches the configuration and starts the frame
+        if ( core >= 0 && !( prev & HOST_GDC_CONTROL_START ) && ( data & HOST_GDC_CONTROL_START ) ) {
+            sim_counters.frames++;
+            *sim_status( core ) = HOST_GDC_STATUS_BUSY;
+            sim_done_status[core] = 0;
+            if ( sim_error_every && sim_counters.frames % sim_error_every == 0 ) {
+                sim_done_status[core] = HOST_GDC_STATUS_ERROR | HOST_GDC_STATUS_AXI_WRITER_ERROR;
+            }
+            if ( sim_hang_every && sim_counters.frames % sim_hang_every == 0 ) {
+                //never finishes and never interrupts
+                sim_done_time[core] = ~0ULL;
+            } else {
+                sim_done_time[core] = system_host_time_ns() + sim_frame_time[core];
+                system_interrupts_sim_raise( core, sim_done_time[core] );
+            }
+        }
+        //the stop flag abandons the running frame
+        if ( core >= 0 && !( prev & HOST_GDC_CONTROL_STOP ) && ( data & HOST_GDC_CONTROL_STOP ) ) {
+            if ( *sim_status( core ) & HOST_GDC_STATUS_BUSY ) {
+                *sim_status( core ) = HOST_GDC_STATUS_ERROR | HOST_GDC_STATUS_USER_ABORT;
+            }
+            system_interrupts_sim_cancel( core );
+        }
+    } else {
+        LOG( LOG_ERR, "Failed to write value %d to memory with offset %d. Base pointer is null ", data, addr );
+    }
+}
+
+void system_gdc_write_32( uint32_t addr, uint32_t data )
+{
+    SYSTEM_GDC_TRACE_START( t0 );
+    sim_write( addr, data, 1 );
+    SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_WRITE, addr, data, t0 );
+}
+
+void system_gdc_write_32_relaxed( uint32_t addr, uint32_t data )
+{
+    SYSTEM_GDC_TRACE_START( t0 );
+    sim_write( addr, data, 0 );
+    SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_WRITE_RELAXED, addr, data, t0 );
+}
+
+void system_gdc_write_barrier( void )
+{
+    SYSTEM_GDC_TRACE_START( t0 );
+    __atomic_thread_fence( __ATOMIC_SEQ_CST );
+    sim_counters.barriers++;
+    SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_BARRIER, 0, 0, t0 );
+}
+
+void system_gdc_write_list( const system_gdc_reg_write_t *list, uint32_t count )
+{
+    uint32_t i;
+    //each write goes through sim_write so the list can start the simulated block
+    for ( i = 0; i < count; i++ ) {
+        SYSTEM_GDC_TRACE_START( t0 );
+        sim_write( list[i].addr, list[i].data, !GDC_RELAXED_MMIO );
+        SYSTEM_GDC_TRACE( GDC_RELAXED_MMIO ? SYSTEM_GDC_TRACE_WRITE_RELAXED : SYSTEM_GDC_TRACE_WRITE, list[i].addr, list[i].data, t0 );
+    }
+}
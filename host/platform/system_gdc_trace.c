@@ -0,0 +1,145 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//host implementation of the mmio recorder, the ring is saved to a file instead of debugfs
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdlib.h>
+
+#include "acamera_driver_config.h"
+#include "system_gdc_trace.h"
+#include "system_host_sim.h"
+#include "system_log.h"
+
+#if GDC_MMIO_TRACE
+
+static system_gdc_trace_record_t *trace_ring = NULL;
+static uint32_t trace_head = 0;
+static uint32_t trace_cleared = 0;
+
+u64 system_gdc_trace_time( void )
+{
+    return system_host_time_ns();
+}
+
+void system_gdc_trace_add( uint32_t op, uint32_t addr, uint32_t data, u64 start, const void *caller )
+{
+    system_gdc_trace_record_t *record;
+    uint32_t index;
+
+    if ( trace_ring == NULL )
+        return;
+    index = __atomic_fetch_add( &trace_head, 1, __ATOMIC_RELAXED );
+    record = &trace_ring[index & ( SYSTEM_GDC_TRACE_SIZE - 1 )];
+    __atomic_store_n( &record->seq, 0, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    record->time = start;
+    record->duration = (uint32_t)( system_host_time_ns() - start );
+    record->addr = addr;
+    record->data = data;
+    record->op = op;
+    record->caller = caller;
+    __atomic_store_n( &record->seq, index + 1, __ATOMIC_RELEASE );
+}
+
+int32_t system_gdc_trace_get( uint32_t index, system_gdc_trace_record_t *record )
+{
+    const system_gdc_trace_record_t *slot;
+
+    if ( trace_ring == NULL )
+        return -1;
+    slot = &trace_ring[index & ( SYSTEM_GDC_TRACE_SIZE - 1 )];
+    if ( __atomic_load_n( &slot->seq, __ATOMIC_ACQUIRE ) != index + 1 )
+        return -1;
+    *record = *slot;
+    __atomic_thread_fence( __ATOMIC_ACQUIRE );
+    //a writer that took the slot meanwhile has cleared seq
+    return __atomic_load_n( &slot->seq, __ATOMIC_RELAXED ) == index + 1 ? 0 : -1;
+}
+
+uint32_t system_gdc_trace_range( uint32_t *first )
+{
+    uint32_t head = __atomic_load_n( &trace_head, __ATOMIC_ACQUIRE );
+    uint32_t oldest = head > SYSTEM_GDC_TRACE_SIZE ? head - SYSTEM_GDC_TRACE_SIZE : 0;
+    *first = oldest > trace_cleared ? oldest : trace_cleared;
+    return head;
+}
+
+void system_gdc_trace_clear( void )
+{
+    trace_cleared = __atomic_load_n( &trace_head, __ATOMIC_ACQUIRE );
+}
+
+int32_t system_gdc_trace_init( void )
+{
+    trace_ring = calloc( SYSTEM_GDC_TRACE_SIZE, sizeof( system_gdc_trace_record_t ) );
+    if ( trace_ring == NULL ) {
+        LOG( LOG_ERR, "Failed to allocate the mmio trace ring" );
+        return -1;
+    }
+    trace_head = 0;
+    trace_cleared = 0;
+    return 0;
+}
+
+void system_gdc_trace_deinit( void )
+{
+    free( trace_ring );
+    trace_ring = NULL;
+}
+
+int32_t system_gdc_trace_save( const char *path )
+{
+    system_gdc_trace_record_t record;
+    const char *module = NULL;
+    uintptr_t module_base = 0;
+    uint32_t first, head, i;
+    Dl_info info;
+    FILE *f;
+
+    if ( trace_ring == NULL )
+        return -1;
+    f = fopen( path, "w" );
+    if ( f == NULL )
+        return -1;
+    //callers are written as offsets into the executable so addr2line can resolve them
+    if ( dladdr( (void *)system_gdc_trace_save, &info ) != 0 ) {
+        module = info.dli_fname;
+        module_base = (uintptr_t)info.dli_fbase;
+    }
+    fprintf( f, "# gdc mmio trace, module %s\n", module ? module : "?" );
+    head = system_gdc_trace_range( &first );
+    for ( i = first; i != head; i++ ) {
+        if ( system_gdc_trace_get( i, &record ) == 0 )
+            fprintf( f, "%llu %u %c 0x%06x 0x%08x 0x%lx\n", (unsigned long long)record.time, record.duration, record.op,
+                     record.addr, record.data, (unsigned long)( (uintptr_t)record.caller - module_base ) );
+    }
+    fclose( f );
+    return 0;
+}
+
+#else
+
+int32_t system_gdc_trace_save( const char *path )
+{
+    return -1;
+}
+
+#endif
@@ -0,0 +1,233 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __SYSTEM_HOST_SIM_H__
+#define __SYSTEM_HOST_SIM_H__
+
+#include "system_stdlib.h"
+
+//size of the simulated register window, covers the gdc cores and the fpga wrapper at 0x209000
+#define HOST_GDC_IO_SIZE ( 0x210000 )
+
+//register stride between simulated gdc cores
+#define HOST_GDC_CORE_STRIDE ( 0x100 )
+
+//number of gdc cores the simulator models
+#define HOST_GDC_MAX_CORES 2
+
+//size of the simulated ddr window returned by system_ddr_mem_init
+#define HOST_DDR_MEM_SIZE ( 0x400000 )
+
+//arena of system_dma_alloc and the gdc address of its first byte
+#define HOST_DMA_ARENA_SIZE ( 0x10000000 )
+#define HOST_DMA_ARENA_ADDR ( 0x40000000 )
+
+typedef struct system_gdc_sim_counters {
+    u64 reads;      //number of system_gdc_read_32 calls
+    u64 writes;     //number of register writes, ordered or relaxed
+    u64 barriers;   //ordered writes and write barriers, each one a full fence
+    u64 frames;     //number of start flag 0->1 transitions
+} system_gdc_sim_counters_t;
+
+/**
+ *   Monotonic host time in nanoseconds
+ *
+ *   @return current time
+ */
+u64 system_host_time_ns( void );
+
+/**
+ *   Set the simulated processing time of a gdc core
+ *
+ *   The busy bit stays set and the interrupt is held back until this time
+ *   has passed after the start flag transition. 0 completes immediately.
+ *
+ *   @param  core - gdc core number
+ *   @param  ns - processing time of one frame in nanoseconds
+ */
+void system_gdc_sim_set_frame_time( int core, u64 ns );
+
+/**
+ *   Finish the frame running on a simulated core
+ *
+ *   Clears the busy bit in the status register. Called by the simulated
+ *   interrupt source before the interrupt handler runs.
+ *
+ *   @param  core - gdc core number
+ */
+void system_gdc_sim_complete( int core );
+
+/**
+ *   Write the recorded register accesses to a file
+ *
+ *   Text format of system_gdc_trace.h, callers are offsets into the executable.
+ *
+ *   @param  path - file to create
+ *
+ *   @return 0 - success
+ *           -1 - not built with GDC_MMIO_TRACE or the file cannot be written.
+ */
+int32_t system_gdc_trace_save( const char *path );
+
+/**
+ *   Read the MMIO access counters of the register model
+ *
+ *   @param  counters - filled with the current counts
+ */
+void system_gdc_sim_get_counters( system_gdc_sim_counters_t *counters );
+
+/**
+ *   Inject faults into the simulated frames
+ *
+ *   Every hang_every-th frame never completes until the stop flag aborts it,
+ *   every error_every-th frame completes with the error and AXI writer error
+ *   bits set. 0 disables a fault.
+ *
+ *   @param  hang_every - period of hanging frames, counted over all cores
+ *   @param  error_every - period of frames failing with an AXI error
+ */
+void system_gdc_sim_set_faults( u64 hang_every, u64 error_every );
+
+/**
+ *   Raise a simulated interrupt
+ *
+ *   The interrupt becomes pending and is delivered by system_interrupts_sim_dispatch
+ *   once the deadline has passed.
+ *
+ *   @param  id - gdc core number
+ *   @param  deadline_ns - host time at which the interrupt fires
+ */
+void system_interrupts_sim_raise( int id, u64 deadline_ns );
+
+/**
+ *   Drop a pending simulated interrupt
+ *
+ *   @param  id - gdc core number
+ */
+void system_interrupts_sim_cancel( int id );
+
+/**
+ *   Earliest pending interrupt or timer deadline
+ *
+ *   @return host time of the next interrupt or timer expiry, 0 if none is pending
+ */
+u64 system_interrupts_sim_next_deadline( void );
+
+/**
+ *   Deliver pending simulated interrupts
+ *
+ *   Every pending interrupt whose deadline has passed completes its core
+ *   and calls the registered handler if the interrupt is enabled. The
+ *   threaded handlers of the delivered interrupts run after all of them,
+ *   then the handlers of expired timers.
+ *
+ *   @param  wait - sleep until the earliest pending deadline first
+ *
+ *   @return number of interrupts delivered and timers expired
+ */
+int system_interrupts_sim_dispatch( int wait );
+
+/**
+ *   Time spent in the interrupt handlers, threaded handlers excluded
+ *
+ *   @return total host time in ns since start
+ */
+u64 system_interrupts_sim_hard_ns( void );
+
+/**
+ *   Earliest expiry of an armed timer
+ *
+ *   @return host time of the expiry, 0 if no timer is armed
+ */
+u64 system_timer_sim_next_deadline( void );
+
+/**
+ *   Run the handlers of the expired timers
+ *
+ *   @return number of timers expired
+ */
+int system_timer_sim_dispatch( void );
+
+/**
+ *   Read a file created with system_debugfs_create
+ *
+ *   @param  name - file name
+ *   @param  buf - filled with the text of the file and a terminator
+ *   @param  size - size of buf
+ *
+ *   @return length of the text, 0 if there is no such file
+ */
+uint32_t system_debugfs_sim_read( const char *name, char *buf, uint32_t size );
+
+/**
+ *   Create a simulated dma-buf
+ *
+ *   The descriptor stands for a buffer of another device at a gdc address and
+ *   can be passed to system_dmabuf_import. Buffers exported with
+ *   system_dmabuf_export are simulated descriptors too.
+ *
+ *   @param  addr - gdc address of the buffer
+ *   @param  size - size of the buffer in bytes
+ *
+ *   @return file descriptor, -1 when the table is full
+ */
+int system_dmabuf_sim_create( uint32_t addr, uint32_t size );
+
+/**
+ *   Close a simulated dma-buf descriptor
+ *
+ *   The buffer stays valid while imports of it are not released.
+ *
+ *   @param  fd - descriptor from system_dmabuf_sim_create or system_dmabuf_export
+ */
+void system_dmabuf_sim_close( int fd );
+
+/**
+ *   Number of imports not released yet
+ *
+ *   @return imports made by system_dmabuf_import and not released
+ */
+uint32_t system_dmabuf_sim_imports( void );
+
+/**
+ *   State of the fence behind a simulated sync_file
+ *
+ *   @param  fd - descriptor from system_fence_export
+ *
+ *   @return 0 - not signalled yet
+ *           1 - signalled
+ *           -1 - signalled with an error or not a sync_file.
+ */
+int32_t system_fence_sim_status( int fd );
+
+/**
+ *   Close a simulated sync_file descriptor
+ *
+ *   @param  fd - descriptor from system_fence_export
+ */
+void system_fence_sim_close( int fd );
+
+/**
+ *   Number of fences still referenced by a handle or a descriptor
+ *
+ *   @return live fences
+ */
+uint32_t system_fence_sim_count( void );
+
+#endif /* __SYSTEM_HOST_SIM_H__ */
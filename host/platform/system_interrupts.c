@@ -0,0 +1,214 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//host implementation of the interrupt layer, interrupts are raised by the simulated register file
+
+#include <time.h>
+
+#include "system_interrupts.h"
+#include "system_log.h"
+#include "system_host_sim.h"
+
+typedef enum {
+  GDC_IRQ_STATUS_DEINIT = 0,
+  GDC_IRQ_STATUS_ENABLED,
+  GDC_IRQ_STATUS_DISABLED,
+  GDC_IRQ_STATUS_MAX
+} irq_status;
+
+#define MAX_GDC_CORES	HOST_GDC_MAX_CORES
+typedef struct dev_info{
+	int irq;
+	int flags;
+	system_interrupt_handler_t app_handler;
+	void* app_param;
+	system_interrupt_handler_t thread_handler;
+	void* thread_param;
+	irq_status status;
+	int pending;
+	int wake_thread;
+	u64 deadline;
+}dev_irq_info;
+static dev_irq_info gdc_irq[MAX_GDC_CORES] = {0};
+
+//time spent in the interrupt context part of the handlers
+static u64 sim_hard_ns;
+
+
+static void system_interrupt_handler( int core_id )
+{
+	LOG(LOG_DEBUG, "GDC core %d: interrupt comes in (irq = %d)", core_id, gdc_irq[core_id].irq);
+	if(gdc_irq[core_id].app_handler)
+		gdc_irq[core_id].app_handler(gdc_irq[core_id].app_param, 1);
+	//like the kernel irq thread, several interrupts wake it once
+	if(gdc_irq[core_id].thread_handler)
+		gdc_irq[core_id].wake_thread = 1;
+}
+
+void system_interrupts_set_irq(int id, int irq_num, int flags)
+{
+	if(id < MAX_GDC_CORES) {
+		gdc_irq[id].irq = irq_num;
+		gdc_irq[id].flags = flags;
+		LOG(LOG_INFO, "Set core %d IRQ to %d\n", id, gdc_irq[id].irq);
+	}
+}
+
+void system_interrupts_init( int id)
+{
+	if(id >= MAX_GDC_CORES) {
+		LOG(LOG_ERR, "system_interrupts_init error: unsupported core id %d", id);
+		return;
+	}
+
+	if(gdc_irq[id].status != GDC_IRQ_STATUS_DEINIT) {
+		LOG(LOG_WARNING, "irq %d is already initied (status = %d)",
+			gdc_irq[id].irq, gdc_irq[id].status);
+		return;
+	}
+	gdc_irq[id].status = GDC_IRQ_STATUS_DISABLED;
+	gdc_irq[id].pending = 0;
+	LOG(LOG_INFO, "Simulated interrupt %d requested (flags = 0x%x)\n",
+			gdc_irq[id].irq, gdc_irq[id].flags);
+}
+
+void system_interrupt_set_handler(int id, system_interrupt_handler_t handler, void *param )
+{
+	if(id < MAX_GDC_CORES) {
+		gdc_irq[id].app_handler = handler;
+		gdc_irq[id].app_param = param;
+	}
+}
+
+void system_interrupt_set_thread_handler(int id, system_interrupt_handler_t handler, void *param )
+{
+	if(id < MAX_GDC_CORES) {
+		gdc_irq[id].thread_handler = handler;
+		gdc_irq[id].thread_param = param;
+	}
+}
+
+void system_interrupts_deinit( int id )
+{
+	if(id < MAX_GDC_CORES) {
+		if ( gdc_irq[id].status == GDC_IRQ_STATUS_DEINIT ) {
+			LOG( LOG_WARNING, "irq %d is already deinitied (status = %d)",
+			gdc_irq[id].irq, gdc_irq[id].status );
+		} else {
+			gdc_irq[id].status = GDC_IRQ_STATUS_DEINIT;
+			LOG( LOG_INFO, "Interrupt %d released\n", gdc_irq[id].irq );
+			gdc_irq[id].irq = 0;
+			gdc_irq[id].flags = 0;
+		}
+		gdc_irq[id].app_handler = NULL;
+		gdc_irq[id].app_param = NULL;
+		gdc_irq[id].thread_handler = NULL;
+		gdc_irq[id].thread_param = NULL;
+		gdc_irq[id].pending = 0;
+		gdc_irq[id].wake_thread = 0;
+	}
+}
+
+void system_interrupts_enable( int id )
+{
+	if(id < MAX_GDC_CORES && gdc_irq[id].status == GDC_IRQ_STATUS_DISABLED) {
+		gdc_irq[id].status = GDC_IRQ_STATUS_ENABLED;
+	}
+}
+
+void system_interrupts_disable( int id )
+{
+	if(id < MAX_GDC_CORES && gdc_irq[id].status == GDC_IRQ_STATUS_ENABLED) {
+		gdc_irq[id].status = GDC_IRQ_STATUS_DISABLED;
+	}
+}
+
+void system_interrupts_sim_raise( int id, u64 deadline_ns )
+{
+	if(id < MAX_GDC_CORES) {
+		gdc_irq[id].pending = 1;
+		gdc_irq[id].deadline = deadline_ns;
+	}
+}
+
+void system_interrupts_sim_cancel( int id )
+{
+	if(id < MAX_GDC_CORES) {
+		gdc_irq[id].pending = 0;
+	}
+}
+
+u64 system_interrupts_sim_next_deadline( void )
+{
+	u64 next = system_timer_sim_next_deadline();
+	int id;
+	for(id = 0; id < MAX_GDC_CORES; id++) {
+		if(gdc_irq[id].pending && (next == 0 || gdc_irq[id].deadline < next))
+			next = gdc_irq[id].deadline;
+	}
+	return next;
+}
+
+int system_interrupts_sim_dispatch( int wait )
+{
+	int delivered = 0;
+	int id;
+	u64 now;
+
+	if(wait) {
+		u64 next = system_interrupts_sim_next_deadline();
+		now = system_host_time_ns();
+		if(next > now) {
+			struct timespec ts;
+			ts.tv_sec = ( next - now ) / 1000000000ULL;
+			ts.tv_nsec = ( next - now ) % 1000000000ULL;
+			nanosleep(&ts, NULL);
+		}
+	}
+
+	now = system_host_time_ns();
+	for(id = 0; id < MAX_GDC_CORES; id++) {
+		if(!gdc_irq[id].pending || gdc_irq[id].deadline > now)
+			continue;
+		//the hardware finishes the frame whether or not the interrupt is enabled
+		gdc_irq[id].pending = 0;
+		system_gdc_sim_complete(id);
+		if(gdc_irq[id].status == GDC_IRQ_STATUS_ENABLED) {
+			u64 t0 = system_host_time_ns();
+			system_interrupt_handler(id);
+			sim_hard_ns += system_host_time_ns() - t0;
+			delivered++;
+		}
+	}
+	//threaded handlers run once every due interrupt was handled
+	for(id = 0; id < MAX_GDC_CORES; id++) {
+		if(gdc_irq[id].wake_thread) {
+			gdc_irq[id].wake_thread = 0;
+			gdc_irq[id].thread_handler(gdc_irq[id].thread_param, 1);
+		}
+	}
+	//a watchdog expiry ends a job attempt like its interrupt would
+	delivered += system_timer_sim_dispatch();
+	return delivered;
+}
+
+u64 system_interrupts_sim_hard_ns( void )
+{
+	return sim_hard_ns;
+}
@@ -0,0 +1,57 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+
+//host implementation of the spinlock layer, the simulated interrupt handler runs in a normal thread
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "system_spinlock.h"
+
+int32_t system_spinlock_init( sys_spinlock *lock )
+{
+    pthread_mutex_t *mutex = malloc( sizeof( pthread_mutex_t ) );
+    if ( mutex == NULL || pthread_mutex_init( mutex, NULL ) != 0 ) {
+        free( mutex );
+        *lock = NULL;
+        return -1;
+    }
+    *lock = mutex;
+    return 0;
+}
+
+unsigned long system_spinlock_lock( sys_spinlock lock )
+{
+    pthread_mutex_lock( (pthread_mutex_t *)lock );
+    return 0;
+}
+
+void system_spinlock_unlock( sys_spinlock lock, unsigned long flags )
+{
+    pthread_mutex_unlock( (pthread_mutex_t *)lock );
+}
+
+void system_spinlock_destroy( sys_spinlock lock )
+{
+    if ( lock ) {
+        pthread_mutex_destroy( (pthread_mutex_t *)lock );
+        free( lock );
+    }
+}
@@ -0,0 +1,125 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "system_stdlib.h"
+#include "system_host_sim.h"
+
+
+//the ddr window is a heap arena in the host build
+void * system_ddr_mem_init() {
+	static void *p_base = NULL;
+	if ( p_base == NULL ) {
+		p_base = calloc( 1, HOST_DDR_MEM_SIZE );
+	}
+	return p_base ;
+}
+
+int32_t system_memcpy( void* dst, const void* src, uint32_t size ) {
+	int32_t result = 0 ;
+	memcpy( dst, src, size ) ;
+	return result ;
+}
+
+
+int32_t system_memset( void* ptr, uint8_t value, uint32_t size ) {
+	int32_t result = 0 ;
+	memset( ptr, value, size ) ;
+	return result ;
+}
+
+
+//there is no dma engine in the host build
+int32_t system_dma_memcpy_init( void ) {
+	return -1 ;
+}
+
+
+void system_dma_memcpy_deinit( void ) {
+}
+
+
+int32_t system_dma_memcpy( void* dst, const void* src, uint32_t size ) {
+	return -1 ;
+}
+
+
+//slicing by 8 over the reflected 0xEDB88320 polynomial, same result as the kernel crc32_le
+static uint32_t crc32_table[8][256];
+
+static void crc32_table_init( void ) {
+	uint32_t i, j;
+	for ( i = 0; i < 256; i++ ) {
+		uint32_t c = i;
+		for ( j = 0; j < 8; j++ )
+			c = ( c >> 1 ) ^ ( ( c & 1 ) ? 0xEDB88320 : 0 );
+		crc32_table[0][i] = c;
+	}
+	for ( i = 0; i < 256; i++ ) {
+		for ( j = 1; j < 8; j++ )
+			crc32_table[j][i] = ( crc32_table[j - 1][i] >> 8 ) ^ crc32_table[0][crc32_table[j - 1][i] & 0xff];
+	}
+}
+
+uint32_t system_crc32( uint32_t crc, const void *data, uint32_t size ) {
+	const uint8_t *p = data;
+	static pthread_once_t once = PTHREAD_ONCE_INIT;
+	pthread_once( &once, crc32_table_init );
+	crc = ~crc;
+	while ( size && ( (uintptr_t)p & 7 ) ) {
+		crc = ( crc >> 8 ) ^ crc32_table[0][( crc ^ *p++ ) & 0xff];
+		size--;
+	}
+	for ( ; size >= 8; size -= 8, p += 8 ) {
+		uint32_t lo = ( (const uint32_t *)p )[0] ^ crc;
+		uint32_t hi = ( (const uint32_t *)p )[1];
+		crc = crc32_table[7][lo & 0xff] ^ crc32_table[6][( lo >> 8 ) & 0xff] ^
+		      crc32_table[5][( lo >> 16 ) & 0xff] ^ crc32_table[4][lo >> 24] ^
+		      crc32_table[3][hi & 0xff] ^ crc32_table[2][( hi >> 8 ) & 0xff] ^
+		      crc32_table[1][( hi >> 16 ) & 0xff] ^ crc32_table[0][hi >> 24];
+	}
+	while ( size-- )
+		crc = ( crc >> 8 ) ^ crc32_table[0][( crc ^ *p++ ) & 0xff];
+	return ~crc;
+}
+
+
+u64 system_time_ns( void ) {
+	return system_host_time_ns() ;
+}
+
+
+//below this nanosleep wakes up too late, so the wait spins like ndelay
+#define SYSTEM_SLEEP_SPIN_NS ( 10000 )
+
+void system_sleep_ns( u64 ns ) {
+	u64 end = system_host_time_ns() + ns ;
+	if ( ns >= SYSTEM_SLEEP_SPIN_NS ) {
+		struct timespec ts ;
+		ts.tv_sec = ns / 1000000000ULL ;
+		ts.tv_nsec = ns % 1000000000ULL ;
+		nanosleep( &ts, NULL ) ;
+	}
+	while ( system_host_time_ns() < end )
+		;
+}
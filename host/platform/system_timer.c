@@ -0,0 +1,108 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//host implementation of the timer layer, timers expire from system_interrupts_sim_dispatch
+
+#include <stdlib.h>
+
+#include "system_timer.h"
+#include "system_host_sim.h"
+
+typedef struct system_timer {
+    struct system_timer *next;
+    system_timer_handler_t handler;
+    system_timer_handler_t thread_handler;
+    void *param;
+    u64 deadline;   //host time of the expiry, 0 when the timer is not armed
+} system_timer_t;
+
+static system_timer_t *sim_timers;
+
+int32_t system_timer_init( sys_timer *timer, system_timer_handler_t handler, void *param )
+{
+    system_timer_t *t = calloc( 1, sizeof( system_timer_t ) );
+    if ( t == NULL ) {
+        *timer = NULL;
+        return -1;
+    }
+    t->handler = handler;
+    t->param = param;
+    t->next = sim_timers;
+    sim_timers = t;
+    *timer = t;
+    return 0;
+}
+
+void system_timer_set_thread_handler( sys_timer timer, system_timer_handler_t handler )
+{
+    ( (system_timer_t *)timer )->thread_handler = handler;
+}
+
+void system_timer_arm( sys_timer timer, u64 timeout_ns )
+{
+    ( (system_timer_t *)timer )->deadline = system_host_time_ns() + timeout_ns;
+}
+
+void system_timer_cancel( sys_timer timer )
+{
+    ( (system_timer_t *)timer )->deadline = 0;
+}
+
+void system_timer_destroy( sys_timer timer )
+{
+    system_timer_t **t;
+    for ( t = &sim_timers; *t != NULL; t = &( *t )->next ) {
+        if ( *t == timer ) {
+            *t = ( *t )->next;
+            free( timer );
+            return;
+        }
+    }
+}
+
+u64 system_timer_sim_next_deadline( void )
+{
+    system_timer_t *t;
+    u64 next = 0;
+    for ( t = sim_timers; t != NULL; t = t->next ) {
+        if ( t->deadline && ( next == 0 || t->deadline < next ) )
+            next = t->deadline;
+    }
+    return next;
+}
+
+int system_timer_sim_dispatch( void )
+{
+    u64 now = system_host_time_ns();
+    system_timer_t *t;
+    int expired = 0;
+    for ( t = sim_timers; t != NULL; t = t->next ) {
+        if ( t->deadline && t->deadline <= now ) {
+            //a one shot timer, the handler may arm it again
+            t->deadline = 0;
+            if ( t->handler )
+                t->handler( t->param );
+            //the work item of the target runs right after the timer
+            if ( t->thread_handler )
+                t->thread_handler( t->param );
+            expired++;
+        }
+    }
+    return expired;
+}
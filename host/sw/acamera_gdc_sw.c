@@ -0,0 +1,394 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "acamera_gdc_sw.h"
+#include "acamera_gdc_sw_kernels.h"
+#include "system_log.h"
+
+//fixed point of the source coordinates
+#define SW_COORD_SHIFT 16
+#define SW_PHASE_SHIFT ( SW_COORD_SHIFT - 4 )
+
+//largest sum of absolute taps that keeps the 8 bit vertical pass within int16
+#define SW_MAX_TAP_GAIN 128
+
+// per worker scratch memory
+typedef struct sw_scratch {
+    sw_step_t *steps;
+    uint32_t steps_size;
+    void *tmp;          //vertical pass output, int16 for 8 bit data, int32 otherwise
+    uint32_t tmp_size;  //in samples
+} sw_scratch_t;
+
+// one unit of work: a tile of a tile list
+typedef struct sw_work {
+    const gdc_seq_tile_list_t *list;
+    uint32_t tile;
+} sw_work_t;
+
+typedef struct sw_job {
+    const gdc_seq_t *seq;
+    const acamera_gdc_sw_frame_t *in;
+    acamera_gdc_sw_frame_t *out;
+    const sw_kernels_t *kernels;
+    sw_work_t *work;
+    uint32_t num_work;
+    uint32_t next;      //next work item, taken atomically
+    int errors;
+} sw_job_t;
+
+//in order of preference
+static const sw_kernels_t *const sw_kernels_all[] = {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    &sw_kernels_avx2,
+    &sw_kernels_sse4,
+#endif
+#if GDC_SW_NEON
+    &sw_kernels_neon,
+#endif
+    &sw_kernels_scalar,
+};
+
+static const sw_kernels_t *sw_kernels_selected;
+
+//source position of output pixel o for a linear mapping of out_size pixels onto in_size pixels at in_start
+static inline int32_t sw_source_pos( uint32_t o, uint32_t in_start, uint32_t in_size, uint32_t out_size )
+{
+    int64_t scale = ( (int64_t)in_size << SW_COORD_SHIFT ) / out_size;
+    return (int32_t)( ( (int64_t)in_start << SW_COORD_SHIFT ) + ( ( ( 2 * (int64_t)o + 1 ) * scale ) >> 1 ) - ( 1 << ( SW_COORD_SHIFT - 1 ) ) );
+}
+
+static int sw_reserve( sw_scratch_t *scratch, uint32_t steps, uint32_t samples )
+{
+    if ( steps > scratch->steps_size ) {
+        free( scratch->steps );
+        scratch->steps = malloc( steps * sizeof( sw_step_t ) );
+        scratch->steps_size = scratch->steps ? steps : 0;
+    }
+    if ( samples > scratch->tmp_size ) {
+        free( scratch->tmp );
+        //vector kernels may read a few samples past the end of a line
+        scratch->tmp = malloc( ( samples + SW_TMP_PAD ) * sizeof( int32_t ) );
+        scratch->tmp_size = scratch->tmp ? samples : 0;
+    }
+    return ( steps <= scratch->steps_size && samples <= scratch->tmp_size ) ? 0 : -1;
+}
+
+//resample one tile into one plane, comp_mask selects the interleaved channels of the plane to write
+static int sw_tile_plane( const sw_job_t *job, sw_scratch_t *scratch, const gdc_seq_tile_t *tile, uint32_t plane, uint32_t comp_mask )
+{
+    const acamera_gdc_sw_plane_t *ip = &job->in->planes[plane];
+    const acamera_gdc_sw_plane_t *op = &job->out->planes[plane];
+    const gdc_seq_bank_t *hbank = acamera_gdc_seq_bank( job->seq, tile->hbank );
+    const gdc_seq_bank_t *vbank = acamera_gdc_seq_bank( job->seq, tile->vbank );
+    uint32_t ch = ip->channels;
+    uint32_t out_w, out_h, ox, oy, c;
+    int32_t lo, hi, c0, c1, j;
+    int wide = job->in->bit_depth > 8;
+
+    if ( hbank == NULL || vbank == NULL || tile->in_width == 0 || tile->in_height == 0 ) {
+        return -1;
+    }
+    if ( tile->out_x >= op->width || tile->out_y >= op->height ) {
+        return -1;
+    }
+    out_w = tile->out_width;
+    out_h = tile->out_height;
+    if ( tile->out_x + out_w > op->width )
+        out_w = op->width - tile->out_x;
+    if ( tile->out_y + out_h > op->height )
+        out_h = op->height - tile->out_y;
+    if ( out_w == 0 || out_h == 0 ) {
+        return 0;
+    }
+
+    //columns are the same for every line of the tile
+    if ( sw_reserve( scratch, out_w, 0 ) != 0 ) {
+        return -1;
+    }
+    for ( ox = 0; ox < out_w; ox++ ) {
+        int32_t x = sw_source_pos( ox, tile->in_x, tile->in_width, tile->out_width );
+        int32_t phase = ( x >> SW_PHASE_SHIFT ) & ( ACAMERA_GDC_SEQ_PHASES - 1 );
+        scratch->steps[ox].idx = ( x >> SW_COORD_SHIFT ) - 1;
+        for ( j = 0; j < ACAMERA_GDC_SEQ_TAPS; j++ ) {
+            scratch->steps[ox].taps[j] = hbank->taps[phase][j];
+        }
+    }
+    lo = scratch->steps[0].idx;
+    hi = scratch->steps[out_w - 1].idx + ACAMERA_GDC_SEQ_TAPS - 1;
+    for ( ox = 0; ox < out_w; ox++ ) {
+        scratch->steps[ox].idx -= lo;
+    }
+    if ( sw_reserve( scratch, 0, ( hi - lo + 1 ) * ch ) != 0 ) {
+        return -1;
+    }
+
+    //source columns that exist in the plane, the rest replicates the edge
+    c0 = sw_clamp( lo, 0, ip->width - 1 );
+    c1 = sw_clamp( hi, 0, ip->width - 1 );
+
+    for ( oy = 0; oy < out_h; oy++ ) {
+        int32_t y = sw_source_pos( oy, tile->in_y, tile->in_height, tile->out_height );
+        int32_t iy = ( y >> SW_COORD_SHIFT ) - 1;
+        const int8_t *vtaps = vbank->taps[( y >> SW_PHASE_SHIFT ) & ( ACAMERA_GDC_SEQ_PHASES - 1 )];
+        const uint8_t *rows[ACAMERA_GDC_SEQ_TAPS] = {NULL};
+        uint32_t sample = wide ? 2 : 1;
+        //vertical pass writes at the column of c0 unless the whole span lies outside the plane
+        int32_t base = ( c0 >= lo && c0 <= hi ) ? c0 - lo : 0;
+        uint32_t n = ( c1 - c0 + 1 ) * ch;
+        uint8_t *dst_line = (uint8_t *)op->data + ( tile->out_y + oy ) * op->stride + ( tile->out_x * ch ) * sample;
+
+        for ( j = 0; j < ACAMERA_GDC_SEQ_TAPS; j++ ) {
+            rows[j] = (const uint8_t *)ip->data + sw_clamp( iy + j, 0, ip->height - 1 ) * ip->stride + c0 * ch * sample;
+        }
+
+        if ( wide ) {
+            int32_t *tmp = scratch->tmp;
+            job->kernels->vfilter_16( (const uint16_t *const *)rows, vtaps, tmp + base * ch, n );
+            for ( j = 0; j < base; j++ )
+                for ( c = 0; c < ch; c++ )
+                    tmp[j * ch + c] = tmp[base * ch + c];
+            for ( j = base + c1 - c0 + 1; j <= hi - lo; j++ )
+                for ( c = 0; c < ch; c++ )
+                    tmp[j * ch + c] = tmp[( base + c1 - c0 ) * ch + c];
+            for ( c = 0; c < ch; c++ )
+                if ( comp_mask & ( 1 << c ) )
+                    job->kernels->hfilter_16( tmp + c, ch, scratch->steps, (uint16_t *)dst_line + c, out_w, ( 1 << job->in->bit_depth ) - 1 );
+        } else {
+            int16_t *tmp = scratch->tmp;
+            job->kernels->vfilter_8( rows, vtaps, tmp + base * ch, n );
+            for ( j = 0; j < base; j++ )
+                for ( c = 0; c < ch; c++ )
+                    tmp[j * ch + c] = tmp[base * ch + c];
+            for ( j = base + c1 - c0 + 1; j <= hi - lo; j++ )
+                for ( c = 0; c < ch; c++ )
+                    tmp[j * ch + c] = tmp[( base + c1 - c0 ) * ch + c];
+            for ( c = 0; c < ch; c++ )
+                if ( comp_mask & ( 1 << c ) )
+                    job->kernels->hfilter_8( tmp + c, ch, scratch->steps, dst_line + c, out_w );
+        }
+    }
+
+    return 0;
+}
+
+//maps the channels of a tile to planes, channels 1 and 2 share the second plane of two plane formats
+static int sw_tile( const sw_job_t *job, sw_scratch_t *scratch, const gdc_seq_tile_t *tile )
+{
+    uint32_t num_planes = job->in->num_planes;
+
+    if ( num_planes == 2 ) {
+        if ( ( tile->channel_mask & 0x1 ) && sw_tile_plane( job, scratch, tile, 0, 0x1 ) != 0 )
+            return -1;
+        if ( ( tile->channel_mask & 0x6 ) && sw_tile_plane( job, scratch, tile, 1, tile->channel_mask >> 1 ) != 0 )
+            return -1;
+    } else {
+        uint32_t p;
+        for ( p = 0; p < ACAMERA_GDC_SEQ_MAX_CHANNELS; p++ ) {
+            if ( !( tile->channel_mask & ( 1 << p ) ) )
+                continue;
+            if ( p >= num_planes || sw_tile_plane( job, scratch, tile, p, 0x1 ) != 0 )
+                return -1;
+        }
+    }
+    return 0;
+}
+
+static void *sw_worker( void *arg )
+{
+    sw_job_t *job = arg;
+    sw_scratch_t scratch = {0};
+    int errors = 0;
+
+    for ( ;; ) {
+        uint32_t i = __atomic_fetch_add( &job->next, 1, __ATOMIC_RELAXED );
+        gdc_seq_tile_t tile;
+        if ( i >= job->num_work )
+            break;
+        acamera_gdc_seq_tile_decode( job->work[i].list, job->work[i].tile, &tile );
+        if ( sw_tile( job, &scratch, &tile ) != 0 ) {
+            errors++;
+        }
+    }
+
+    free( scratch.steps );
+    free( scratch.tmp );
+    if ( errors ) {
+        __atomic_fetch_add( &job->errors, errors, __ATOMIC_RELAXED );
+    }
+    return NULL;
+}
+
+//taps must keep the 8 bit vertical pass inside int16
+static int sw_check_banks( const gdc_seq_t *seq )
+{
+    uint32_t b, p, t;
+    for ( b = 0; b < seq->num_banks; b++ ) {
+        for ( p = 0; p < ACAMERA_GDC_SEQ_PHASES; p++ ) {
+            int32_t gain = 0;
+            for ( t = 0; t < ACAMERA_GDC_SEQ_TAPS; t++ ) {
+                int32_t v = seq->banks[b].taps[p][t];
+                gain += v < 0 ? -v : v;
+            }
+            if ( gain > SW_MAX_TAP_GAIN ) {
+                LOG( LOG_ERR, "GDC sw filter bank %u phase %u gain %d too high.\n", seq->banks[b].index, p, gain );
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int acamera_gdc_sw_process( const gdc_seq_t *seq, const acamera_gdc_sw_frame_t *in, acamera_gdc_sw_frame_t *out, uint32_t num_threads )
+{
+    pthread_t threads[ACAMERA_GDC_SW_MAX_THREADS];
+    sw_job_t job = {0};
+    uint32_t i, t, started = 0;
+
+    if ( in->num_planes == 0 || in->num_planes > ACAMERA_GDC_MAX_INPUT || in->num_planes != out->num_planes ||
+         in->bit_depth != out->bit_depth || ( in->bit_depth != 8 && in->bit_depth != 10 ) ) {
+        LOG( LOG_ERR, "GDC sw frames do not match.\n" );
+        return -1;
+    }
+    for ( i = 0; i < in->num_planes; i++ ) {
+        if ( in->planes[i].channels != out->planes[i].channels || in->planes[i].width == 0 || in->planes[i].height == 0 ) {
+            LOG( LOG_ERR, "GDC sw plane %u does not match.\n", i );
+            return -1;
+        }
+    }
+    if ( in->bit_depth == 8 && sw_check_banks( seq ) != 0 ) {
+        return -1;
+    }
+
+    for ( i = 0; i < seq->num_tile_lists; i++ ) {
+        job.num_work += seq->tile_lists[i].num_tiles;
+    }
+    job.work = malloc( job.num_work * sizeof( sw_work_t ) + 1 );
+    if ( job.work == NULL ) {
+        return -1;
+    }
+    job.num_work = 0;
+    for ( i = 0; i < seq->num_tile_lists; i++ ) {
+        for ( t = 0; t < seq->tile_lists[i].num_tiles; t++ ) {
+            job.work[job.num_work].list = &seq->tile_lists[i];
+            job.work[job.num_work].tile = t;
+            job.num_work++;
+        }
+    }
+    job.seq = seq;
+    job.in = in;
+    job.out = out;
+    if ( sw_kernels_selected == NULL )
+        acamera_gdc_sw_set_isa( NULL );
+    job.kernels = sw_kernels_selected;
+
+    if ( num_threads == 0 ) {
+        long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+        num_threads = cpus > 0 ? cpus : 1;
+    }
+    if ( num_threads > ACAMERA_GDC_SW_MAX_THREADS )
+        num_threads = ACAMERA_GDC_SW_MAX_THREADS;
+    if ( num_threads > job.num_work )
+        num_threads = job.num_work ? job.num_work : 1;
+
+    //the calling thread is worker 0
+    for ( t = 1; t < num_threads; t++ ) {
+        if ( pthread_create( &threads[t], NULL, sw_worker, &job ) != 0 )
+            break;
+        started++;
+    }
+    sw_worker( &job );
+    for ( t = 1; t <= started; t++ ) {
+        pthread_join( threads[t], NULL );
+    }
+    free( job.work );
+
+    if ( job.errors ) {
+        LOG( LOG_ERR, "GDC sw %d tiles do not fit the frame.\n", job.errors );
+        return -1;
+    }
+    return 0;
+}
+
+int acamera_gdc_sw_set_isa( const char *isa )
+{
+    uint32_t i;
+    for ( i = 0; i < sizeof( sw_kernels_all ) / sizeof( sw_kernels_all[0] ); i++ ) {
+        const sw_kernels_t *k = sw_kernels_all[i];
+        if ( isa != NULL && strcmp( isa, "auto" ) != 0 && strcmp( isa, k->name ) != 0 )
+            continue;
+        if ( k->supported() ) {
+            sw_kernels_selected = k;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *acamera_gdc_sw_get_isa( void )
+{
+    if ( sw_kernels_selected == NULL )
+        acamera_gdc_sw_set_isa( NULL );
+    return sw_kernels_selected->name;
+}
+
+int acamera_gdc_sw_frame_alloc( acamera_gdc_sw_frame_t *frame, uint32_t num_planes, uint32_t width, uint32_t height,
+                                uint8_t div_width, uint8_t div_height, uint32_t bit_depth )
+{
+    uint32_t i;
+    uint32_t sample = bit_depth > 8 ? 2 : 1;
+
+    system_memset( frame, 0, sizeof( *frame ) );
+    if ( num_planes == 0 || num_planes > ACAMERA_GDC_MAX_INPUT ) {
+        return -1;
+    }
+    frame->num_planes = num_planes;
+    frame->bit_depth = bit_depth;
+    for ( i = 0; i < num_planes; i++ ) {
+        acamera_gdc_sw_plane_t *p = &frame->planes[i];
+        p->channels = ( num_planes == 2 && i == 1 ) ? 2 : 1;
+        p->width = i ? width >> div_width : width;
+        p->height = i ? height >> div_height : height;
+        //semiplanar uv keeps the line length of the y plane
+        if ( p->channels == 2 )
+            p->width /= 2;
+        //64 byte aligned lines
+        p->stride = ( p->width * p->channels * sample + 63 ) & ~63;
+        p->data = calloc( p->height, p->stride );
+        if ( p->data == NULL ) {
+            acamera_gdc_sw_frame_free( frame );
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void acamera_gdc_sw_frame_free( acamera_gdc_sw_frame_t *frame )
+{
+    uint32_t i;
+    for ( i = 0; i < ACAMERA_GDC_MAX_INPUT; i++ ) {
+        free( frame->planes[i].data );
+        frame->planes[i].data = NULL;
+    }
+}
@@ -0,0 +1,104 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __ACAMERA_GDC_SW_H__
+#define __ACAMERA_GDC_SW_H__
+
+#include "acamera_gdc_api.h"
+#include "acamera_gdc_seq.h"
+
+/*
+ * Software model of the gdc tile lists.
+ *
+ * Executes the tile lists of a configuration sequence on host buffers. Each
+ * output tile is mapped linearly onto its input rectangle and resampled with
+ * the 4 tap polyphase filter banks of the sequence, vertical pass first. The
+ * mesh section is not evaluated, so the result is a piecewise linear
+ * approximation of the hardware warp at tile granularity. It measures the
+ * cost of the tile lists and filters but neither checks the hardware output
+ * nor replaces the block.
+ */
+
+#define ACAMERA_GDC_SW_MAX_THREADS 64
+
+// one image plane, 10 bit data is stored in 16 bit samples
+typedef struct acamera_gdc_sw_plane {
+    void *data;
+    uint32_t width;     //width in pixels
+    uint32_t height;    //height in lines
+    uint32_t stride;    //line offset in bytes
+    uint32_t channels;  //interleaved channels, 2 for the uv plane of semiplanar formats
+} acamera_gdc_sw_plane_t;
+
+typedef struct acamera_gdc_sw_frame {
+    uint32_t num_planes;
+    uint32_t bit_depth; //8 or 10
+    acamera_gdc_sw_plane_t planes[ACAMERA_GDC_MAX_INPUT];
+} acamera_gdc_sw_frame_t;
+
+/**
+ *   Allocate the planes of a frame
+ *
+ *   Plane 0 has the full resolution, the other planes are divided by div_width/div_height.
+ *   With two planes the second one holds two interleaved channels.
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int acamera_gdc_sw_frame_alloc( acamera_gdc_sw_frame_t *frame, uint32_t num_planes, uint32_t width, uint32_t height,
+                                uint8_t div_width, uint8_t div_height, uint32_t bit_depth );
+
+/**
+ *   Release the planes allocated by acamera_gdc_sw_frame_alloc
+ */
+void acamera_gdc_sw_frame_free( acamera_gdc_sw_frame_t *frame );
+
+/**
+ *   Run a parsed configuration sequence on a frame
+ *
+ *   Tiles are distributed over num_threads worker threads, 0 uses one thread per cpu.
+ *   Input and output frames must have the same plane layout and bit depth.
+ *
+ *   @param  seq - parsed sequence
+ *   @param  in - input frame
+ *   @param  out - output frame
+ *   @param  num_threads - number of worker threads
+ *
+ *   @return 0 - success
+ *           -1 - sequence does not match the frames.
+ */
+int acamera_gdc_sw_process( const gdc_seq_t *seq, const acamera_gdc_sw_frame_t *in, acamera_gdc_sw_frame_t *out, uint32_t num_threads );
+
+/**
+ *   Select the interpolation kernels
+ *
+ *   isa is one of scalar, sse4, avx2 or neon. NULL or "auto" picks the fastest
+ *   kernels the cpu supports, which is also the default.
+ *
+ *   @return 0 - success
+ *           -1 - kernels are not built in or not supported by the cpu.
+ */
+int acamera_gdc_sw_set_isa( const char *isa );
+
+/**
+ *   Name of the selected interpolation kernels
+ */
+const char *acamera_gdc_sw_get_isa( void );
+
+#endif
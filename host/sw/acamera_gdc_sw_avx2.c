@@ -0,0 +1,174 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//avx2 interpolation kernels, 32 samples per vertical and 8 outputs per horizontal iteration
+
+#include "acamera_gdc_sw_kernels.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+
+#include <immintrin.h>
+
+#include "acamera_gdc_sw_x86.h"
+
+static int avx2_supported( void )
+{
+    return __builtin_cpu_supports( "avx2" );
+}
+
+//the unpack instructions work per 128 bit lane, this puts the two halves back in source order
+#define AVX2_STORE_UNPACKED( dst, lo, hi )                                                     \
+    do {                                                                                       \
+        _mm256_storeu_si256( (__m256i *)( dst ), _mm256_permute2x128_si256( lo, hi, 0x20 ) );   \
+        _mm256_storeu_si256( (__m256i *)( dst ) + 1, _mm256_permute2x128_si256( lo, hi, 0x31 ) ); \
+    } while ( 0 )
+
+static void avx2_vfilter_8( const uint8_t *const rows[ACAMERA_GDC_SEQ_TAPS], const int8_t *taps, int16_t *dst, uint32_t n )
+{
+    const __m256i t01 = _mm256_set1_epi16( x86_tap_pair_8( taps, 0, 1 ) );
+    const __m256i t23 = _mm256_set1_epi16( x86_tap_pair_8( taps, 2, 3 ) );
+    const uint8_t *tail[ACAMERA_GDC_SEQ_TAPS];
+    uint32_t i, j;
+
+    for ( i = 0; i + 32 <= n; i += 32 ) {
+        __m256i r0 = _mm256_loadu_si256( (const __m256i *)( rows[0] + i ) );
+        __m256i r1 = _mm256_loadu_si256( (const __m256i *)( rows[1] + i ) );
+        __m256i r2 = _mm256_loadu_si256( (const __m256i *)( rows[2] + i ) );
+        __m256i r3 = _mm256_loadu_si256( (const __m256i *)( rows[3] + i ) );
+        __m256i lo = _mm256_add_epi16( _mm256_maddubs_epi16( _mm256_unpacklo_epi8( r0, r1 ), t01 ), _mm256_maddubs_epi16( _mm256_unpacklo_epi8( r2, r3 ), t23 ) );
+        __m256i hi = _mm256_add_epi16( _mm256_maddubs_epi16( _mm256_unpackhi_epi8( r0, r1 ), t01 ), _mm256_maddubs_epi16( _mm256_unpackhi_epi8( r2, r3 ), t23 ) );
+        AVX2_STORE_UNPACKED( dst + i, lo, hi );
+    }
+    if ( i < n ) {
+        for ( j = 0; j < ACAMERA_GDC_SEQ_TAPS; j++ )
+            tail[j] = rows[j] + i;
+        sw_kernels_sse4.vfilter_8( tail, taps, dst + i, n - i );
+    }
+}
+
+static void avx2_vfilter_16( const uint16_t *const rows[ACAMERA_GDC_SEQ_TAPS], const int8_t *taps, int32_t *dst, uint32_t n )
+{
+    const __m256i t01 = _mm256_set1_epi32( x86_tap_pair_16( taps, 0, 1 ) );
+    const __m256i t23 = _mm256_set1_epi32( x86_tap_pair_16( taps, 2, 3 ) );
+    const uint16_t *tail[ACAMERA_GDC_SEQ_TAPS];
+    uint32_t i, j;
+
+    for ( i = 0; i + 16 <= n; i += 16 ) {
+        __m256i r0 = _mm256_loadu_si256( (const __m256i *)( rows[0] + i ) );
+        __m256i r1 = _mm256_loadu_si256( (const __m256i *)( rows[1] + i ) );
+        __m256i r2 = _mm256_loadu_si256( (const __m256i *)( rows[2] + i ) );
+        __m256i r3 = _mm256_loadu_si256( (const __m256i *)( rows[3] + i ) );
+        __m256i lo = _mm256_add_epi32( _mm256_madd_epi16( _mm256_unpacklo_epi16( r0, r1 ), t01 ), _mm256_madd_epi16( _mm256_unpacklo_epi16( r2, r3 ), t23 ) );
+        __m256i hi = _mm256_add_epi32( _mm256_madd_epi16( _mm256_unpackhi_epi16( r0, r1 ), t01 ), _mm256_madd_epi16( _mm256_unpackhi_epi16( r2, r3 ), t23 ) );
+        AVX2_STORE_UNPACKED( dst + i, lo, hi );
+    }
+    if ( i < n ) {
+        for ( j = 0; j < ACAMERA_GDC_SEQ_TAPS; j++ )
+            tail[j] = rows[j] + i;
+        sw_kernels_sse4.vfilter_16( tail, taps, dst + i, n - i );
+    }
+}
+
+//samples of outputs a and b, output a in the low lane
+static inline __m256i avx2_pair4_16( const int16_t *src, uint32_t channels, const sw_step_t *steps, uint32_t a, uint32_t b )
+{
+    __m128i lo = _mm_unpacklo_epi64( x86_load4_16( src + steps[a].idx * channels, channels ), x86_load4_16( src + steps[a + 1].idx * channels, channels ) );
+    __m128i hi = _mm_unpacklo_epi64( x86_load4_16( src + steps[b].idx * channels, channels ), x86_load4_16( src + steps[b + 1].idx * channels, channels ) );
+    return _mm256_inserti128_si256( _mm256_castsi128_si256( lo ), hi, 1 );
+}
+
+static inline __m256i avx2_taps4_16( const sw_step_t *steps, uint32_t a, uint32_t b )
+{
+    return _mm256_inserti128_si256( _mm256_castsi128_si256( x86_taps2_16( steps + a ) ), x86_taps2_16( steps + b ), 1 );
+}
+
+static void avx2_hfilter_8( const int16_t *src, uint32_t channels, const sw_step_t *steps, uint8_t *dst, uint32_t n )
+{
+    const __m256i round = _mm256_set1_epi32( SW_OUT_ROUND );
+    uint32_t i = 0, k;
+
+    if ( channels <= 2 ) {
+        for ( ; i + 8 <= n; i += 8 ) {
+            const sw_step_t *st = steps + i;
+            //lane 0 holds outputs 0..3, lane 1 outputs 4..7
+            __m256i m0 = _mm256_madd_epi16( avx2_pair4_16( src, channels, st, 0, 4 ), avx2_taps4_16( st, 0, 4 ) );
+            __m256i m1 = _mm256_madd_epi16( avx2_pair4_16( src, channels, st, 2, 6 ), avx2_taps4_16( st, 2, 6 ) );
+            __m256i acc = _mm256_srai_epi32( _mm256_add_epi32( _mm256_hadd_epi32( m0, m1 ), round ), SW_OUT_SHIFT );
+            __m128i out16 = _mm_packs_epi32( _mm256_castsi256_si128( acc ), _mm256_extracti128_si256( acc, 1 ) );
+            __m128i out8 = _mm_packus_epi16( out16, out16 );
+            if ( channels == 1 ) {
+                _mm_storel_epi64( (__m128i *)( dst + i ), out8 );
+            } else {
+                uint8_t out[16];
+                _mm_storeu_si128( (__m128i *)out, out8 );
+                for ( k = 0; k < 8; k++ )
+                    dst[( i + k ) * channels] = out[k];
+            }
+        }
+    }
+    if ( i < n )
+        sw_kernels_sse4.hfilter_8( src, channels, steps + i, dst + i * channels, n - i );
+}
+
+static void avx2_hfilter_16( const int32_t *src, uint32_t channels, const sw_step_t *steps, uint16_t *dst, uint32_t n, int32_t max )
+{
+    const __m256i round = _mm256_set1_epi32( SW_OUT_ROUND );
+    const __m256i vmax = _mm256_set1_epi32( max );
+    uint32_t i = 0, k;
+
+    if ( channels <= 2 ) {
+        for ( ; i + 8 <= n; i += 8 ) {
+            __m256i p[4], acc;
+            __m128i out;
+            //output k in lane 0, output k + 4 in lane 1
+            for ( k = 0; k < 4; k++ ) {
+                const sw_step_t *a = &steps[i + k], *b = &steps[i + k + 4];
+                __m256i s = _mm256_inserti128_si256( _mm256_castsi128_si256( x86_load4_32( src + a->idx * channels, channels ) ),
+                                                     x86_load4_32( src + b->idx * channels, channels ), 1 );
+                __m256i t = _mm256_cvtepi8_epi32( _mm_setr_epi32( sw_step_taps( a ), sw_step_taps( b ), 0, 0 ) );
+                p[k] = _mm256_mullo_epi32( s, t );
+            }
+            acc = _mm256_hadd_epi32( _mm256_hadd_epi32( p[0], p[1] ), _mm256_hadd_epi32( p[2], p[3] ) );
+            acc = _mm256_srai_epi32( _mm256_add_epi32( acc, round ), SW_OUT_SHIFT );
+            acc = _mm256_min_epi32( _mm256_max_epi32( acc, _mm256_setzero_si256() ), vmax );
+            out = _mm_packus_epi32( _mm256_castsi256_si128( acc ), _mm256_extracti128_si256( acc, 1 ) );
+            if ( channels == 1 ) {
+                _mm_storeu_si128( (__m128i *)( dst + i ), out );
+            } else {
+                uint16_t o[8];
+                _mm_storeu_si128( (__m128i *)o, out );
+                for ( k = 0; k < 8; k++ )
+                    dst[( i + k ) * channels] = o[k];
+            }
+        }
+    }
+    if ( i < n )
+        sw_kernels_sse4.hfilter_16( src, channels, steps + i, dst + i * channels, n - i, max );
+}
+
+const sw_kernels_t sw_kernels_avx2 = {
+    .name = "avx2",
+    .supported = avx2_supported,
+    .vfilter_8 = avx2_vfilter_8,
+    .hfilter_8 = avx2_hfilter_8,
+    .vfilter_16 = avx2_vfilter_16,
+    .hfilter_16 = avx2_hfilter_16,
+};
+
+#endif
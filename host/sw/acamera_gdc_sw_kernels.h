@@ -0,0 +1,84 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __ACAMERA_GDC_SW_KERNELS_H__
+#define __ACAMERA_GDC_SW_KERNELS_H__
+
+#include "acamera_gdc_seq.h"
+
+/*
+ * Interpolation kernels of the software gdc.
+ *
+ * The vertical pass applies the 4 taps of one phase to 4 source lines, the
+ * horizontal pass applies per column taps to 4 neighbouring samples of the
+ * vertical result. Every instruction set provides the same four kernels and
+ * all of them are bit exact with the scalar version.
+ */
+
+#define SW_OUT_SHIFT ( 2 * ACAMERA_GDC_SEQ_TAP_SHIFT )
+#define SW_OUT_ROUND ( 1 << ( SW_OUT_SHIFT - 1 ) )
+
+//samples the horizontal kernels may read past the last tap of a line
+#define SW_TMP_PAD 16
+
+//set by the Makefile on arm, where the neon kernels are built and checked at runtime
+#ifndef GDC_SW_NEON
+#define GDC_SW_NEON 0
+#endif
+
+// one output column: first source sample and the taps for its phase
+typedef struct sw_step {
+    int32_t idx;
+    int8_t taps[ACAMERA_GDC_SEQ_TAPS];
+} sw_step_t;
+
+typedef struct sw_kernels {
+    const char *name;
+    int ( *supported )( void );
+    //8 bit data, vertical result in int16
+    void ( *vfilter_8 )( const uint8_t *const rows[ACAMERA_GDC_SEQ_TAPS], const int8_t *taps, int16_t *dst, uint32_t n );
+    void ( *hfilter_8 )( const int16_t *src, uint32_t channels, const sw_step_t *steps, uint8_t *dst, uint32_t n );
+    //10 bit data in 16 bit samples, vertical result in int32
+    void ( *vfilter_16 )( const uint16_t *const rows[ACAMERA_GDC_SEQ_TAPS], const int8_t *taps, int32_t *dst, uint32_t n );
+    void ( *hfilter_16 )( const int32_t *src, uint32_t channels, const sw_step_t *steps, uint16_t *dst, uint32_t n, int32_t max );
+} sw_kernels_t;
+
+extern const sw_kernels_t sw_kernels_scalar;
+#if defined( __x86_64__ ) || defined( __i386__ )
+extern const sw_kernels_t sw_kernels_sse4;
+extern const sw_kernels_t sw_kernels_avx2;
+#endif
+#if GDC_SW_NEON
+extern const sw_kernels_t sw_kernels_neon;
+#endif
+
+static inline int32_t sw_clamp( int32_t v, int32_t lo, int32_t hi )
+{
+    return v < lo ? lo : ( v > hi ? hi : v );
+}
+
+//taps of a step as one word, tap 0 in the low byte
+static inline int32_t sw_step_taps( const sw_step_t *step )
+{
+    int32_t word;
+    __builtin_memcpy( &word, step->taps, sizeof( word ) );
+    return word;
+}
+
+#endif
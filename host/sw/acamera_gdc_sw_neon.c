@@ -0,0 +1,204 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//neon interpolation kernels, 16 samples per vertical and 8 outputs per horizontal iteration
+
+#include "acamera_gdc_sw_kernels.h"
+
+#if GDC_SW_NEON
+
+#include <arm_neon.h>
+#if !defined( __aarch64__ )
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+static int neon_supported( void )
+{
+#if defined( __aarch64__ )
+    return 1;
+#else
+    return ( getauxval( AT_HWCAP ) & HWCAP_NEON ) != 0;
+#endif
+}
+
+//sums of each vector in one vector
+static inline int32x4_t neon_hsum4( int32x4_t a, int32x4_t b, int32x4_t c, int32x4_t d )
+{
+#if defined( __aarch64__ )
+    return vpaddq_s32( vpaddq_s32( a, b ), vpaddq_s32( c, d ) );
+#else
+    int32x2_t ab = vpadd_s32( vpadd_s32( vget_low_s32( a ), vget_high_s32( a ) ), vpadd_s32( vget_low_s32( b ), vget_high_s32( b ) ) );
+    int32x2_t cd = vpadd_s32( vpadd_s32( vget_low_s32( c ), vget_high_s32( c ) ), vpadd_s32( vget_low_s32( d ), vget_high_s32( d ) ) );
+    return vcombine_s32( ab, cd );
+#endif
+}
+
+static inline int16x4_t neon_taps_16( const sw_step_t *step )
+{
+    return vget_low_s16( vmovl_s8( vreinterpret_s8_s32( vdup_n_s32( sw_step_taps( step ) ) ) ) );
+}
+
+//4 samples of a channel, channels is 1 or 2
+static inline int16x4_t neon_load4_16( const int16_t *s, uint32_t channels )
+{
+    return channels == 1 ? vld1_s16( s ) : vld2_s16( s ).val[0];
+}
+
+static inline int32x4_t neon_load4_32( const int32_t *s, uint32_t channels )
+{
+    return channels == 1 ? vld1q_s32( s ) : vld2q_s32( s ).val[0];
+}
+
+static void neon_vfilter_8( const uint8_t *const rows[ACAMERA_GDC_SEQ_TAPS], const int8_t *taps, int16_t *dst, uint32_t n )
+{
+    const uint8_t *tail[ACAMERA_GDC_SEQ_TAPS];
+    uint32_t i, j;
+
+    for ( i = 0; i + 16 <= n; i += 16 ) {
+        uint8x16_t r0 = vld1q_u8( rows[0] + i );
+        uint8x16_t r1 = vld1q_u8( rows[1] + i );
+        uint8x16_t r2 = vld1q_u8( rows[2] + i );
+        uint8x16_t r3 = vld1q_u8( rows[3] + i );
+        int16x8_t lo = vmulq_n_s16( vreinterpretq_s16_u16( vmovl_u8( vget_low_u8( r0 ) ) ), taps[0] );
+        int16x8_t hi = vmulq_n_s16( vreinterpretq_s16_u16( vmovl_u8( vget_high_u8( r0 ) ) ), taps[0] );
+        lo = vmlaq_n_s16( lo, vreinterpretq_s16_u16( vmovl_u8( vget_low_u8( r1 ) ) ), taps[1] );
+        hi = vmlaq_n_s16( hi, vreinterpretq_s16_u16( vmovl_u8( vget_high_u8( r1 ) ) ), taps[1] );
+        lo = vmlaq_n_s16( lo, vreinterpretq_s16_u16( vmovl_u8( vget_low_u8( r2 ) ) ), taps[2] );
+        hi = vmlaq_n_s16( hi, vreinterpretq_s16_u16( vmovl_u8( vget_high_u8( r2 ) ) ), taps[2] );
+        lo = vmlaq_n_s16( lo, vreinterpretq_s16_u16( vmovl_u8( vget_low_u8( r3 ) ) ), taps[3] );
+        hi = vmlaq_n_s16( hi, vreinterpretq_s16_u16( vmovl_u8( vget_high_u8( r3 ) ) ), taps[3] );
+        vst1q_s16( dst + i, lo );
+        vst1q_s16( dst + i + 8, hi );
+    }
+    if ( i < n ) {
+        for ( j = 0; j < ACAMERA_GDC_SEQ_TAPS; j++ )
+            tail[j] = rows[j] + i;
+        sw_kernels_scalar.vfilter_8( tail, taps, dst + i, n - i );
+    }
+}
+
+static void neon_vfilter_16( const uint16_t *const rows[ACAMERA_GDC_SEQ_TAPS], const int8_t *taps, int32_t *dst, uint32_t n )
+{
+    const uint16_t *tail[ACAMERA_GDC_SEQ_TAPS];
+    uint32_t i, j;
+
+    for ( i = 0; i + 8 <= n; i += 8 ) {
+        int16x8_t r0 = vreinterpretq_s16_u16( vld1q_u16( rows[0] + i ) );
+        int16x8_t r1 = vreinterpretq_s16_u16( vld1q_u16( rows[1] + i ) );
+        int16x8_t r2 = vreinterpretq_s16_u16( vld1q_u16( rows[2] + i ) );
+        int16x8_t r3 = vreinterpretq_s16_u16( vld1q_u16( rows[3] + i ) );
+        int32x4_t lo = vmull_n_s16( vget_low_s16( r0 ), taps[0] );
+        int32x4_t hi = vmull_n_s16( vget_high_s16( r0 ), taps[0] );
+        lo = vmlal_n_s16( lo, vget_low_s16( r1 ), taps[1] );
+        hi = vmlal_n_s16( hi, vget_high_s16( r1 ), taps[1] );
+        lo = vmlal_n_s16( lo, vget_low_s16( r2 ), taps[2] );
+        hi = vmlal_n_s16( hi, vget_high_s16( r2 ), taps[2] );
+        lo = vmlal_n_s16( lo, vget_low_s16( r3 ), taps[3] );
+        hi = vmlal_n_s16( hi, vget_high_s16( r3 ), taps[3] );
+        vst1q_s32( dst + i, lo );
+        vst1q_s32( dst + i + 4, hi );
+    }
+    if ( i < n ) {
+        for ( j = 0; j < ACAMERA_GDC_SEQ_TAPS; j++ )
+            tail[j] = rows[j] + i;
+        sw_kernels_scalar.vfilter_16( tail, taps, dst + i, n - i );
+    }
+}
+
+//4 accumulators of outputs first..first+3 before rounding
+static inline int32x4_t neon_hacc4_16( const int16_t *src, uint32_t channels, const sw_step_t *st )
+{
+    int32x4_t p0 = vmull_s16( neon_load4_16( src + st[0].idx * channels, channels ), neon_taps_16( &st[0] ) );
+    int32x4_t p1 = vmull_s16( neon_load4_16( src + st[1].idx * channels, channels ), neon_taps_16( &st[1] ) );
+    int32x4_t p2 = vmull_s16( neon_load4_16( src + st[2].idx * channels, channels ), neon_taps_16( &st[2] ) );
+    int32x4_t p3 = vmull_s16( neon_load4_16( src + st[3].idx * channels, channels ), neon_taps_16( &st[3] ) );
+    return neon_hsum4( p0, p1, p2, p3 );
+}
+
+static inline int32x4_t neon_hacc4_32( const int32_t *src, uint32_t channels, const sw_step_t *st )
+{
+    int32x4_t p0 = vmulq_s32( neon_load4_32( src + st[0].idx * channels, channels ), vmovl_s16( neon_taps_16( &st[0] ) ) );
+    int32x4_t p1 = vmulq_s32( neon_load4_32( src + st[1].idx * channels, channels ), vmovl_s16( neon_taps_16( &st[1] ) ) );
+    int32x4_t p2 = vmulq_s32( neon_load4_32( src + st[2].idx * channels, channels ), vmovl_s16( neon_taps_16( &st[2] ) ) );
+    int32x4_t p3 = vmulq_s32( neon_load4_32( src + st[3].idx * channels, channels ), vmovl_s16( neon_taps_16( &st[3] ) ) );
+    return neon_hsum4( p0, p1, p2, p3 );
+}
+
+static void neon_hfilter_8( const int16_t *src, uint32_t channels, const sw_step_t *steps, uint8_t *dst, uint32_t n )
+{
+    uint32_t i = 0, k;
+
+    if ( channels <= 2 ) {
+        for ( ; i + 8 <= n; i += 8 ) {
+            //vrshr adds the rounding constant before the shift
+            int32x4_t lo = vrshrq_n_s32( neon_hacc4_16( src, channels, steps + i ), SW_OUT_SHIFT );
+            int32x4_t hi = vrshrq_n_s32( neon_hacc4_16( src, channels, steps + i + 4 ), SW_OUT_SHIFT );
+            uint8x8_t out = vqmovn_u16( vcombine_u16( vqmovun_s32( lo ), vqmovun_s32( hi ) ) );
+            if ( channels == 1 ) {
+                vst1_u8( dst + i, out );
+            } else {
+                uint8_t o[8];
+                vst1_u8( o, out );
+                for ( k = 0; k < 8; k++ )
+                    dst[( i + k ) * channels] = o[k];
+            }
+        }
+    }
+    if ( i < n )
+        sw_kernels_scalar.hfilter_8( src, channels, steps + i, dst + i * channels, n - i );
+}
+
+static void neon_hfilter_16( const int32_t *src, uint32_t channels, const sw_step_t *steps, uint16_t *dst, uint32_t n, int32_t max )
+{
+    const int32x4_t vmax = vdupq_n_s32( max );
+    const int32x4_t zero = vdupq_n_s32( 0 );
+    uint32_t i = 0, k;
+
+    if ( channels <= 2 ) {
+        for ( ; i + 8 <= n; i += 8 ) {
+            int32x4_t lo = vrshrq_n_s32( neon_hacc4_32( src, channels, steps + i ), SW_OUT_SHIFT );
+            int32x4_t hi = vrshrq_n_s32( neon_hacc4_32( src, channels, steps + i + 4 ), SW_OUT_SHIFT );
+            lo = vminq_s32( vmaxq_s32( lo, zero ), vmax );
+            hi = vminq_s32( vmaxq_s32( hi, zero ), vmax );
+            uint16x8_t out = vcombine_u16( vmovn_u32( vreinterpretq_u32_s32( lo ) ), vmovn_u32( vreinterpretq_u32_s32( hi ) ) );
+            if ( channels == 1 ) {
+                vst1q_u16( dst + i, out );
+            } else {
+                uint16_t o[8];
+                vst1q_u16( o, out );
+                for ( k = 0; k < 8; k++ )
+                    dst[( i + k ) * channels] = o[k];
+            }
+        }
+    }
+    if ( i < n )
+        sw_kernels_scalar.hfilter_16( src, channels, steps + i, dst + i * channels, n - i, max );
+}
+
+const sw_kernels_t sw_kernels_neon = {
+    .name = "neon",
+    .supported = neon_supported,
+    .vfilter_8 = neon_vfilter_8,
+    .hfilter_8 = neon_hfilter_8,
+    .vfilter_16 = neon_vfilter_16,
+    .hfilter_16 = neon_hfilter_16,
+};
+
+#endif
@@ -0,0 +1,74 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//portable interpolation kernels, also used for the tails of the vector kernels
+
+#include "acamera_gdc_sw_kernels.h"
+
+static int scalar_supported( void )
+{
+    return 1;
+}
+
+static void scalar_vfilter_8( const uint8_t *const rows[ACAMERA_GDC_SEQ_TAPS], const int8_t *taps, int16_t *dst, uint32_t n )
+{
+    uint32_t i;
+    for ( i = 0; i < n; i++ ) {
+        dst[i] = (int16_t)( taps[0] * rows[0][i] + taps[1] * rows[1][i] + taps[2] * rows[2][i] + taps[3] * rows[3][i] );
+    }
+}
+
+static void scalar_vfilter_16( const uint16_t *const rows[ACAMERA_GDC_SEQ_TAPS], const int8_t *taps, int32_t *dst, uint32_t n )
+{
+    uint32_t i;
+    for ( i = 0; i < n; i++ ) {
+        dst[i] = taps[0] * rows[0][i] + taps[1] * rows[1][i] + taps[2] * rows[2][i] + taps[3] * rows[3][i];
+    }
+}
+
+static void scalar_hfilter_8( const int16_t *src, uint32_t channels, const sw_step_t *steps, uint8_t *dst, uint32_t n )
+{
+    uint32_t i;
+    for ( i = 0; i < n; i++ ) {
+        const int16_t *s = src + steps[i].idx * channels;
+        const int8_t *t = steps[i].taps;
+        int32_t acc = t[0] * s[0] + t[1] * s[channels] + t[2] * s[2 * channels] + t[3] * s[3 * channels];
+        dst[i * channels] = (uint8_t)sw_clamp( ( acc + SW_OUT_ROUND ) >> SW_OUT_SHIFT, 0, 255 );
+    }
+}
+
+static void scalar_hfilter_16( const int32_t *src, uint32_t channels, const sw_step_t *steps, uint16_t *dst, uint32_t n, int32_t max )
+{
+    uint32_t i;
+    for ( i = 0; i < n; i++ ) {
+        const int32_t *s = src + steps[i].idx * channels;
+        const int8_t *t = steps[i].taps;
+        int32_t acc = t[0] * s[0] + t[1] * s[channels] + t[2] * s[2 * channels] + t[3] * s[3 * channels];
+        dst[i * channels] = (uint16_t)sw_clamp( ( acc + SW_OUT_ROUND ) >> SW_OUT_SHIFT, 0, max );
+    }
+}
+
+const sw_kernels_t sw_kernels_scalar = {
+    .name = "scalar",
+    .supported = scalar_supported,
+    .vfilter_8 = scalar_vfilter_8,
+    .hfilter_8 = scalar_hfilter_8,
+    .vfilter_16 = scalar_vfilter_16,
+    .hfilter_16 = scalar_hfilter_16,
+};
@@ -0,0 +1,147 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//sse4.1 interpolation kernels, 16 samples per vertical and 4 outputs per horizontal iteration
+
+#include "acamera_gdc_sw_kernels.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+
+#include "acamera_gdc_sw_x86.h"
+
+static int sse4_supported( void )
+{
+    return __builtin_cpu_supports( "sse4.1" );
+}
+
+static void sse4_vfilter_8( const uint8_t *const rows[ACAMERA_GDC_SEQ_TAPS], const int8_t *taps, int16_t *dst, uint32_t n )
+{
+    const __m128i t01 = _mm_set1_epi16( x86_tap_pair_8( taps, 0, 1 ) );
+    const __m128i t23 = _mm_set1_epi16( x86_tap_pair_8( taps, 2, 3 ) );
+    const uint8_t *tail[ACAMERA_GDC_SEQ_TAPS];
+    uint32_t i, j;
+
+    for ( i = 0; i + 16 <= n; i += 16 ) {
+        __m128i r0 = _mm_loadu_si128( (const __m128i *)( rows[0] + i ) );
+        __m128i r1 = _mm_loadu_si128( (const __m128i *)( rows[1] + i ) );
+        __m128i r2 = _mm_loadu_si128( (const __m128i *)( rows[2] + i ) );
+        __m128i r3 = _mm_loadu_si128( (const __m128i *)( rows[3] + i ) );
+        __m128i lo = _mm_add_epi16( _mm_maddubs_epi16( _mm_unpacklo_epi8( r0, r1 ), t01 ), _mm_maddubs_epi16( _mm_unpacklo_epi8( r2, r3 ), t23 ) );
+        __m128i hi = _mm_add_epi16( _mm_maddubs_epi16( _mm_unpackhi_epi8( r0, r1 ), t01 ), _mm_maddubs_epi16( _mm_unpackhi_epi8( r2, r3 ), t23 ) );
+        _mm_storeu_si128( (__m128i *)( dst + i ), lo );
+        _mm_storeu_si128( (__m128i *)( dst + i + 8 ), hi );
+    }
+    if ( i < n ) {
+        for ( j = 0; j < ACAMERA_GDC_SEQ_TAPS; j++ )
+            tail[j] = rows[j] + i;
+        sw_kernels_scalar.vfilter_8( tail, taps, dst + i, n - i );
+    }
+}
+
+static void sse4_vfilter_16( const uint16_t *const rows[ACAMERA_GDC_SEQ_TAPS], const int8_t *taps, int32_t *dst, uint32_t n )
+{
+    const __m128i t01 = _mm_set1_epi32( x86_tap_pair_16( taps, 0, 1 ) );
+    const __m128i t23 = _mm_set1_epi32( x86_tap_pair_16( taps, 2, 3 ) );
+    const uint16_t *tail[ACAMERA_GDC_SEQ_TAPS];
+    uint32_t i, j;
+
+    for ( i = 0; i + 8 <= n; i += 8 ) {
+        __m128i r0 = _mm_loadu_si128( (const __m128i *)( rows[0] + i ) );
+        __m128i r1 = _mm_loadu_si128( (const __m128i *)( rows[1] + i ) );
+        __m128i r2 = _mm_loadu_si128( (const __m128i *)( rows[2] + i ) );
+        __m128i r3 = _mm_loadu_si128( (const __m128i *)( rows[3] + i ) );
+        __m128i lo = _mm_add_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( r0, r1 ), t01 ), _mm_madd_epi16( _mm_unpacklo_epi16( r2, r3 ), t23 ) );
+        __m128i hi = _mm_add_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( r0, r1 ), t01 ), _mm_madd_epi16( _mm_unpackhi_epi16( r2, r3 ), t23 ) );
+        _mm_storeu_si128( (__m128i *)( dst + i ), lo );
+        _mm_storeu_si128( (__m128i *)( dst + i + 4 ), hi );
+    }
+    if ( i < n ) {
+        for ( j = 0; j < ACAMERA_GDC_SEQ_TAPS; j++ )
+            tail[j] = rows[j] + i;
+        sw_kernels_scalar.vfilter_16( tail, taps, dst + i, n - i );
+    }
+}
+
+static void sse4_hfilter_8( const int16_t *src, uint32_t channels, const sw_step_t *steps, uint8_t *dst, uint32_t n )
+{
+    const __m128i round = _mm_set1_epi32( SW_OUT_ROUND );
+    uint32_t i = 0, k;
+
+    if ( channels <= 2 ) {
+        for ( ; i + 4 <= n; i += 4 ) {
+            const sw_step_t *st = steps + i;
+            __m128i s01 = _mm_unpacklo_epi64( x86_load4_16( src + st[0].idx * channels, channels ), x86_load4_16( src + st[1].idx * channels, channels ) );
+            __m128i s23 = _mm_unpacklo_epi64( x86_load4_16( src + st[2].idx * channels, channels ), x86_load4_16( src + st[3].idx * channels, channels ) );
+            __m128i acc = _mm_hadd_epi32( _mm_madd_epi16( s01, x86_taps2_16( st ) ), _mm_madd_epi16( s23, x86_taps2_16( st + 2 ) ) );
+            acc = _mm_srai_epi32( _mm_add_epi32( acc, round ), SW_OUT_SHIFT );
+            acc = _mm_packus_epi16( _mm_packs_epi32( acc, acc ), acc );
+            if ( channels == 1 ) {
+                int32_t out = _mm_cvtsi128_si32( acc );
+                __builtin_memcpy( dst + i, &out, sizeof( out ) );
+            } else {
+                uint8_t out[16];
+                _mm_storeu_si128( (__m128i *)out, acc );
+                for ( k = 0; k < 4; k++ )
+                    dst[( i + k ) * channels] = out[k];
+            }
+        }
+    }
+    if ( i < n )
+        sw_kernels_scalar.hfilter_8( src, channels, steps + i, dst + i * channels, n - i );
+}
+
+static void sse4_hfilter_16( const int32_t *src, uint32_t channels, const sw_step_t *steps, uint16_t *dst, uint32_t n, int32_t max )
+{
+    const __m128i round = _mm_set1_epi32( SW_OUT_ROUND );
+    const __m128i vmax = _mm_set1_epi32( max );
+    uint32_t i = 0, k;
+
+    if ( channels <= 2 ) {
+        for ( ; i + 4 <= n; i += 4 ) {
+            __m128i p[4], acc;
+            for ( k = 0; k < 4; k++ )
+                p[k] = _mm_mullo_epi32( x86_load4_32( src + steps[i + k].idx * channels, channels ), x86_taps_32( &steps[i + k] ) );
+            acc = _mm_hadd_epi32( _mm_hadd_epi32( p[0], p[1] ), _mm_hadd_epi32( p[2], p[3] ) );
+            acc = _mm_srai_epi32( _mm_add_epi32( acc, round ), SW_OUT_SHIFT );
+            acc = _mm_min_epi32( _mm_max_epi32( acc, _mm_setzero_si128() ), vmax );
+            acc = _mm_packus_epi32( acc, acc );
+            if ( channels == 1 ) {
+                _mm_storel_epi64( (__m128i *)( dst + i ), acc );
+            } else {
+                uint16_t out[8];
+                _mm_storeu_si128( (__m128i *)out, acc );
+                for ( k = 0; k < 4; k++ )
+                    dst[( i + k ) * channels] = out[k];
+            }
+        }
+    }
+    if ( i < n )
+        sw_kernels_scalar.hfilter_16( src, channels, steps + i, dst + i * channels, n - i, max );
+}
+
+const sw_kernels_t sw_kernels_sse4 = {
+    .name = "sse4",
+    .supported = sse4_supported,
+    .vfilter_8 = sse4_vfilter_8,
+    .hfilter_8 = sse4_hfilter_8,
+    .vfilter_16 = sse4_vfilter_16,
+    .hfilter_16 = sse4_hfilter_16,
+};
+
+#endif
@@ -0,0 +1,69 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __ACAMERA_GDC_SW_X86_H__
+#define __ACAMERA_GDC_SW_X86_H__
+
+//helpers shared by the sse4 and avx2 kernels, the including file must be built with sse4.1 enabled
+
+#include <smmintrin.h>
+
+#include "acamera_gdc_sw_kernels.h"
+
+//4 taps of one phase duplicated as byte pairs t[a], t[b] for pmaddubsw
+static inline int16_t x86_tap_pair_8( const int8_t *taps, int a, int b )
+{
+    return (int16_t)( (uint8_t)taps[a] | ( (uint8_t)taps[b] << 8 ) );
+}
+
+//taps t[a], t[b] as a pair of int16 for pmaddwd
+static inline int32_t x86_tap_pair_16( const int8_t *taps, int a, int b )
+{
+    return (int32_t)( (uint16_t)taps[a] | ( (uint32_t)(uint16_t)taps[b] << 16 ) );
+}
+
+//4 samples of a channel into the low half of a vector, channels is 1 or 2
+static inline __m128i x86_load4_16( const int16_t *s, uint32_t channels )
+{
+    if ( channels == 1 )
+        return _mm_loadl_epi64( (const __m128i *)s );
+    return _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i *)s ),
+                             _mm_setr_epi8( 0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1 ) );
+}
+
+static inline __m128i x86_load4_32( const int32_t *s, uint32_t channels )
+{
+    if ( channels == 1 )
+        return _mm_loadu_si128( (const __m128i *)s );
+    return _mm_castps_si128( _mm_shuffle_ps( _mm_loadu_ps( (const float *)s ), _mm_loadu_ps( (const float *)( s + 4 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+}
+
+//taps of two consecutive steps as 8 int16
+static inline __m128i x86_taps2_16( const sw_step_t *steps )
+{
+    return _mm_cvtepi8_epi16( _mm_setr_epi32( sw_step_taps( &steps[0] ), sw_step_taps( &steps[1] ), 0, 0 ) );
+}
+
+//taps of one step as 4 int32
+static inline __m128i x86_taps_32( const sw_step_t *step )
+{
+    return _mm_cvtepi8_epi32( _mm_cvtsi32_si128( sw_step_taps( step ) ) );
+}
+
+#endif
@@ -0,0 +1,113 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//cost of switching between the shipped configuration sequences with and without the config cache
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "system_log.h"
+#include "system_host_sim.h"
+#include "acamera_gdc_cache.h"
+#include "gdc_seq_builtin.h"
+
+#define BENCH_REGION_ADDR 0x4000
+#define BENCH_REGION_SIZE 0x40000
+
+//copy and full readback, what gdc_load_settings_to_memory did before the uploader
+static uint32_t bench_load( uint32_t *dst, uint32_t *src, uint32_t words )
+{
+    uint32_t i;
+    system_memcpy( dst, src, words * 4 );
+    for ( i = 0; i < words; i++ ) {
+        if ( dst[i] != src[i] )
+            return 0;
+    }
+    return words * 4;
+}
+
+int main( int argc, char **argv )
+{
+    uint32_t switches = 10000, slots = 8, i, addr;
+    uint32_t *words[16];
+    u64 hash[16];
+    int opt;
+
+    while ( ( opt = getopt( argc, argv, "n:s:h" ) ) != -1 ) {
+        switch ( opt ) {
+        case 'n':
+            switches = strtoul( optarg, NULL, 0 );
+            break;
+        case 's':
+            slots = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "usage: %s [-n switches] [-s slots]\n", argv[0] );
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    void *ddr = system_ddr_mem_init();
+    gdc_cache_t cache;
+    if ( switches == 0 || ddr == NULL || acamera_gdc_cache_init( &cache, (uint8_t *)ddr + BENCH_REGION_ADDR, BENCH_REGION_ADDR, BENCH_REGION_SIZE, slots, bench_load ) != 0 )
+        return 1;
+    for ( i = 0; i < gdc_seq_builtin_count; i++ ) {
+        words[i] = gdc_seq_builtin_copy( &gdc_seq_builtin[i] );
+        if ( words[i] == NULL )
+            return 1;
+        hash[i] = acamera_gdc_cache_hash( words[i], gdc_seq_builtin[i].size );
+    }
+
+    //full copy and verify on every switch, what gdc_fw_init did before the cache
+    u64 t0 = system_host_time_ns();
+    for ( i = 0; i < switches; i++ ) {
+        const gdc_seq_builtin_t *seq = &gdc_seq_builtin[i % gdc_seq_builtin_count];
+        if ( bench_load( (uint32_t *)( (uintptr_t)ddr + BENCH_REGION_ADDR ), words[i % gdc_seq_builtin_count], seq->size / 4 ) != seq->size )
+            return 1;
+    }
+    u64 copy_ns = system_host_time_ns() - t0;
+
+    //hashing the sequence on every switch
+    t0 = system_host_time_ns();
+    for ( i = 0; i < switches; i++ ) {
+        const gdc_seq_builtin_t *seq = &gdc_seq_builtin[i % gdc_seq_builtin_count];
+        if ( acamera_gdc_cache_get( &cache, words[i % gdc_seq_builtin_count], seq->size, &addr ) < 0 )
+            return 1;
+    }
+    u64 get_ns = system_host_time_ns() - t0;
+    uint32_t misses = cache.misses;
+
+    //lookup by a hash remembered from the first load
+    t0 = system_host_time_ns();
+    for ( i = 0; i < switches; i++ ) {
+        const gdc_seq_builtin_t *seq = &gdc_seq_builtin[i % gdc_seq_builtin_count];
+        if ( acamera_gdc_cache_lookup( &cache, hash[i % gdc_seq_builtin_count], seq->size, &addr ) != 0 )
+            break;
+    }
+    u64 lookup_ns = system_host_time_ns() - t0;
+
+    printf( "%u switches over %u sequences, %u slots of %u bytes\n", switches, gdc_seq_builtin_count, cache.num_slots, cache.slot_size );
+    printf( "copy and verify: %8.2f us/switch\n", copy_ns / 1e3 / switches );
+    printf( "cache get:       %8.2f us/switch, %u loads\n", get_ns / 1e3 / switches, misses );
+    printf( "cache lookup:    %8.3f us/switch%s\n", lookup_ns / 1e3 / switches, i == switches ? "" : ", MISSED" );
+
+    for ( i = 0; i < gdc_seq_builtin_count; i++ )
+        free( words[i] );
+    return 0;
+}
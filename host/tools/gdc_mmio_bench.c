@@ -0,0 +1,144 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//cost of programming the frame registers with ordered writes and with relaxed writes and one barrier
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "acamera_driver_config.h"
+#include "system_log.h"
+#include "system_host_sim.h"
+#include "acamera_gdc_api.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#define BENCH_COUNTER "tsc cycles"
+static inline u64 bench_counter( void )
+{
+    return __rdtsc();
+}
+#elif defined( __aarch64__ )
+#define BENCH_COUNTER "cntvct ticks"
+static inline u64 bench_counter( void )
+{
+    u64 v;
+    __asm__ volatile( "isb; mrs %0, cntvct_el0" : "=r"( v ) );
+    return v;
+}
+#else
+#define BENCH_COUNTER "ns"
+static inline u64 bench_counter( void )
+{
+    return system_host_time_ns();
+}
+#endif
+
+extern int32_t init_gdc_io( resource_size_t addr, resource_size_t size );
+extern void close_gdc_io( void );
+
+//one frame setup as gdc_start_job does it, with the address registers written ordered or relaxed
+static void bench_frame( gdc_settings_t *settings, uint32_t frame, int relaxed )
+{
+    gdc_program_t *program = &settings->program;
+    uint32_t i;
+    for ( i = 0; i < 2 * program->num_planes; i++ ) {
+        system_gdc_reg_write_t *reg = &program->regs[program->num_static + i];
+        reg->data = 0x100000 + ( ( frame & 3 ) << 20 ) + i * 0x40000;
+        if ( relaxed )
+            system_gdc_write_32_relaxed( reg->addr, reg->data );
+        else
+            system_gdc_write_32( reg->addr, reg->data );
+    }
+    acamera_gdc_start( settings );
+}
+
+static void bench_mode( gdc_settings_t *settings, uint32_t frames, int relaxed )
+{
+    system_gdc_sim_counters_t before, after;
+    uint32_t i;
+
+    system_gdc_sim_get_counters( &before );
+    u64 t0 = system_host_time_ns();
+    u64 c0 = bench_counter();
+    for ( i = 0; i < frames; i++ )
+        bench_frame( settings, i, relaxed );
+    u64 c = bench_counter() - c0;
+    u64 ns = system_host_time_ns() - t0;
+    system_gdc_sim_get_counters( &after );
+
+    printf( "%-8s %12.1f %10.1f %8.1f %8.1f\n", relaxed ? "relaxed" : "ordered",
+            (double)c / frames, (double)ns / frames,
+            (double)( after.writes - before.writes ) / frames,
+            (double)( after.barriers - before.barriers ) / frames );
+}
+
+int main( int argc, char **argv )
+{
+    uint32_t frames = 1000000, planes = 3, round;
+    int opt;
+
+    while ( ( opt = getopt( argc, argv, "n:p:h" ) ) != -1 ) {
+        switch ( opt ) {
+        case 'n':
+            frames = strtoul( optarg, NULL, 0 );
+            break;
+        case 'p':
+            planes = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "usage: %s [-n frames] [-p planes]\n", argv[0] );
+            printf( "  -n  frame setups per mode (default 1000000)\n" );
+            printf( "  -p  planes per frame 1..%d (default 3)\n", ACAMERA_GDC_MAX_INPUT );
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if ( frames == 0 || planes == 0 || planes > ACAMERA_GDC_MAX_INPUT ) {
+        printf( "frames must be positive and planes 1..%d\n", ACAMERA_GDC_MAX_INPUT );
+        return 1;
+    }
+
+    static gdc_settings_t settings;
+    settings.base_gdc = 0;
+    settings.gdc_config.config_addr = 0x1000;
+    settings.gdc_config.config_size = 0x100;
+    settings.gdc_config.input_width = 1920;
+    settings.gdc_config.input_height = 1080;
+    settings.gdc_config.output_width = 1920;
+    settings.gdc_config.output_height = 1080;
+    settings.gdc_config.total_planes = planes;
+    if ( init_gdc_io( 0, HOST_GDC_IO_SIZE ) != 0 || acamera_gdc_init( &settings ) != 0 ) {
+        printf( "cannot set up the simulated gdc\n" );
+        return 1;
+    }
+
+    printf( "frame setup with %u planes, driver built with %s writes\n", planes, GDC_RELAXED_MMIO ? "relaxed" : "ordered" );
+    printf( "%-8s %12s %10s %8s %8s\n", "mode", BENCH_COUNTER, "ns", "writes", "fences" );
+    //second round runs warm
+    for ( round = 0; round < 2; round++ ) {
+        if ( round )
+            printf( "\n" );
+        bench_mode( &settings, frames, 0 );
+        bench_mode( &settings, frames, 1 );
+    }
+
+    acamera_gdc_deinit( &settings );
+    close_gdc_io();
+    return 0;
+}
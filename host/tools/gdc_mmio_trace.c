@@ -0,0 +1,318 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//summarizes a register access trace per frame and per function and replays it on the simulated register file
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "acamera_driver_config.h"
+#include "acamera_gdc_config.h"
+#include "system_log.h"
+#include "system_host_sim.h"
+#include "system_gdc_trace.h"
+
+#define TRACE_MAX_FUNCTIONS 256
+#define TRACE_NAME_SIZE 96
+#define TRACE_OPS "RSWwB"
+#define TRACE_NUM_OPS 5
+
+typedef struct trace_access {
+    u64 time;
+    uint32_t duration;
+    uint32_t addr;
+    uint32_t data;
+    char op;
+    uint16_t function;
+} trace_access_t;
+
+typedef struct trace_function {
+    char name[TRACE_NAME_SIZE];
+    u64 count[TRACE_NUM_OPS];
+    u64 ns;
+} trace_function_t;
+
+static trace_function_t functions[TRACE_MAX_FUNCTIONS];
+static uint32_t num_functions;
+
+extern int32_t init_gdc_io( resource_size_t addr, resource_size_t size );
+extern void close_gdc_io( void );
+
+static void usage( const char *name )
+{
+    printf( "usage: %s [-e executable] [-r] trace\n", name );
+    printf( "  -e  resolve host callers with addr2line on this executable (default from the trace header)\n" );
+    printf( "  -r  replay the writes on the simulated register file and compare the reads\n" );
+    printf( "traces come from <debugfs>/gdc/mmio_trace or gdc_host -r, built with GDC_MMIO_TRACE=1\n" );
+}
+
+static int op_index( char op )
+{
+    const char *p = strchr( TRACE_OPS, op );
+    return op && p ? (int)( p - TRACE_OPS ) : -1;
+}
+
+//kernel callers look like func+0x1c/0x80 [gdc], host callers are offsets resolved later
+static uint16_t function_index( const char *caller )
+{
+    char name[TRACE_NAME_SIZE];
+    uint32_t i;
+
+    snprintf( name, sizeof( name ), "%s", caller );
+    name[strcspn( name, "+ \n" )] = '\0';
+    for ( i = 0; i < num_functions; i++ ) {
+        if ( strcmp( functions[i].name, name ) == 0 )
+            return i;
+    }
+    if ( num_functions == TRACE_MAX_FUNCTIONS )
+        return TRACE_MAX_FUNCTIONS - 1;
+    snprintf( functions[num_functions].name, TRACE_NAME_SIZE, "%s", name );
+    return num_functions++;
+}
+
+//replaces the host offsets by the outermost function of their inline chain
+static void resolve_functions( const char *module )
+{
+    char cmd[512], line[TRACE_NAME_SIZE], name[TRACE_NAME_SIZE];
+    uint32_t i, n;
+
+    for ( i = 0; i < num_functions; i++ ) {
+        if ( strncmp( functions[i].name, "0x", 2 ) != 0 )
+            continue;
+        //return addresses point behind the call, look up the call itself
+        snprintf( cmd, sizeof( cmd ), "addr2line -f -i -e '%s' 0x%lx 2>/dev/null", module,
+                  strtoul( functions[i].name, NULL, 16 ) - 1 );
+        FILE *p = popen( cmd, "r" );
+        if ( p == NULL )
+            return;
+        name[0] = '\0';
+        //function and location lines alternate, innermost first
+        for ( n = 0; fgets( line, sizeof( line ), p ); n++ ) {
+            if ( n % 2 == 0 && line[0] != '?' ) {
+                line[strcspn( line, "\n" )] = '\0';
+                snprintf( name, sizeof( name ), "%s", line );
+            }
+        }
+        if ( name[0] )
+            snprintf( functions[i].name, TRACE_NAME_SIZE, "%s", name );
+        pclose( p );
+    }
+}
+
+//offsets resolved to the same function share its entry, returns the entry of each function
+static void merge_functions( uint16_t *alias )
+{
+    uint32_t i, j;
+    for ( i = 0; i < num_functions; i++ ) {
+        alias[i] = i;
+        for ( j = 0; j < i; j++ ) {
+            if ( strcmp( functions[i].name, functions[j].name ) == 0 ) {
+                alias[i] = j;
+                break;
+            }
+        }
+    }
+}
+
+static trace_access_t *load( const char *path, uint32_t *count, char *module, uint32_t module_size )
+{
+    char line[256], op, caller[TRACE_NAME_SIZE];
+    unsigned long long time;
+    uint32_t duration, addr, data, size = 0;
+    trace_access_t *accesses = NULL;
+    FILE *f = fopen( path, "r" );
+
+    *count = 0;
+    if ( f == NULL ) {
+        printf( "cannot open %s\n", path );
+        return NULL;
+    }
+    while ( fgets( line, sizeof( line ), f ) ) {
+        if ( line[0] == '#' ) {
+            const char *m = strstr( line, "module " );
+            if ( m && module[0] == '\0' ) {
+                snprintf( module, module_size, "%s", m + 7 );
+                module[strcspn( module, "\n" )] = '\0';
+            }
+            continue;
+        }
+        if ( sscanf( line, "%llu %u %c %x %x %95[^\n]", &time, &duration, &op, &addr, &data, caller ) != 6 || op_index( op ) < 0 )
+            continue;
+        if ( *count == size ) {
+            size = size ? size * 2 : 4096;
+            trace_access_t *grown = realloc( accesses, size * sizeof( trace_access_t ) );
+            if ( grown == NULL )
+                break;
+            accesses = grown;
+        }
+        trace_access_t *a = &accesses[( *count )++];
+        a->time = time;
+        a->duration = duration;
+        a->op = op;
+        a->addr = addr;
+        a->data = data;
+        a->function = function_index( caller );
+    }
+    fclose( f );
+    return accesses;
+}
+
+//a 0->1 write of the start flag of a core starts a frame
+static int is_frame_start( const trace_access_t *a, uint32_t *last_control )
+{
+    uint32_t core = a->addr / GDC_CORE_BASE_STRIDE;
+    int start = 0;
+
+    if ( ( a->op != 'W' && a->op != 'w' ) || a->addr % GDC_CORE_BASE_STRIDE != ACAMERA_GDC_GDC_START_FLAG_OFFSET || core >= GDC_NUM_CORES )
+        return 0;
+    start = !( last_control[core] & ACAMERA_GDC_GDC_START_FLAG_MASK ) && ( a->data & ACAMERA_GDC_GDC_START_FLAG_MASK );
+    last_control[core] = a->data;
+    return start;
+}
+
+static void summarize( const trace_access_t *accesses, uint32_t count )
+{
+    static uint16_t alias[TRACE_MAX_FUNCTIONS];
+    uint32_t last_control[GDC_NUM_CORES] = {0};
+    u64 totals[TRACE_NUM_OPS] = {0}, ns = 0;
+    uint32_t frames = 0, i, j;
+
+    merge_functions( alias );
+    for ( i = 0; i < count; i++ ) {
+        const trace_access_t *a = &accesses[i];
+        int op = op_index( a->op );
+        functions[alias[a->function]].count[op]++;
+        functions[alias[a->function]].ns += a->duration;
+        totals[op]++;
+        ns += a->duration;
+        frames += is_frame_start( a, last_control );
+    }
+
+    printf( "accesses:  %u over %.3f ms, %.3f ms in the io layer\n", count,
+            count ? ( accesses[count - 1].time - accesses[0].time ) / 1e6 : 0.0, ns / 1e6 );
+    printf( "frames:    %u\n", frames );
+    if ( frames ) {
+        printf( "per frame:" );
+        for ( j = 0; j < TRACE_NUM_OPS; j++ )
+            printf( " %c %.1f", TRACE_OPS[j], (double)totals[j] / frames );
+        printf( ", %.0f ns\n", (double)ns / frames );
+    }
+    printf( "\n%-40s", "function" );
+    for ( j = 0; j < TRACE_NUM_OPS; j++ )
+        printf( " %8c", TRACE_OPS[j] );
+    printf( " %12s %8s\n", "ns", "ns/op" );
+    for ( i = 0; i < num_functions; i++ ) {
+        u64 n = 0;
+        if ( alias[i] != i )
+            continue;
+        printf( "%-40s", functions[i].name );
+        for ( j = 0; j < TRACE_NUM_OPS; j++ ) {
+            printf( " %8llu", (unsigned long long)functions[i].count[j] );
+            n += functions[i].count[j];
+        }
+        printf( " %12llu %8.1f\n", (unsigned long long)functions[i].ns, n ? (double)functions[i].ns / n : 0.0 );
+    }
+}
+
+static int replay( const trace_access_t *accesses, uint32_t count )
+{
+    system_gdc_sim_counters_t counters;
+    uint32_t mismatches = 0, skipped = 0, i;
+
+    if ( init_gdc_io( 0, HOST_GDC_IO_SIZE ) != 0 ) {
+        printf( "cannot create the simulated register file\n" );
+        return -1;
+    }
+    u64 t0 = system_host_time_ns();
+    for ( i = 0; i < count; i++ ) {
+        const trace_access_t *a = &accesses[i];
+        uint32_t value;
+        switch ( a->op ) {
+        case 'R':
+            //the trace tells when the block finished, the simulated core follows it
+            if ( a->addr % GDC_CORE_BASE_STRIDE == ACAMERA_GDC_GDC_STATUS_OFFSET && !( a->data & ACAMERA_GDC_GDC_BUSY_MASK ) )
+                system_gdc_sim_complete( a->addr / GDC_CORE_BASE_STRIDE );
+            value = system_gdc_read_32( a->addr );
+            if ( value != a->data && mismatches++ < 10 )
+                printf( "read %u of 0x%06x by %s: 0x%08x, trace 0x%08x\n", i, a->addr, functions[a->function].name, value, a->data );
+            break;
+        case 'W':
+            system_gdc_write_32( a->addr, a->data );
+            break;
+        case 'w':
+            system_gdc_write_32_relaxed( a->addr, a->data );
+            break;
+        case 'B':
+            system_gdc_write_barrier();
+            break;
+        default:
+            //served by the shadow copy, never reached the block
+            skipped++;
+            break;
+        }
+    }
+    u64 ns = system_host_time_ns() - t0;
+    system_gdc_sim_get_counters( &counters );
+    close_gdc_io();
+
+    printf( "\nreplay:    %u accesses in %.3f ms, %u shadow reads skipped\n", count - skipped, ns / 1e6, skipped );
+    printf( "simulated: %llu reads, %llu writes, %llu fences, %llu frames started\n", (unsigned long long)counters.reads,
+            (unsigned long long)counters.writes, (unsigned long long)counters.barriers, (unsigned long long)counters.frames );
+    printf( "reads differing from the trace: %u\n", mismatches );
+    return 0;
+}
+
+int main( int argc, char **argv )
+{
+    char module[256] = "";
+    int opt, do_replay = 0;
+
+    while ( ( opt = getopt( argc, argv, "e:rh" ) ) != -1 ) {
+        switch ( opt ) {
+        case 'e':
+            snprintf( module, sizeof( module ), "%s", optarg );
+            break;
+        case 'r':
+            do_replay = 1;
+            break;
+        default:
+            usage( argv[0] );
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if ( optind != argc - 1 ) {
+        usage( argv[0] );
+        return 1;
+    }
+
+    uint32_t count;
+    trace_access_t *accesses = load( argv[optind], &count, module, sizeof( module ) );
+    if ( accesses == NULL ) {
+        printf( "no accesses in %s\n", argv[optind] );
+        return 1;
+    }
+    if ( module[0] && strcmp( module, "?" ) != 0 )
+        resolve_functions( module );
+
+    summarize( accesses, count );
+    int rc = do_replay ? replay( accesses, count ) : 0;
+    free( accesses );
+    return rc ? 1 : 0;
+}
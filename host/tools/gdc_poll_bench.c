@@ -0,0 +1,174 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//completion latency of single frames, interrupt path against polling the busy bit
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+
+#include "acamera_driver_config.h"
+#include "system_log.h"
+#include "system_interrupts.h"
+#include "system_host_sim.h"
+#include "acamera_gdc_api.h"
+
+extern int32_t init_gdc_io( resource_size_t addr, resource_size_t size );
+extern void close_gdc_io( void );
+
+//frames run before the measured ones, they settle the prediction of the polling mode
+#define BENCH_WARMUP_FRAMES 16
+
+static gdc_settings_t settings;
+static volatile u64 done_ns;
+
+static void bench_job_done( void *ctx, const gdc_job_t *job )
+{
+    done_ns = system_host_time_ns();
+}
+
+static void bench_irq( void *param, uint32_t mask )
+{
+    acamera_gdc_latch_frame( (gdc_settings_t *)param );
+}
+
+static void bench_irq_thread( void *param, uint32_t mask )
+{
+    acamera_gdc_complete_frames( (gdc_settings_t *)param );
+}
+
+static int compare_u64( const void *a, const void *b )
+{
+    u64 x = *(const u64 *)a, y = *(const u64 *)b;
+    return x < y ? -1 : x > y;
+}
+
+//runs frames one at a time and records the time from submit to the job_done callback
+static int bench_mode( uint32_t frames, int poll, u64 *latency )
+{
+    uint32_t in_addr[ACAMERA_GDC_MAX_INPUT] = {0x100000, 0x200000, 0x300000};
+    uint32_t i;
+
+    acamera_gdc_set_polling( &settings, poll, 0 );
+    settings.poll.polled = 0;
+    settings.poll.fallbacks = 0;
+    for ( i = 0; i < BENCH_WARMUP_FRAMES + frames; i++ ) {
+        done_ns = 0;
+        u64 t0 = system_host_time_ns();
+        if ( acamera_gdc_process( &settings, settings.gdc_config.total_planes, in_addr ) != 0 ) {
+            return -1;
+        }
+        //the interrupt completes whatever the poll leaves over
+        if ( !poll || acamera_gdc_poll_frame( &settings ) != 0 ) {
+            while ( done_ns == 0 ) {
+                if ( system_interrupts_sim_next_deadline() == 0 ) {
+                    printf( "frame %u lost its interrupt\n", i );
+                    return -1;
+                }
+                system_interrupts_sim_dispatch( 1 );
+            }
+        }
+        if ( i >= BENCH_WARMUP_FRAMES ) {
+            latency[i - BENCH_WARMUP_FRAMES] = done_ns - t0;
+        }
+    }
+    //drop the interrupts of polled frames
+    while ( system_interrupts_sim_next_deadline() != 0 ) {
+        system_interrupts_sim_dispatch( 1 );
+    }
+    return 0;
+}
+
+static void bench_report( const char *mode, u64 *latency, uint32_t frames, uint32_t polled )
+{
+    qsort( latency, frames, sizeof( latency[0] ), compare_u64 );
+    printf( "%-8s %10.1f %10.1f %10.1f %10.1f %8u\n", mode, latency[0] / 1e3, latency[frames / 2] / 1e3,
+            latency[frames - 1 - frames / 100] / 1e3, latency[frames - 1] / 1e3, polled );
+}
+
+int main( int argc, char **argv )
+{
+    uint32_t frames = 2000, frame_us = 100;
+    int opt;
+
+    while ( ( opt = getopt( argc, argv, "n:t:h" ) ) != -1 ) {
+        switch ( opt ) {
+        case 'n':
+            frames = strtoul( optarg, NULL, 0 );
+            break;
+        case 't':
+            frame_us = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "usage: %s [-n frames] [-t frame_time_us]\n", argv[0] );
+            printf( "  -n  frames per mode (default 2000)\n" );
+            printf( "  -t  simulated gdc processing time per frame in us (default 100)\n" );
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if ( frames == 0 ) {
+        printf( "frames must be positive\n" );
+        return 1;
+    }
+    //a latency bound thread does not let its sleeps be merged, like usleep_range with a small range
+    prctl( PR_SET_TIMERSLACK, 1UL );
+    u64 *latency = calloc( frames, sizeof( *latency ) );
+    if ( latency == NULL ) {
+        return 1;
+    }
+
+    settings.base_gdc = 0;
+    settings.gdc_config.config_addr = 0x1000;
+    settings.gdc_config.config_size = 0x100;
+    settings.gdc_config.input_width = 1920;
+    settings.gdc_config.input_height = 1080;
+    settings.gdc_config.output_width = 1920;
+    settings.gdc_config.output_height = 1080;
+    settings.gdc_config.total_planes = 2;
+    settings.outbuffers[0] = 0x400000;
+    settings.outbuffers[1] = 0x600000;
+    if ( init_gdc_io( 0, HOST_GDC_IO_SIZE ) != 0 || acamera_gdc_init( &settings ) != 0 ) {
+        printf( "cannot set up the simulated gdc\n" );
+        free( latency );
+        return 1;
+    }
+    settings.job_done = bench_job_done;
+    system_gdc_sim_set_frame_time( 0, (u64)frame_us * 1000 );
+    system_interrupts_set_irq( 0, 1, 0 );
+    system_interrupts_init( 0 );
+    system_interrupt_set_handler( 0, bench_irq, &settings );
+    system_interrupt_set_thread_handler( 0, bench_irq_thread, &settings );
+    system_interrupts_enable( 0 );
+
+    printf( "completion latency of %u frames of %u us, in us\n", frames, frame_us );
+    printf( "%-8s %10s %10s %10s %10s %8s\n", "mode", "min", "p50", "p99", "max", "polled" );
+    if ( bench_mode( frames, 0, latency ) == 0 ) {
+        bench_report( "irq", latency, frames, 0 );
+    }
+    if ( bench_mode( frames, 1, latency ) == 0 ) {
+        bench_report( "poll", latency, frames, settings.poll.polled );
+    }
+    printf( "predicted job time %.1f us, %u waits left to the interrupt\n", settings.poll.job_ns / 1e3, settings.poll.fallbacks );
+
+    system_interrupts_deinit( 0 );
+    acamera_gdc_deinit( &settings );
+    close_gdc_io();
+    free( latency );
+    return 0;
+}
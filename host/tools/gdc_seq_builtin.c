@@ -0,0 +1,56 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdc_seq_builtin.h"
+
+//gdc configuration sequences
+#include "gdc_config_seq_semiplanar_yuv420.h"
+#include "gdc_config_seq_plane_y.h"
+#include "gdc_config_seq_planar_yuv420.h"
+#include "gdc_config_seq_planar_rgb444.h"
+
+const gdc_seq_builtin_t gdc_seq_builtin[] = {
+    {"semiplanar_yuv420", semiplanar_yuv420_1920x1080_seq, sizeof( semiplanar_yuv420_1920x1080_seq ), 1920, 1080, 2, 0, 1},
+    {"y_plane", y_plane_1920x1080_seq, sizeof( y_plane_1920x1080_seq ), 1920, 1080, 1, 0, 0},
+    {"planar_yuv420", planar_yuv420_1920x1080_seq, sizeof( planar_yuv420_1920x1080_seq ), 1920, 1080, 3, 1, 1},
+    {"planar_rgb444", planar_rgb444_1920x1080_seq, sizeof( planar_rgb444_1920x1080_seq ), 1920, 1080, 3, 0, 0},
+};
+
+const uint32_t gdc_seq_builtin_count = sizeof( gdc_seq_builtin ) / sizeof( gdc_seq_builtin[0] );
+
+const gdc_seq_builtin_t *gdc_seq_builtin_find( const char *name )
+{
+    uint32_t i;
+    for ( i = 0; i < gdc_seq_builtin_count; i++ ) {
+        if ( strcmp( gdc_seq_builtin[i].name, name ) == 0 )
+            return &gdc_seq_builtin[i];
+    }
+    return NULL;
+}
+
+uint32_t *gdc_seq_builtin_copy( const gdc_seq_builtin_t *seq )
+{
+    uint32_t *words = malloc( seq->size );
+    if ( words )
+        memcpy( words, seq->data, seq->size );
+    return words;
+}
@@ -0,0 +1,54 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __GDC_SEQ_BUILTIN_H__
+#define __GDC_SEQ_BUILTIN_H__
+
+#include "system_stdlib.h"
+
+// configuration sequences shipped in app/gdc_config_seq_*.h
+typedef struct gdc_seq_builtin {
+    const char *name;
+    const unsigned char *data;
+    uint32_t size;
+    uint32_t width;
+    uint32_t height;
+    uint32_t total_planes;
+    uint8_t div_width;
+    uint8_t div_height;
+} gdc_seq_builtin_t;
+
+extern const gdc_seq_builtin_t gdc_seq_builtin[];
+extern const uint32_t gdc_seq_builtin_count;
+
+/**
+ *   Find a shipped sequence by name
+ *
+ *   @return the sequence, NULL if there is none with this name
+ */
+const gdc_seq_builtin_t *gdc_seq_builtin_find( const char *name );
+
+/**
+ *   Copy a sequence into a 32 bit aligned buffer, release it with free()
+ *
+ *   @return the copy, NULL on allocation failure
+ */
+uint32_t *gdc_seq_builtin_copy( const gdc_seq_builtin_t *seq );
+
+#endif
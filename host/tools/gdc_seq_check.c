@@ -0,0 +1,199 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//decodes a configuration sequence and checks it against a frame layout and the block capabilities
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "system_log.h"
+#include "acamera_gdc_seq.h"
+#include "gdc_seq_builtin.h"
+
+//capabilities of the reference block, log2 as in the capability register
+#define CHECK_TILE_CACHE_LOG2 8
+#define CHECK_FILTER_BANKS_LOG2 3
+
+static void usage( const char *name )
+{
+    uint32_t i;
+    printf( "usage: %s [-s sequence | -f file] [options]\n", name );
+    printf( "  -s  shipped sequence:" );
+    for ( i = 0; i < gdc_seq_builtin_count; i++ )
+        printf( " %s", gdc_seq_builtin[i].name );
+    printf( "\n  -f  sequence file with little endian 32 bit words\n" );
+    printf( "  -i  input resolution WxH (default 1920x1080)\n" );
+    printf( "  -o  output resolution WxH (default 1920x1080)\n" );
+    printf( "  -p  total planes (default from the shipped sequence or 1)\n" );
+    printf( "  -x  div_width shift of planes 1 and 2\n" );
+    printf( "  -y  div_height shift of planes 1 and 2\n" );
+    printf( "  -c  log2 tile cache size in 16x16 clusters (default %d)\n", CHECK_TILE_CACHE_LOG2 );
+    printf( "  -k  log2 number of filter banks (default %d)\n", CHECK_FILTER_BANKS_LOG2 );
+    printf( "  -v  print filter banks and tiles, twice for the taps\n" );
+}
+
+static int parse_size( const char *arg, uint32_t *w, uint32_t *h )
+{
+    char *end;
+    *w = strtoul( arg, &end, 0 );
+    if ( *end != 'x' )
+        return -1;
+    *h = strtoul( end + 1, &end, 0 );
+    return *end == '\0' && *w && *h ? 0 : -1;
+}
+
+static uint32_t *read_file( const char *path, uint32_t *size )
+{
+    uint32_t *words = NULL;
+    long len;
+    FILE *f = fopen( path, "rb" );
+    if ( f == NULL ) {
+        printf( "cannot open %s\n", path );
+        return NULL;
+    }
+    if ( fseek( f, 0, SEEK_END ) == 0 && ( len = ftell( f ) ) > 0 && fseek( f, 0, SEEK_SET ) == 0 ) {
+        words = malloc( len );
+        if ( words && fread( words, 1, len, f ) != (size_t)len ) {
+            free( words );
+            words = NULL;
+        }
+        *size = len;
+    }
+    fclose( f );
+    if ( words == NULL )
+        printf( "cannot read %s\n", path );
+    return words;
+}
+
+static void print_sequence( const gdc_seq_t *seq, int verbose )
+{
+    uint32_t i, t, p;
+
+    printf( "words %u, filter banks %u, mesh %u words at %u, tile lists %u\n", seq->num_words, seq->num_banks, seq->mesh_words,
+            seq->mesh_offset, seq->num_tile_lists );
+    for ( i = 0; i < seq->num_banks; i++ ) {
+        const gdc_seq_bank_t *bank = &seq->banks[i];
+        printf( "bank %u\n", bank->index );
+        for ( p = 0; verbose > 1 && p < ACAMERA_GDC_SEQ_PHASES; p++ )
+            printf( "  phase %2u: %4d %4d %4d %4d\n", p, bank->taps[p][0], bank->taps[p][1], bank->taps[p][2], bank->taps[p][3] );
+    }
+    for ( i = 0; i < seq->num_tile_lists; i++ ) {
+        const gdc_seq_tile_list_t *list = &seq->tile_lists[i];
+        printf( "tile list %u at word %u, %u tiles, preamble", i, list->offset, list->num_tiles );
+        for ( p = 0; p < list->num_preamble; p++ )
+            printf( " %08X", list->preamble[p] );
+        printf( "\n" );
+        if ( verbose == 0 )
+            continue;
+        printf( "  tile ch fl hb vb            output             input\n" );
+        for ( t = 0; t < list->num_tiles; t++ ) {
+            gdc_seq_tile_t tile;
+            acamera_gdc_seq_tile_decode( list, t, &tile );
+            printf( "  %4u %2X %2X %2u %2u %4ux%-4u+%4u+%-4u %4ux%-4u+%4u+%-4u\n", t, tile.channel_mask, tile.flags, tile.hbank, tile.vbank,
+                    tile.out_width, tile.out_height, tile.out_x, tile.out_y, tile.in_width, tile.in_height, tile.in_x, tile.in_y );
+        }
+    }
+}
+
+int main( int argc, char **argv )
+{
+    const gdc_seq_builtin_t *builtin = NULL;
+    const char *path = NULL;
+    gdc_seq_limits_t limits;
+    uint32_t cache_log2 = CHECK_TILE_CACHE_LOG2, banks_log2 = CHECK_FILTER_BANKS_LOG2;
+    int planes = -1, div_w = -1, div_h = -1, verbose = 0, opt;
+
+    system_memset( &limits, 0, sizeof( limits ) );
+    limits.input_width = limits.output_width = 1920;
+    limits.input_height = limits.output_height = 1080;
+
+    while ( ( opt = getopt( argc, argv, "s:f:i:o:p:x:y:c:k:vh" ) ) != -1 ) {
+        switch ( opt ) {
+        case 's':
+            builtin = gdc_seq_builtin_find( optarg );
+            if ( builtin == NULL ) {
+                usage( argv[0] );
+                return 1;
+            }
+            break;
+        case 'f':
+            path = optarg;
+            break;
+        case 'i':
+        case 'o':
+            if ( parse_size( optarg, opt == 'i' ? &limits.input_width : &limits.output_width, opt == 'i' ? &limits.input_height : &limits.output_height ) != 0 ) {
+                usage( argv[0] );
+                return 1;
+            }
+            break;
+        case 'p':
+            planes = strtol( optarg, NULL, 0 );
+            break;
+        case 'x':
+            div_w = strtol( optarg, NULL, 0 );
+            break;
+        case 'y':
+            div_h = strtol( optarg, NULL, 0 );
+            break;
+        case 'c':
+            cache_log2 = strtoul( optarg, NULL, 0 );
+            break;
+        case 'k':
+            banks_log2 = strtoul( optarg, NULL, 0 );
+            break;
+        case 'v':
+            verbose++;
+            break;
+        default:
+            usage( argv[0] );
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if ( ( builtin == NULL ) == ( path == NULL ) || cache_log2 > 31 || banks_log2 > 7 ) {
+        usage( argv[0] );
+        return 1;
+    }
+
+    limits.total_planes = planes >= 0 ? planes : ( builtin ? builtin->total_planes : 1 );
+    limits.div_width = div_w >= 0 ? div_w : ( builtin ? builtin->div_width : 0 );
+    limits.div_height = div_h >= 0 ? div_h : ( builtin ? builtin->div_height : 0 );
+    limits.tile_cache_clusters = 1u << cache_log2;
+    limits.num_filter_banks = 1u << banks_log2;
+
+    uint32_t size = 0;
+    uint32_t *words = builtin ? gdc_seq_builtin_copy( builtin ) : read_file( path, &size );
+    if ( words == NULL )
+        return 1;
+    if ( builtin )
+        size = builtin->size;
+
+    gdc_seq_t seq;
+    int rc = acamera_gdc_seq_parse( words, size, &seq );
+    if ( rc == 0 ) {
+        print_sequence( &seq, verbose );
+        rc = acamera_gdc_seq_validate( &seq, &limits );
+    }
+    printf( "%s: %s for %ux%u -> %ux%u, %u planes, div %u/%u, tile cache %u clusters, %u filter banks\n", builtin ? builtin->name : path,
+            rc == 0 ? "valid" : "INVALID", limits.input_width, limits.input_height, limits.output_width, limits.output_height,
+            limits.total_planes, limits.div_width, limits.div_height, limits.tile_cache_clusters, limits.num_filter_banks );
+
+    free( words );
+    return rc == 0 ? 0 : 1;
+}
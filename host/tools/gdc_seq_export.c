@@ -0,0 +1,62 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//writes the shipped configuration sequences as firmware files loaded by the driver
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "system_log.h"
+#include "acamera_gdc_seq.h"
+#include "gdc_seq_builtin.h"
+
+int main( int argc, char **argv )
+{
+    char dir[512], path[512], name[ACAMERA_GDC_SEQ_NAME_SIZE];
+    uint32_t i;
+
+    if ( argc != 2 ) {
+        printf( "usage: %s output_dir\n", argv[0] );
+        printf( "  writes output_dir/%s/<format>_<width>x<height>.bin, install to /lib/firmware\n", ACAMERA_GDC_SEQ_FIRMWARE_DIR );
+        return 1;
+    }
+    snprintf( dir, sizeof( dir ), "%s/%s", argv[1], ACAMERA_GDC_SEQ_FIRMWARE_DIR );
+    mkdir( argv[1], 0755 );
+    mkdir( dir, 0755 );
+
+    for ( i = 0; i < gdc_seq_builtin_count; i++ ) {
+        const gdc_seq_builtin_t *seq = &gdc_seq_builtin[i];
+        FILE *f;
+
+        if ( acamera_gdc_seq_firmware_name( name, sizeof( name ), seq->name, seq->width, seq->height ) != 0 )
+            return 1;
+        snprintf( path, sizeof( path ), "%s/%s", argv[1], name );
+        f = fopen( path, "wb" );
+        if ( f == NULL || fwrite( seq->data, 1, seq->size, f ) != seq->size ) {
+            printf( "cannot write %s\n", path );
+            if ( f )
+                fclose( f );
+            return 1;
+        }
+        fclose( f );
+        printf( "%s: %u bytes\n", path, seq->size );
+    }
+    return 0;
+}
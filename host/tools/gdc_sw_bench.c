@@ -0,0 +1,157 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//measures the interpolation kernels of every instruction set on the 1920x1080 y plane sequence
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "system_log.h"
+#include "system_host_sim.h"
+#include "acamera_gdc_sw.h"
+#include "gdc_seq_builtin.h"
+
+static const char *const bench_isa[] = {"scalar", "sse4", "avx2", "neon"};
+
+static void usage( const char *name )
+{
+    printf( "usage: %s [-s sequence] [-j threads] [-n frames]\n", name );
+    printf( "  -s  sequence name (default y_plane)\n" );
+    printf( "  -j  worker threads, 0 for one per cpu (default 1)\n" );
+    printf( "  -n  frames per measurement (default 20)\n" );
+}
+
+static void bench_pattern( acamera_gdc_sw_frame_t *frame )
+{
+    uint32_t i, x, seed = 1;
+    for ( i = 0; i < frame->num_planes; i++ ) {
+        acamera_gdc_sw_plane_t *p = &frame->planes[i];
+        uint8_t *data = p->data;
+        for ( x = 0; x < p->height * p->stride; x++ ) {
+            seed = seed * 1103515245 + 12345;
+            data[x] = seed >> 16;
+        }
+        //keep 10 bit samples in range
+        if ( frame->bit_depth > 8 ) {
+            uint16_t *s = p->data;
+            for ( x = 0; x < p->height * p->stride / 2; x++ )
+                s[x] &= ( 1 << frame->bit_depth ) - 1;
+        }
+    }
+}
+
+static int bench_equal( const acamera_gdc_sw_frame_t *a, const acamera_gdc_sw_frame_t *b )
+{
+    uint32_t i, y;
+    for ( i = 0; i < a->num_planes; i++ ) {
+        const acamera_gdc_sw_plane_t *p = &a->planes[i];
+        uint32_t line = p->width * p->channels * ( a->bit_depth > 8 ? 2 : 1 );
+        for ( y = 0; y < p->height; y++ ) {
+            if ( memcmp( (uint8_t *)p->data + y * p->stride, (uint8_t *)b->planes[i].data + y * p->stride, line ) != 0 )
+                return 0;
+        }
+    }
+    return 1;
+}
+
+int main( int argc, char **argv )
+{
+    const char *name = "y_plane";
+    uint32_t threads = 1, frames = 20, bits, i, f;
+    int opt, rc = 0;
+
+    while ( ( opt = getopt( argc, argv, "s:j:n:h" ) ) != -1 ) {
+        switch ( opt ) {
+        case 's':
+            name = optarg;
+            break;
+        case 'j':
+            threads = strtoul( optarg, NULL, 0 );
+            break;
+        case 'n':
+            frames = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            usage( argv[0] );
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    const gdc_seq_builtin_t *builtin = gdc_seq_builtin_find( name );
+    if ( builtin == NULL || frames == 0 ) {
+        usage( argv[0] );
+        return 1;
+    }
+    uint32_t *words = gdc_seq_builtin_copy( builtin );
+    gdc_seq_t seq;
+    if ( words == NULL || acamera_gdc_seq_parse( words, builtin->size, &seq ) != 0 ) {
+        printf( "cannot parse sequence %s\n", name );
+        free( words );
+        return 1;
+    }
+
+    printf( "sequence %s %ux%u, %u thread(s), %u frames\n", name, builtin->width, builtin->height, threads, frames );
+    printf( "%-8s %5s %12s %10s %8s\n", "isa", "bits", "Mpixel/s", "speedup", "exact" );
+
+    for ( bits = 8; bits <= 10; bits += 2 ) {
+        acamera_gdc_sw_frame_t in, ref, out;
+        double scalar_rate = 0;
+        if ( acamera_gdc_sw_frame_alloc( &in, builtin->total_planes, builtin->width, builtin->height, builtin->div_width, builtin->div_height, bits ) ||
+             acamera_gdc_sw_frame_alloc( &ref, builtin->total_planes, builtin->width, builtin->height, builtin->div_width, builtin->div_height, bits ) ||
+             acamera_gdc_sw_frame_alloc( &out, builtin->total_planes, builtin->width, builtin->height, builtin->div_width, builtin->div_height, bits ) ) {
+            printf( "cannot allocate frames\n" );
+            free( words );
+            return 1;
+        }
+        bench_pattern( &in );
+
+        for ( i = 0; i < sizeof( bench_isa ) / sizeof( bench_isa[0] ); i++ ) {
+            acamera_gdc_sw_frame_t *dst = i == 0 ? &ref : &out;
+            if ( acamera_gdc_sw_set_isa( bench_isa[i] ) != 0 ) {
+                printf( "%-8s %5u %12s\n", bench_isa[i], bits, "n/a" );
+                continue;
+            }
+            //warm up caches and thread start
+            if ( acamera_gdc_sw_process( &seq, &in, dst, threads ) != 0 ) {
+                rc = 1;
+                break;
+            }
+            u64 t0 = system_host_time_ns();
+            for ( f = 0; f < frames; f++ )
+                acamera_gdc_sw_process( &seq, &in, dst, threads );
+            u64 ns = system_host_time_ns() - t0;
+
+            double rate = (double)builtin->width * builtin->height * frames * 1e3 / ns;
+            int exact = i == 0 || bench_equal( &ref, &out );
+            if ( i == 0 )
+                scalar_rate = rate;
+            printf( "%-8s %5u %12.1f %9.2fx %8s\n", bench_isa[i], bits, rate, rate / scalar_rate, exact ? "yes" : "NO" );
+            if ( !exact )
+                rc = 1;
+        }
+
+        acamera_gdc_sw_frame_free( &in );
+        acamera_gdc_sw_frame_free( &ref );
+        acamera_gdc_sw_frame_free( &out );
+    }
+
+    free( words );
+    return rc;
+}
@@ -0,0 +1,187 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//runs the tile lists of a configuration sequence in software and reports the throughput,
+//the mesh is not evaluated so the output only approximates the gdc
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "system_log.h"
+#include "system_host_sim.h"
+#include "acamera_gdc_sw.h"
+#include "gdc_seq_builtin.h"
+
+static void usage( const char *name )
+{
+    uint32_t i;
+    printf( "usage: %s [-s sequence] [-a isa] [-b bits] [-j threads] [-n frames] [-i in.raw] [-o out.raw]\n", name );
+    printf( "  -s  sequence name (default y_plane):" );
+    for ( i = 0; i < gdc_seq_builtin_count; i++ )
+        printf( " %s", gdc_seq_builtin[i].name );
+    printf( "\n  -a  kernels: auto, scalar, sse4, avx2 or neon (default auto)\n" );
+    printf( "  -b  bit depth 8 or 10 (default 8)\n" );
+    printf( "  -j  worker threads, 0 for one per cpu (default 0)\n" );
+    printf( "  -n  frames to process (default 10)\n" );
+    printf( "  -i  raw input planes, a test pattern is used otherwise\n" );
+    printf( "  -o  write the last output frame as raw planes\n" );
+}
+
+static int frame_io( acamera_gdc_sw_frame_t *frame, const char *path, int write )
+{
+    uint32_t i, y;
+    FILE *f = fopen( path, write ? "wb" : "rb" );
+    if ( f == NULL ) {
+        printf( "cannot open %s\n", path );
+        return -1;
+    }
+    for ( i = 0; i < frame->num_planes; i++ ) {
+        acamera_gdc_sw_plane_t *p = &frame->planes[i];
+        uint32_t line = p->width * p->channels * ( frame->bit_depth > 8 ? 2 : 1 );
+        for ( y = 0; y < p->height; y++ ) {
+            uint8_t *data = (uint8_t *)p->data + y * p->stride;
+            size_t done = write ? fwrite( data, 1, line, f ) : fread( data, 1, line, f );
+            if ( done != line ) {
+                printf( "short %s on %s\n", write ? "write" : "read", path );
+                fclose( f );
+                return -1;
+            }
+        }
+    }
+    fclose( f );
+    return 0;
+}
+
+//checkerboard with a gradient so the warp is visible
+static void frame_pattern( acamera_gdc_sw_frame_t *frame )
+{
+    uint32_t i, x, y;
+    uint32_t max = ( 1 << frame->bit_depth ) - 1;
+    for ( i = 0; i < frame->num_planes; i++ ) {
+        acamera_gdc_sw_plane_t *p = &frame->planes[i];
+        uint32_t samples = p->width * p->channels;
+        for ( y = 0; y < p->height; y++ ) {
+            uint8_t *line = (uint8_t *)p->data + y * p->stride;
+            for ( x = 0; x < samples; x++ ) {
+                uint32_t px = x / p->channels;
+                uint32_t v = ( ( ( px >> 5 ) ^ ( y >> 5 ) ) & 1 ) ? max : ( px * max ) / p->width;
+                if ( frame->bit_depth > 8 )
+                    ( (uint16_t *)line )[x] = v;
+                else
+                    line[x] = v;
+            }
+        }
+    }
+}
+
+int main( int argc, char **argv )
+{
+    const char *name = "y_plane";
+    const char *in_path = NULL;
+    const char *out_path = NULL;
+    uint32_t bits = 8, threads = 0, frames = 10, i;
+    int opt;
+
+    while ( ( opt = getopt( argc, argv, "s:a:b:j:n:i:o:h" ) ) != -1 ) {
+        switch ( opt ) {
+        case 's':
+            name = optarg;
+            break;
+        case 'a':
+            if ( acamera_gdc_sw_set_isa( optarg ) != 0 ) {
+                printf( "kernels %s are not available\n", optarg );
+                return 1;
+            }
+            break;
+        case 'b':
+            bits = strtoul( optarg, NULL, 0 );
+            break;
+        case 'j':
+            threads = strtoul( optarg, NULL, 0 );
+            break;
+        case 'n':
+            frames = strtoul( optarg, NULL, 0 );
+            break;
+        case 'i':
+            in_path = optarg;
+            break;
+        case 'o':
+            out_path = optarg;
+            break;
+        default:
+            usage( argv[0] );
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    const gdc_seq_builtin_t *builtin = gdc_seq_builtin_find( name );
+    if ( builtin == NULL || frames == 0 ) {
+        usage( argv[0] );
+        return 1;
+    }
+
+    uint32_t *words = gdc_seq_builtin_copy( builtin );
+    gdc_seq_t seq;
+    if ( words == NULL || acamera_gdc_seq_parse( words, builtin->size, &seq ) != 0 ) {
+        printf( "cannot parse sequence %s\n", name );
+        free( words );
+        return 1;
+    }
+
+    acamera_gdc_sw_frame_t in, out;
+    if ( acamera_gdc_sw_frame_alloc( &in, builtin->total_planes, builtin->width, builtin->height, builtin->div_width, builtin->div_height, bits ) != 0 ||
+         acamera_gdc_sw_frame_alloc( &out, builtin->total_planes, builtin->width, builtin->height, builtin->div_width, builtin->div_height, bits ) != 0 ) {
+        printf( "cannot allocate frames\n" );
+        free( words );
+        return 1;
+    }
+    if ( in_path ? frame_io( &in, in_path, 0 ) != 0 : ( frame_pattern( &in ), 0 ) ) {
+        free( words );
+        return 1;
+    }
+
+    u64 t0 = system_host_time_ns();
+    for ( i = 0; i < frames; i++ ) {
+        if ( acamera_gdc_sw_process( &seq, &in, &out, threads ) != 0 ) {
+            printf( "software gdc failed on frame %u\n", i );
+            break;
+        }
+    }
+    u64 ns = system_host_time_ns() - t0;
+
+    int rc = i == frames ? 0 : 1;
+    if ( rc == 0 ) {
+        double pixels = (double)builtin->width * builtin->height * frames;
+        uint32_t tiles = 0;
+        for ( i = 0; i < seq.num_tile_lists; i++ )
+            tiles += seq.tile_lists[i].num_tiles;
+        printf( "sequence:   %s, %u bit, %u tiles, %s kernels\n", name, bits, tiles, acamera_gdc_sw_get_isa() );
+        printf( "frame time: %.3f ms\n", ns / 1e6 / frames );
+        printf( "throughput: %.1f Mpixel/s, %.1f fps\n", pixels * 1e3 / ns, frames * 1e9 / ns );
+        if ( seq.mesh_offset )
+            printf( "mesh:       not evaluated, tiles are mapped linearly onto their input\n" );
+    }
+    if ( rc == 0 && out_path )
+        rc = frame_io( &out, out_path, 1 ) ? 1 : 0;
+
+    acamera_gdc_sw_frame_free( &in );
+    acamera_gdc_sw_frame_free( &out );
+    free( words );
+    return rc;
+}
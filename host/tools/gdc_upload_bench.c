@@ -0,0 +1,110 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+
+//upload time of configuration sequences into the ddr window for every verification mode
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "system_log.h"
+#include "system_host_sim.h"
+#include "acamera_gdc_upload.h"
+#include "gdc_seq_builtin.h"
+
+#define BENCH_CONFIG_ADDR 0x4000
+#define BENCH_MAX_SIZE 0x40000
+
+static int bench_size( void *ddr, const uint32_t *src, uint32_t size, uint32_t loops, uint8_t use_dma, const char *label )
+{
+    uint32_t verify, i, dma_copies = 0;
+
+    printf( "%-22s %8u", label, size );
+    for ( verify = 0; verify < GDC_UPLOAD_VERIFY_MAX; verify++ ) {
+        gdc_upload_t upload;
+        if ( acamera_gdc_upload_init( &upload, verify, use_dma ) != 0 )
+            return -1;
+        u64 t0 = system_host_time_ns();
+        for ( i = 0; i < loops; i++ ) {
+            if ( acamera_gdc_upload( &upload, (uint32_t *)( (uintptr_t)ddr + BENCH_CONFIG_ADDR ), src, size / 4 ) != size ) {
+                printf( "\nupload failed\n" );
+                acamera_gdc_upload_deinit( &upload );
+                return -1;
+            }
+        }
+        u64 ns = system_host_time_ns() - t0;
+        printf( " %10.2f", ns / 1e3 / loops );
+        dma_copies += upload.dma_copies;
+        acamera_gdc_upload_deinit( &upload );
+    }
+    printf( "%s\n", use_dma && dma_copies == 0 ? " *" : "" );
+    return 0;
+}
+
+int main( int argc, char **argv )
+{
+    uint32_t loops = 200, size, i;
+    uint8_t use_dma = 0;
+    int opt;
+
+    while ( ( opt = getopt( argc, argv, "n:dh" ) ) != -1 ) {
+        switch ( opt ) {
+        case 'n':
+            loops = strtoul( optarg, NULL, 0 );
+            break;
+        case 'd':
+            use_dma = 1;
+            break;
+        default:
+            printf( "usage: %s [-n uploads] [-d]\n", argv[0] );
+            printf( "  -n  uploads per size and mode (default 200)\n" );
+            printf( "  -d  copy with the dma engine when the platform has one\n" );
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    void *ddr = system_ddr_mem_init();
+    uint32_t *pattern = malloc( BENCH_MAX_SIZE );
+    if ( loops == 0 || ddr == NULL || pattern == NULL )
+        return 1;
+    for ( i = 0; i < BENCH_MAX_SIZE / 4; i++ )
+        pattern[i] = i * 0x9e3779b9;
+
+    printf( "us per upload, %u uploads each\n", loops );
+    printf( "%-22s %8s", "sequence", "bytes" );
+    for ( i = 0; i < GDC_UPLOAD_VERIFY_MAX; i++ )
+        printf( " %10s", acamera_gdc_upload_verify_name( i ) );
+    printf( "\n" );
+
+    for ( size = 1024; size <= BENCH_MAX_SIZE; size *= 4 ) {
+        if ( bench_size( ddr, pattern, size, loops, use_dma, "pattern" ) != 0 )
+            return 1;
+    }
+    for ( i = 0; i < gdc_seq_builtin_count; i++ ) {
+        uint32_t *words = gdc_seq_builtin_copy( &gdc_seq_builtin[i] );
+        if ( words == NULL || bench_size( ddr, words, gdc_seq_builtin[i].size, loops, use_dma, gdc_seq_builtin[i].name ) != 0 )
+            return 1;
+        free( words );
+    }
+    if ( use_dma )
+        printf( "* no dma engine, copied with system_memcpy\n" );
+
+    free( pattern );
+    return 0;
+}
@@ -21,10 +21,53 @@
 #define __ACAMERA_DRIVER_CONFIG_H__
 
 
+#ifndef GDC_TEST_RUN
 #define GDC_TEST_RUN test_yuv420_semiplanar
+#endif
 
 //changeable logs
+#ifndef FW_LOG_LEVEL
 #define FW_LOG_LEVEL LOG_NOTHING
+#endif
+
+//verification of configuration sequences copied to ddr:
+//GDC_UPLOAD_VERIFY_NONE, GDC_UPLOAD_VERIFY_SAMPLED, GDC_UPLOAD_VERIFY_CRC or GDC_UPLOAD_VERIFY_FULL
+//crc and full read the whole uncached copy back, sampled reads ACAMERA_GDC_UPLOAD_SAMPLES words
+#ifndef GDC_CONFIG_UPLOAD_VERIFY
+#define GDC_CONFIG_UPLOAD_VERIFY GDC_UPLOAD_VERIFY_SAMPLED
+#endif
+
+//copy configuration sequences with a dma engine when the platform has one
+#ifndef GDC_CONFIG_UPLOAD_DMA
+#define GDC_CONFIG_UPLOAD_DMA 1
+#endif
+
+//gdc cores driven by the scheduler, numbered over the probed devices in order, core n raises interrupt n.
+//the cores of a device have their registers GDC_CORE_BASE_STRIDE apart, see system_gdc_io_core
+#ifndef GDC_NUM_CORES
+#define GDC_NUM_CORES 1
+#endif
+#define GDC_CORE_BASE_STRIDE 0x100
+
+//run the luma plane and the chroma planes of three plane formats on different cores
+#ifndef GDC_PLANE_SPLIT
+#define GDC_PLANE_SPLIT 0
+#endif
+
+//keep a copy of written gdc and fpga registers so field updates skip the register read
+#ifndef GDC_REG_SHADOW
+#define GDC_REG_SHADOW 1
+#endif
+
+//write the per frame gdc registers without ordering, a single write barrier precedes the start flag
+#ifndef GDC_RELAXED_MMIO
+#define GDC_RELAXED_MMIO 1
+#endif
+
+//record every register access into a ring exported through debugfs, see system_gdc_trace.h
+#ifndef GDC_MMIO_TRACE
+#define GDC_MMIO_TRACE 0
+#endif
 
 //fpga can configure dma writers and readers if available
 #define HAS_FPGA_WRAPPER 0
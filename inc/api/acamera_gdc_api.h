@@ -21,9 +21,66 @@
 #define __ACAMERA_GDC_API_H__
 
 #include "sys/system_stdlib.h"
+#include "sys/system_spinlock.h"
+#include "sys/system_gdc_io.h"
+#include "sys/system_timer.h"
+#include "sys/system_fence.h"
+#include "acamera_gdc_stats.h"
 
 #define ACAMERA_GDC_MAX_INPUT 3
 
+//register window of a gdc core, starting at base_gdc
+#define ACAMERA_GDC_REGS_SIZE 0x100
+
+//jobs that can wait behind the running one, power of two
+#define ACAMERA_GDC_JOB_QUEUE_SIZE 8
+
+//completed jobs waiting for their callbacks, power of two and larger than ACAMERA_GDC_JOB_QUEUE_SIZE
+#define ACAMERA_GDC_DONE_QUEUE_SIZE 16
+
+//predicted waits longer than this are left to the interrupt in polling mode, unless set otherwise
+#define ACAMERA_GDC_POLL_MAX_WAIT_NS 2000000
+
+//polling starts this long before the predicted end of the job
+#define ACAMERA_GDC_POLL_SLACK_NS 20000
+
+//log2 of the number of busy reads over the predicted job time
+#define ACAMERA_GDC_POLL_INTERVAL_SHIFT 6
+
+//log2 of the number of recent jobs averaged into the predicted job time
+#define ACAMERA_GDC_POLL_HISTORY_SHIFT 3
+
+//the watchdog allows a job this many times the time its pixels took on average
+#define ACAMERA_GDC_WATCHDOG_MARGIN 4
+
+//bounds of the watchdog timeout of a job
+#define ACAMERA_GDC_WATCHDOG_MIN_NS 2000000
+#define ACAMERA_GDC_WATCHDOG_MAX_NS 1000000000ULL
+
+//assumed processing time of 1024 output pixels in ns until a job was measured, 100 Mpixel/s
+#define ACAMERA_GDC_WATCHDOG_KPIXEL_NS 10240
+
+//log2 of the number of recent jobs averaged into the processing time per pixel
+#define ACAMERA_GDC_WATCHDOG_HISTORY_SHIFT 3
+
+//times a job that timed out or hit a recoverable error is run again before it fails
+#define ACAMERA_GDC_WATCHDOG_RETRIES 1
+
+//time the stop flag has to idle the block, its axi bursts in flight drain within it
+#define ACAMERA_GDC_STOP_TIMEOUT_NS 100000
+
+//wait between status reads while stopping, short enough to spin with the job queue lock held
+#define ACAMERA_GDC_STOP_POLL_NS 1000
+
+//time until the watchdog tries again to stop a block that did not stop
+#define ACAMERA_GDC_STOP_RETRY_NS 10000000
+
+//status bit set by the watchdog, never by the block, when it stopped a job that did not finish in time
+#define ACAMERA_GDC_STATUS_TIMEOUT 0x80000000
+
+//status bit set by the scheduler when the in-fence of a job signalled an error, the job did not run
+#define ACAMERA_GDC_STATUS_FENCE_ERROR 0x40000000
+
 // each configuration addresses and size
 typedef struct gdc_config {
     uint32_t config_addr;   //gdc config address
@@ -38,6 +95,90 @@ typedef struct gdc_config {
     uint8_t sequential_mode; //sequential processing
 } gdc_config_t;
 
+// status register of a gdc core decoded from a single read
+typedef struct gdc_status {
+    uint32_t raw;                   //status register as read
+    uint8_t busy;                   //processing in progress
+    uint8_t error;                  //the last job finished with one of the errors below
+    uint8_t configuration_error;    //wrong configuration stream
+    uint8_t user_abort;             //stopped by the start flag
+    uint8_t axi_reader_error;
+    uint8_t axi_writer_error;
+    uint8_t unaligned_access;       //an address is not aligned
+    uint8_t incompatible_configuration; //mode not implemented by the block
+    uint8_t timeout;                //the watchdog stopped the job, ACAMERA_GDC_STATUS_TIMEOUT
+    uint8_t fence_error;            //the input was never produced, ACAMERA_GDC_STATUS_FENCE_ERROR
+} gdc_status_t;
+
+// one frame for the gdc block
+typedef struct gdc_job {
+    uint32_t num_input;                         //number of planes
+    uint32_t input_addr[ACAMERA_GDC_MAX_INPUT];
+    uint32_t output_addr[ACAMERA_GDC_MAX_INPUT];
+    uint32_t output_lineoffset[ACAMERA_GDC_MAX_INPUT]; //set when the job starts
+    uint32_t config_addr;   //configuration sequence of the job, 0 keeps the one the block has
+    uint32_t config_size;   //size of configuration in 32bit
+    uint32_t stream;        //stream and frame number, handed back on completion
+    uint32_t frame;
+    gdc_status_t status;    //block status when the job completed, ignored on submit
+    u64 submit_ns;          //time the job was submitted, 0 lets acamera_gdc_submit take it
+    u64 start_ns;           //time the block started the job, set by the driver
+    u64 irq_ns;             //time the completion was latched, set by the driver
+    sys_fence in_fence;     //the scheduler starts the job once it signalled, NULL to start at once
+    sys_fence out_fence;    //signalled by the scheduler when the frame is done, NULL for none
+} gdc_job_t;
+
+// bounded ring of submitted jobs, drained by the completion interrupt
+typedef struct gdc_job_queue {
+    gdc_job_t jobs[ACAMERA_GDC_JOB_QUEUE_SIZE];
+    uint32_t head;          //jobs ever queued
+    uint32_t tail;          //jobs ever taken by the block
+    gdc_job_t running;      //job the block is processing while is_waiting_gdc is set
+    uint32_t hw_config_addr; //configuration the block is programmed with
+    uint32_t hw_config_size;
+    gdc_job_t done[ACAMERA_GDC_DONE_QUEUE_SIZE]; //completed jobs latched by acamera_gdc_latch_frame
+    uint32_t done_head;     //jobs ever completed
+    uint32_t done_tail;     //jobs ever handed to the callbacks
+    int completing;         //set while a caller runs the callbacks
+    sys_spinlock lock;      //serialises submitters against the interrupt handler
+} gdc_job_queue_t;
+
+// register writes of a frame, built when the gdc is configured and patched with the buffer addresses of each job
+typedef struct gdc_program {
+    system_gdc_reg_write_t regs[4 * ACAMERA_GDC_MAX_INPUT];
+    uint32_t num_static;    //leading line offset writes, only flushed after acamera_gdc_program_init
+    uint32_t num_planes;    //planes with an input and output address entry after the static part
+    uint32_t output_lineoffset[ACAMERA_GDC_MAX_INPUT];
+    int dirty;              //static part not written to the block yet
+} gdc_program_t;
+
+// completion of jobs by polling the busy bit
+typedef struct gdc_poll {
+    int enabled;            //set by acamera_gdc_set_polling
+    int polling;            //set while acamera_gdc_poll_frame waits
+    u64 max_wait_ns;        //predicted waits longer than this are left to the interrupt
+    u64 job_ns;             //predicted processing time, running average of recent jobs, 0 until one completed
+    u64 start_ns;           //start time of the running job
+    uint32_t polled;        //jobs completed by acamera_gdc_poll_frame
+    uint32_t fallbacks;     //waits left to the interrupt
+} gdc_poll_t;
+
+// deadline of the running job and recovery of failed jobs
+typedef struct gdc_watchdog {
+    sys_timer timer;        //NULL when the watchdog could not be created
+    u64 start_ns;           //start time of the running job
+    u64 deadline_ns;        //time the running job is stopped at
+    uint32_t kpixel_ns;     //processing time of 1024 output pixels in ns, running average of recent jobs
+    uint32_t retries;       //times the running job was run again
+    int aborted;            //a job was stopped, its interrupt may still come
+    int expired;            //the timer found the running job past its deadline, the thread stops it
+    int faulted;            //the block did not stop, the running job keeps it and its buffers
+    uint32_t timeouts;      //jobs stopped by the watchdog
+    uint32_t errors;        //jobs completed with an error bit
+    uint32_t resubmits;     //jobs run again after a timeout or error
+    uint32_t failed;        //jobs handed to the callbacks with an error
+} gdc_watchdog_t;
+
 // overall gdc settings and state
 typedef struct gdc_settings {
     uint32_t base_gdc;        //writing/reading to gdc base address, currently not read by api
@@ -45,15 +186,25 @@ typedef struct gdc_settings {
 
     uint32_t buffer_addr;     //start memory to write gdc output framse
     uint32_t buffer_size;     //size of memory output frames to determine if it is enough and can do multiple write points
-    void * ddr_mem;  			//opaque address in ddr added with offset to write the gdc config sequence
+    void * ddr_mem;  			//mapped ddr window of the device, NULL when it has none, the buffers come from system_dma_alloc
     uint32_t current_addr;    //current output address of gdc
-    int is_waiting_gdc;       //set when expecting an interrupt from gdc
+    int is_waiting_gdc;       //set while a job runs on the block and an interrupt is expected
+    gdc_job_queue_t job_queue; //jobs waiting for the block
+    gdc_program_t program;    //per frame register writes
+    gdc_poll_t poll;          //polling completion, the interrupt completes jobs when it is disabled
+    gdc_watchdog_t watchdog;  //stops jobs that do not finish in time
+    gdc_stats_t stats;        //latency of the jobs from submit to completion
 
     uint8_t seq_planes_pos; //sequential plance current index
-    uint32_t outbuffers[3];
+    uint32_t outbuffers[3];   //output planes of acamera_gdc_process without a pool
+    struct gdc_pool *pool;    //output slots taken by acamera_gdc_process, see acamera_gdc_pool.h
 
     //when inititialised this callback will be called to update frame buffer addresses and offsets
     void ( *get_frame_buffer )(  uint32_t total_input, uint32_t * out_addr, uint32_t * out_lineoffset );
+
+    //called after get_frame_buffer with the completed job and its status, from acamera_gdc_complete_frames
+    void ( *job_done )( void *ctx, const gdc_job_t *job );
+    void *job_done_ctx;
 } gdc_settings_t;
 
 /**
@@ -66,13 +217,36 @@ typedef struct gdc_settings {
  *           -1 - fail.
  */
 int acamera_gdc_init( gdc_settings_t *gdc_settings );
+/**
+ *   Build the per frame register program from gdc_config
+ *
+ *   Line offsets are computed once here, each frame then only patches the buffer
+ *   addresses and writes them with system_gdc_write_list. Called by acamera_gdc_init,
+ *   call it again with the block idle after changing the resolution or the planes.
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ */
+void acamera_gdc_program_init( gdc_settings_t *gdc_settings );
+/**
+ *   Release the resources taken by acamera_gdc_init
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ */
+void acamera_gdc_deinit( gdc_settings_t *gdc_settings );
+
 /**
  *   This function stops the gdc block
  *
+ *   Queued jobs are dropped. A running job is stopped and the call returns once
+ *   the block is idle, so its buffers can be released afterwards.
+ *
  *   @param  gdc_settings - overall gdc settings and state
  *
+ *   @return 0 - success
+ *           -1 - the block did not stop in time, it may still access the buffers of
+ *                the running job, which must neither be released nor reused.
  */
-void acamera_gdc_stop( gdc_settings_t *gdc_settings );
+int acamera_gdc_stop( gdc_settings_t *gdc_settings );
 
 /**
  *   This function starts the gdc block
@@ -84,31 +258,169 @@ void acamera_gdc_stop( gdc_settings_t *gdc_settings );
  */
 void acamera_gdc_start( gdc_settings_t *gdc_settings );
 
+/**
+ *   This function queues a job for the gdc block
+ *
+ *   The job starts at once when the block is idle, otherwise it waits in the
+ *   job queue and acamera_gdc_latch_frame starts it when the running job completes.
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ *   @param  job - planes, buffers and configuration of the frame, copied into the queue
+ *
+ *   @return 0 - success
+ *           -1 - invalid job, the queue is full or ACAMERA_GDC_DONE_QUEUE_SIZE jobs wait for their callbacks.
+ */
+int acamera_gdc_submit( gdc_settings_t *gdc_settings, const gdc_job_t *job );
+
 /**
  *   This function points gdc to its input resolution and yuv address and offsets
  *
- *   Shown inputs to GDC are Y and UV plane address and offsets
+ *   Shown inputs to GDC are Y and UV plane address and offsets.
+ *   The frame is queued with acamera_gdc_submit using the current gdc_config. Its output
+ *   goes to a free slot of the pool, which the consumer releases, or to outbuffers
+ *   when the core has no pool. current_addr is set to the first output plane.
  *
  *   @param  gdc_settings - overall gdc settings and state
  *   @param  num_input -  number of input addresses in the array to be processed by gdc
  *   @param  input_addr - input addresses in the array to be processed by gdc
  *
  *   @return 0 - success
- *           -1 - no interrupt from GDC.
+ *           -1 - invalid input, no free output slot or the job queue is full.
  */
 
 int acamera_gdc_process( gdc_settings_t *gdc_settings, uint32_t num_input, uint32_t * input_addr);
 /**
- *   This function gets the GDC ouput frame addresses and offsets and updates the frame buffer via callback if it is available
+ *   Decode a status register value
  *
- *   Shown ouputs to GDC are Y and UV plane address and offsets
+ *   @param  raw - value of the status register
+ *   @param  status - decoded status
+ */
+void acamera_gdc_status_decode( uint32_t raw, gdc_status_t *status );
+
+/**
+ *   Take a snapshot of the status register with one read
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ *   @param  status - decoded status
+ */
+void acamera_gdc_status_read( gdc_settings_t *gdc_settings, gdc_status_t *status );
+
+/**
+ *   Latch the completed job, to be called in interrupt context
+ *
+ *   The status register is read once and the next queued job is started at once,
+ *   so the block stays busy. The completed job with that status is kept until
+ *   acamera_gdc_complete_frames runs its callbacks.
+ *
+ *   A job failing with an AXI error is run again up to ACAMERA_GDC_WATCHDOG_RETRIES
+ *   times first. Jobs with configuration errors or unaligned buffers fail at once.
+ *   The watchdog stops a job running longer than its deadline, derived from its
+ *   output pixels and the observed throughput, and handles it the same way.
  *
  *   @param  gdc_settings - overall gdc settings and state
- *   @param  num_input -  number of input addresses in the array to be processed by gdc
+ *
+ *   @return 0 - success
+ *           -1 - unexpected interrupt from GDC.
+ */
+int acamera_gdc_latch_frame( gdc_settings_t *gdc_settings );
+
+/**
+ *   Run the callbacks of the jobs latched by acamera_gdc_latch_frame
+ *
+ *   The output frame addresses and offsets of each completed job are passed to
+ *   the frame buffer callback and the job to the job_done callback, oldest job
+ *   first. Meant for the threaded part of the interrupt, the callbacks run
+ *   without the job queue lock. A call overlapping another one for the same core
+ *   returns at once and leaves its jobs to the first one.
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ *
+ *   @return number of jobs completed
+ */
+uint32_t acamera_gdc_complete_frames( gdc_settings_t *gdc_settings );
+
+/**
+ *   This function completes the running job on the gdc interrupt
+ *
+ *   acamera_gdc_latch_frame followed by acamera_gdc_complete_frames, for
+ *   platforms running all of the interrupt in one handler.
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ *   @param  num_input -  number of planes the caller expects, the completed job reports its own
  *
  *   @return 0 - success
  *           -1 - unexpected interrupt from GDC.
  */
 int acamera_gdc_get_frame( gdc_settings_t *gdc_settings, uint32_t num_input );
 
+/**
+ *   Select polling completion for a core
+ *
+ *   With polling enabled acamera_gdc_poll_frame can wait for the running job
+ *   instead of the interrupt, which stays enabled for the waits it leaves over.
+ *   Interrupts for jobs the poll completed are ignored.
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ *   @param  enable - 1 to poll, 0 to complete jobs by interrupt only
+ *   @param  max_wait_ns - predicted waits longer than this are left to the interrupt, 0 for ACAMERA_GDC_POLL_MAX_WAIT_NS
+ */
+void acamera_gdc_set_polling( gdc_settings_t *gdc_settings, int enable, u64 max_wait_ns );
+
+/**
+ *   Wait for the running job by polling the busy bit
+ *
+ *   Sleeps until shortly before the predicted end of the job, then reads the
+ *   busy bit at an interval of a fraction of the predicted job time and
+ *   completes the job with its callbacks once the block is idle. The caller
+ *   must be allowed to sleep.
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ *
+ *   @return 0 - the job completed, or no job was running
+ *           1 - the wait is left to the interrupt, no prediction yet, too long or the job overran it
+ *           -1 - polling is not enabled.
+ */
+int acamera_gdc_poll_frame( gdc_settings_t *gdc_settings );
+
+/**
+ *   Number of jobs submitted and not completed yet, including the running one
+ *   and those waiting for their callbacks
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ *
+ *   @return pending jobs
+ */
+uint32_t acamera_gdc_pending_jobs( gdc_settings_t *gdc_settings );
+
+/**
+ *   This function points the gdc block to another configuration sequence already in memory
+ *
+ *   Only the configuration address and size registers are written, nothing is copied.
+ *   Jobs queued by acamera_gdc_process afterwards use the new sequence, while the
+ *   block is busy the registers are written when such a job starts.
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ *   @param  config_addr - address of the configuration sequence
+ *   @param  config_size - size of the configuration sequence in 32 bit words
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int acamera_gdc_set_config( gdc_settings_t *gdc_settings, uint32_t config_addr, uint32_t config_size );
+
+/**
+ *   This function checks a configuration sequence before it is given to the gdc block
+ *
+ *   The tiles are checked against the input/output resolution and planes of gdc_config
+ *   and against the tile cache size and filter bank count read from the capability registers.
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ *   @param  sequence - configuration sequence, 32 bit aligned
+ *   @param  size - sequence size in bytes
+ *
+ *   @return 0 - success
+ *           -1 - sequence is malformed or does not fit the block.
+ */
+int acamera_gdc_check_sequence( gdc_settings_t *gdc_settings, const uint32_t *sequence, uint32_t size );
+
 #endif
@@ -0,0 +1,117 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __ACAMERA_GDC_CACHE_H__
+#define __ACAMERA_GDC_CACHE_H__
+
+#include "sys/system_stdlib.h"
+
+/*
+ * Cache of configuration sequences in the ddr config region.
+ *
+ * The region is split into equal slots, each holding one sequence keyed by
+ * a 64 bit hash of its contents. Selecting a sequence that is already in a
+ * slot copies nothing, the caller only points config_addr/config_size at
+ * the slot. On a miss the least recently used slot is reloaded.
+ */
+
+#define ACAMERA_GDC_CACHE_MAX_SLOTS 8
+
+//config_addr must be aligned to this
+#define ACAMERA_GDC_CACHE_SLOT_ALIGN 256
+
+//copies words of a sequence into ddr, returns the number of bytes written and verified
+typedef uint32_t ( *gdc_cache_load_t )( uint32_t *dst, uint32_t *src, uint32_t words );
+
+typedef struct gdc_cache_slot {
+    u64 hash;           //hash of the sequence held by the slot
+    uint32_t size;      //sequence size in bytes, 0 for a free slot
+    uint32_t last_use;  //cache clock of the last lookup that returned the slot
+} gdc_cache_slot_t;
+
+typedef struct gdc_cache {
+    void *region_mem;       //cpu address of the region
+    uint32_t region_addr;   //config address of the first slot
+    uint32_t slot_size;     //bytes per slot
+    uint32_t num_slots;
+    uint32_t clock;         //incremented on every lookup
+    gdc_cache_load_t load;
+    gdc_cache_slot_t slots[ACAMERA_GDC_CACHE_MAX_SLOTS];
+
+    uint32_t hits;
+    uint32_t misses;
+} gdc_cache_t;
+
+/**
+ *   Split a memory region into sequence slots
+ *
+ *   @param  cache - cache state
+ *   @param  region_mem - cpu address of the region
+ *   @param  region_addr - config address of the region as seen by the gdc, aligned to ACAMERA_GDC_CACHE_SLOT_ALIGN
+ *   @param  region_size - region size in bytes
+ *   @param  num_slots - number of slots, at most ACAMERA_GDC_CACHE_MAX_SLOTS
+ *   @param  load - copies a sequence into a slot
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int acamera_gdc_cache_init( gdc_cache_t *cache, void *region_mem, uint32_t region_addr, uint32_t region_size, uint32_t num_slots, gdc_cache_load_t load );
+
+/**
+ *   Find a sequence by its hash without touching its data
+ *
+ *   @param  cache - cache state
+ *   @param  hash - acamera_gdc_cache_hash of the sequence
+ *   @param  size - sequence size in bytes
+ *   @param  config_addr - config address of the slot holding the sequence
+ *
+ *   @return 0 - sequence is in the cache
+ *           -1 - sequence is not cached.
+ */
+int acamera_gdc_cache_lookup( gdc_cache_t *cache, u64 hash, uint32_t size, uint32_t *config_addr );
+
+/**
+ *   Find or load a sequence
+ *
+ *   @param  cache - cache state
+ *   @param  sequence - configuration sequence, 32 bit aligned
+ *   @param  size - sequence size in bytes
+ *   @param  config_addr - config address of the slot holding the sequence
+ *
+ *   @return 0 - sequence was in the cache
+ *           1 - sequence was loaded into a slot
+ *           -1 - sequence does not fit a slot or could not be loaded.
+ */
+int acamera_gdc_cache_get( gdc_cache_t *cache, const uint32_t *sequence, uint32_t size, uint32_t *config_addr );
+
+/**
+ *   Forget all slots, for example after the ddr region was overwritten
+ *
+ *   @param  cache - cache state
+ */
+void acamera_gdc_cache_invalidate( gdc_cache_t *cache );
+
+/**
+ *   64 bit FNV-1a style hash of a sequence, four lanes of interleaved words
+ *
+ *   @return the hash
+ */
+u64 acamera_gdc_cache_hash( const uint32_t *sequence, uint32_t size );
+
+#endif
@@ -0,0 +1,83 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __ACAMERA_GDC_DMABUF_H__
+#define __ACAMERA_GDC_DMABUF_H__
+
+#include "acamera_gdc_api.h"
+#include "acamera_gdc_pool.h"
+#include "sys/system_dmabuf.h"
+
+/*
+ * Frames in buffers shared with other devices.
+ *
+ * The planes of a frame are given as dma-buf descriptors and byte offsets,
+ * planes may share a descriptor. The buffers are imported for the gdc, the
+ * plane addresses of the job are the gdc addresses of the mappings plus the
+ * offsets, so the block reads and writes the buffers of the other devices
+ * without a copy. The imports are held until the job has completed.
+ */
+
+// imports of the planes of one frame
+typedef struct gdc_dmabuf_frame {
+    uint32_t num_planes;
+    sys_dmabuf planes[ACAMERA_GDC_MAX_INPUT]; //NULL for a plane sharing the import of an earlier plane
+} gdc_dmabuf_frame_t;
+
+/**
+ *   Import the planes of a frame for a gdc core
+ *
+ *   Every plane must fit its buffer with the resolution and line offsets the
+ *   core is configured with.
+ *
+ *   @param  frame - filled with the imports
+ *   @param  gdc_settings - core the frame is processed on
+ *   @param  fd - dma-buf descriptor of each plane
+ *   @param  offset - byte offset of each plane in its buffer, NULL for 0
+ *   @param  output - 1 for the output planes, 0 for the input planes
+ *   @param  addr - filled with the gdc address of each plane, input_addr or output_addr of the job
+ *
+ *   @return 0 - success
+ *           -1 - a buffer cannot be imported or is too small, nothing stays imported.
+ */
+int acamera_gdc_dmabuf_import( gdc_dmabuf_frame_t *frame, const gdc_settings_t *gdc_settings, const int *fd, const uint32_t *offset, int output, uint32_t *addr );
+
+/**
+ *   Release the imports of a frame once the gdc is done with it
+ *
+ *   @param  frame - imports from acamera_gdc_dmabuf_import
+ */
+void acamera_gdc_dmabuf_release( gdc_dmabuf_frame_t *frame );
+
+/**
+ *   Export a slot of an output pool as a dma-buf
+ *
+ *   The descriptor lets other devices and user space map the frames the gdc
+ *   writes to the slot, plane n starts at plane_offset[n] of the pool.
+ *
+ *   @param  pool - initialised output pool
+ *   @param  slot - slot number
+ *   @param  fd - filled with the descriptor
+ *
+ *   @return 0 - success
+ *           -1 - no such slot or the export failed.
+ */
+int acamera_gdc_dmabuf_export_slot( const gdc_pool_t *pool, uint32_t slot, int *fd );
+
+#endif
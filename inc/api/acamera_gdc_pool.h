@@ -0,0 +1,109 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __ACAMERA_GDC_POOL_H__
+#define __ACAMERA_GDC_POOL_H__
+
+#include "acamera_gdc_api.h"
+
+/*
+ * Pool of output frames carved from buffer_addr/buffer_size of a gdc core.
+ *
+ * The output memory is split into equal slots, each holding every output
+ * plane of one frame at an address aligned for AXI bursts. A job takes a free
+ * slot for its output and the consumer of the frame hands it back once it has
+ * read it, so the block writes the next frames while earlier ones are still
+ * shown or processed downstream. With N slots up to N frames are in flight
+ * between the block and the consumer.
+ */
+
+#define ACAMERA_GDC_POOL_MAX_SLOTS 8
+
+//output planes start at multiples of this, a full AXI burst of 16 beats on a 128 bit bus
+#define ACAMERA_GDC_POOL_ALIGN 256
+
+//slots start on a page, so each one can be exported as a dma-buf of its own
+#define ACAMERA_GDC_POOL_SLOT_ALIGN 4096
+
+typedef struct gdc_pool {
+    uint32_t base_addr;     //first slot, buffer_addr rounded up to ACAMERA_GDC_POOL_SLOT_ALIGN
+    uint32_t slot_size;     //bytes per slot, a multiple of ACAMERA_GDC_POOL_SLOT_ALIGN
+    uint32_t num_slots;
+    uint32_t num_planes;
+    uint32_t plane_offset[ACAMERA_GDC_MAX_INPUT]; //offset of each plane in a slot
+    uint32_t free_mask;     //bit n set while slot n is free
+    uint32_t next;          //slot the search for a free one starts at, so slots are used in turn
+    uint32_t exhausted;     //acquires that found no free slot
+    sys_spinlock lock;      //serialises the producer against the consumers
+} gdc_pool_t;
+
+/**
+ *   Split the output memory of a core into frame slots
+ *
+ *   The plane sizes follow the output resolution and line offsets of the core,
+ *   so it must be initialised with acamera_gdc_init first.
+ *
+ *   @param  pool - pool state
+ *   @param  gdc_settings - core owning buffer_addr/buffer_size
+ *   @param  num_slots - number of slots, 0 for as many as fit up to ACAMERA_GDC_POOL_MAX_SLOTS
+ *
+ *   @return 0 - success
+ *           -1 - the memory does not hold num_slots frames, or no frame at all.
+ */
+int acamera_gdc_pool_init( gdc_pool_t *pool, const gdc_settings_t *gdc_settings, uint32_t num_slots );
+
+/**
+ *   Release the pool lock
+ *
+ *   @param  pool - pool state
+ */
+void acamera_gdc_pool_deinit( gdc_pool_t *pool );
+
+/**
+ *   Take a free slot
+ *
+ *   @param  pool - pool state
+ *   @param  output_addr - filled with the address of every output plane of the slot
+ *
+ *   @return 0 - success
+ *           -1 - every slot is in use.
+ */
+int acamera_gdc_pool_acquire( gdc_pool_t *pool, uint32_t *output_addr );
+
+/**
+ *   Hand a slot back once the consumer is done with its frame
+ *
+ *   @param  pool - pool state
+ *   @param  addr - address of the first output plane of the slot, output_addr[0] of the job
+ *
+ *   @return 0 - success
+ *           -1 - the address is not a slot in use.
+ */
+int acamera_gdc_pool_release( gdc_pool_t *pool, uint32_t addr );
+
+/**
+ *   Number of free slots
+ *
+ *   @param  pool - pool state
+ *
+ *   @return free slots
+ */
+uint32_t acamera_gdc_pool_free_slots( gdc_pool_t *pool );
+
+#endif
@@ -0,0 +1,155 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+
+#ifndef __ACAMERA_GDC_SCHED_H__
+#define __ACAMERA_GDC_SCHED_H__
+
+#include "acamera_gdc_api.h"
+
+/*
+ * Scheduler of frames over several gdc cores.
+ *
+ * Each core has its own gdc_settings_t and job queue. Submitted frames wait
+ * in the scheduler queue and go to the first core with fewer than
+ * ACAMERA_GDC_SCHED_CORE_DEPTH jobs, so a core keeps one frame running and
+ * the next one queued behind it. Frames of one stream can complete out of
+ * order on different cores, the done callback still sees them in the order
+ * they were submitted.
+ *
+ * A frame can also be split into parts, for example the luma and the chroma
+ * planes each with their own configuration sequence. The parts are dispatched
+ * like frames, so they run on different cores when both are idle, and the
+ * frame is done when its last part completes.
+ *
+ * A frame can wait for its input with an in-fence. It stays in the queue,
+ * and the later frames of its stream with it, until the fence signals, so the
+ * producer does not have to finish before the frame is queued. Frames of the
+ * other streams are dispatched past it. The out-fence of a
+ * frame is signalled right before its done callback, with an error when the
+ * frame failed or its in-fence signalled one.
+ */
+
+#define ACAMERA_GDC_SCHED_MAX_CORES 2
+#define ACAMERA_GDC_SCHED_MAX_STREAMS 4
+
+//jobs handed to a core at a time, at most ACAMERA_GDC_JOB_QUEUE_SIZE + 1
+#define ACAMERA_GDC_SCHED_CORE_DEPTH 2
+
+//frames waiting for a core, power of two
+#define ACAMERA_GDC_SCHED_QUEUE_SIZE 16
+
+//frames of a stream submitted and not delivered yet, power of two
+#define ACAMERA_GDC_SCHED_WINDOW 16
+
+//delivers a completed frame of a stream, frames of a stream arrive in submit order
+typedef void ( *gdc_sched_done_t )( void *ctx, const gdc_job_t *job );
+
+typedef struct gdc_sched_stream {
+    uint32_t next_frame;    //frame number of the next submitted frame
+    uint32_t next_done;     //frame number delivered next
+    uint8_t parts[ACAMERA_GDC_SCHED_WINDOW];    //parts of the frame still running, 0 when it completed
+    gdc_job_t jobs[ACAMERA_GDC_SCHED_WINDOW];   //outstanding frames as handed to the done callback
+} gdc_sched_stream_t;
+
+struct gdc_sched;
+
+typedef struct gdc_sched_core {
+    struct gdc_sched *sched;    //job_done_ctx of the core points here
+    gdc_settings_t *settings;
+    uint32_t in_flight;         //jobs handed to the core and not completed
+    uint32_t frames;            //frames completed by the core
+} gdc_sched_core_t;
+
+typedef struct gdc_sched {
+    uint32_t num_cores;
+    gdc_sched_core_t cores[ACAMERA_GDC_SCHED_MAX_CORES];
+
+    gdc_job_t queue[ACAMERA_GDC_SCHED_QUEUE_SIZE];
+    uint32_t head;          //frames ever queued
+    uint32_t tail;          //frames ever handed to a core or failed, the queue is compacted towards head
+
+    gdc_sched_stream_t streams[ACAMERA_GDC_SCHED_MAX_STREAMS];
+    int delivering;         //set while a caller runs the done callbacks
+
+    gdc_sched_done_t done;
+    void *done_ctx;
+    sys_spinlock lock;
+} gdc_sched_t;
+
+/**
+ *   Take over the gdc cores
+ *
+ *   The cores must be initialised with acamera_gdc_init. Their job_done
+ *   callback is pointed at the scheduler.
+ *
+ *   @param  sched - scheduler state
+ *   @param  cores - settings of each core
+ *   @param  num_cores - number of cores, at most ACAMERA_GDC_SCHED_MAX_CORES
+ *   @param  done - called with every completed frame
+ *   @param  ctx - passed to done
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int acamera_gdc_sched_init( gdc_sched_t *sched, gdc_settings_t **cores, uint32_t num_cores, gdc_sched_done_t done, void *ctx );
+
+/**
+ *   Release the cores and the scheduler lock
+ *
+ *   @param  sched - scheduler state
+ */
+void acamera_gdc_sched_deinit( gdc_sched_t *sched );
+
+/**
+ *   Queue a frame of a stream
+ *
+ *   The stream and frame fields of the job are set by the scheduler. The
+ *   scheduler takes over the fence handles of the job on success and drops
+ *   them once the frame was delivered.
+ *
+ *   @param  sched - scheduler state
+ *   @param  stream - stream number, below ACAMERA_GDC_SCHED_MAX_STREAMS
+ *   @param  job - planes, buffers and configuration of the frame
+ *
+ *   @return 0 - success
+ *           -1 - invalid stream, the stream has ACAMERA_GDC_SCHED_WINDOW frames outstanding or the queue is full.
+ */
+int acamera_gdc_sched_submit( gdc_sched_t *sched, uint32_t stream, const gdc_job_t *job );
+
+/**
+ *   Queue a frame of a stream as parts that may run on different cores
+ *
+ *   Every part carries the addresses of all planes and the configuration
+ *   sequence producing its share of them. The done callback gets the first
+ *   part once all parts completed, with the errors of all parts in its status.
+ *   The fences of the first part are those of the frame, the other parts
+ *   carry the same handles or none.
+ *
+ *   @param  sched - scheduler state
+ *   @param  stream - stream number, below ACAMERA_GDC_SCHED_MAX_STREAMS
+ *   @param  parts - jobs of the frame
+ *   @param  num_parts - number of parts, at most ACAMERA_GDC_SCHED_MAX_CORES
+ *
+ *   @return 0 - success
+ *           -1 - invalid stream or parts, the stream has ACAMERA_GDC_SCHED_WINDOW frames outstanding or the queue is full.
+ */
+int acamera_gdc_sched_submit_split( gdc_sched_t *sched, uint32_t stream, const gdc_job_t *parts, uint32_t num_parts );
+
+#endif
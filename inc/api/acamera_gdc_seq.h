@@ -0,0 +1,211 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __ACAMERA_GDC_SEQ_H__
+#define __ACAMERA_GDC_SEQ_H__
+
+#include "sys/system_stdlib.h"
+
+/*
+ * Layout of a gdc configuration sequence as found in the gdc_config_seq_*.h streams.
+ * The stream is a list of little endian 32 bit words grouped in sections, each
+ * section starts with a header word:
+ *
+ *   bits  7:0  length
+ *   bits 15:8  section type
+ *   bits 23:16 parameter
+ *
+ * filter bank (type 0x21, parameter = taps): length words follow, the bank index
+ *   and one word per phase holding the signed 8 bit taps, tap 0 in the low byte.
+ * mesh (type 0x12): (length + 1) * 16 words of coordinate data follow.
+ * tile list (type 0x10): length preamble words follow, then 6 word tile
+ *   descriptors, each starting with a word that has bit 31 set.
+ */
+
+#define ACAMERA_GDC_SEQ_TYPE_FILTER_BANK 0x21
+#define ACAMERA_GDC_SEQ_TYPE_MESH 0x12
+#define ACAMERA_GDC_SEQ_TYPE_TILES 0x10
+
+#define ACAMERA_GDC_SEQ_MAX_BANKS 8
+#define ACAMERA_GDC_SEQ_PHASES 16
+#define ACAMERA_GDC_SEQ_TAPS 4
+#define ACAMERA_GDC_SEQ_MAX_TILE_LISTS 4
+#define ACAMERA_GDC_SEQ_TILE_WORDS 6
+#define ACAMERA_GDC_SEQ_TILE_MARKER 0x80000000
+
+//taps of a phase add up to 1 << ACAMERA_GDC_SEQ_TAP_SHIFT
+#define ACAMERA_GDC_SEQ_TAP_SHIFT 6
+
+//channels the tiles can address: Y/R, U/G, V/B
+#define ACAMERA_GDC_SEQ_MAX_CHANNELS 3
+
+//configuration sequences are loaded as firmware files named <dir>/<format>_<width>x<height>.bin
+#define ACAMERA_GDC_SEQ_FIRMWARE_DIR "arm_gdc"
+#define ACAMERA_GDC_SEQ_NAME_SIZE 64
+
+// tile flags
+#define ACAMERA_GDC_SEQ_TILE_ROW_START 0x1
+#define ACAMERA_GDC_SEQ_TILE_ROW_END 0x2
+
+// polyphase filter bank
+typedef struct gdc_seq_bank {
+    uint32_t index;                                           //bank number used by the tiles
+    int8_t taps[ACAMERA_GDC_SEQ_PHASES][ACAMERA_GDC_SEQ_TAPS]; //taps for each 1/16 pixel phase
+} gdc_seq_bank_t;
+
+// tile list section
+typedef struct gdc_seq_tile_list {
+    uint32_t offset;        //word offset of the section header
+    uint32_t num_preamble;  //number of preamble words after the header
+    const uint32_t *preamble;
+    uint32_t num_tiles;
+    const uint32_t *tiles;  //num_tiles * ACAMERA_GDC_SEQ_TILE_WORDS words
+} gdc_seq_tile_list_t;
+
+// decoded tile descriptor
+typedef struct gdc_seq_tile {
+    uint16_t out_x;         //output rectangle in pixels of the addressed channels
+    uint16_t out_y;
+    uint16_t out_width;
+    uint16_t out_height;
+    uint16_t in_x;          //input rectangle read to produce the output rectangle
+    uint16_t in_y;
+    uint16_t in_width;
+    uint16_t in_height;
+    uint8_t channel_mask;   //bit n set when channel n is produced by the tile
+    uint8_t flags;          //ACAMERA_GDC_SEQ_TILE_ROW_START/END
+    uint8_t hbank;          //horizontal filter bank
+    uint8_t vbank;          //vertical filter bank
+} gdc_seq_tile_t;
+
+// parsed sequence, all pointers point into the original stream
+typedef struct gdc_seq {
+    const uint32_t *words;
+    uint32_t num_words;
+
+    uint32_t num_banks;
+    gdc_seq_bank_t banks[ACAMERA_GDC_SEQ_MAX_BANKS];
+
+    uint32_t mesh_offset;   //word offset of the mesh data, 0 when there is none
+    uint32_t mesh_words;
+
+    uint32_t num_tile_lists;
+    gdc_seq_tile_list_t tile_lists[ACAMERA_GDC_SEQ_MAX_TILE_LISTS];
+} gdc_seq_t;
+
+// frame layout and block capabilities a sequence is checked against
+typedef struct gdc_seq_limits {
+    uint32_t input_width;       //input resolution of plane 0
+    uint32_t input_height;
+    uint32_t output_width;      //output resolution of plane 0
+    uint32_t output_height;
+    uint32_t total_planes;
+    uint8_t div_width;          //shift right applied to the other planes
+    uint8_t div_height;
+    uint32_t tile_cache_clusters; //tile cache size in 16x16 clusters, 0 skips the check
+    uint32_t num_filter_banks;  //polyphase filter banks of the block, 0 skips the check
+} gdc_seq_limits_t;
+
+/**
+ *   Split a configuration sequence into its sections
+ *
+ *   @param  data - sequence, 32 bit aligned
+ *   @param  size - sequence size in bytes
+ *   @param  seq - parsed sequence
+ *
+ *   @return 0 - success
+ *           -1 - malformed sequence.
+ */
+int acamera_gdc_seq_parse( const void *data, uint32_t size, gdc_seq_t *seq );
+
+/**
+ *   Decode one tile descriptor of a tile list
+ *
+ *   @param  list - tile list of a parsed sequence
+ *   @param  index - tile number in the list
+ *   @param  tile - decoded tile
+ */
+void acamera_gdc_seq_tile_decode( const gdc_seq_tile_list_t *list, uint32_t index, gdc_seq_tile_t *tile );
+
+/**
+ *   Find a filter bank by its index
+ *
+ *   @return the bank, NULL when the sequence does not carry it
+ */
+const gdc_seq_bank_t *acamera_gdc_seq_bank( const gdc_seq_t *seq, uint32_t index );
+
+/**
+ *   Check a parsed sequence against a frame layout and the block capabilities
+ *
+ *   Every tile must address existing planes, stay inside the input and output
+ *   planes, use filter banks carried by the sequence and fit the tile cache.
+ *   The first violation is logged.
+ *
+ *   @param  seq - parsed sequence
+ *   @param  limits - frame layout and capabilities
+ *
+ *   @return 0 - success
+ *           -1 - the sequence does not fit.
+ */
+int acamera_gdc_seq_validate( const gdc_seq_t *seq, const gdc_seq_limits_t *limits );
+
+/**
+ *   Size of a plane of the frame described by limits
+ *
+ *   With two planes the second one holds channels 1 and 2 interleaved and its
+ *   width is counted in channel pairs.
+ *
+ *   @param  limits - frame layout
+ *   @param  channel - channel 0..2 addressed by a tile
+ *   @param  output - 1 for the output plane, 0 for the input plane
+ *   @param  width - plane width in pixels of the channel
+ *   @param  height - plane height in lines
+ */
+void acamera_gdc_seq_plane_size( const gdc_seq_limits_t *limits, uint32_t channel, int output, uint32_t *width, uint32_t *height );
+
+/**
+ *   Copy a sequence keeping only the tiles of some channels
+ *
+ *   Filter banks and mesh are copied unchanged, tile lists left without tiles
+ *   are dropped. Used to run the planes of a frame on different gdc cores.
+ *
+ *   @param  seq - parsed sequence
+ *   @param  channel_mask - bit n set to keep the tiles producing channel n
+ *   @param  out - buffer for the new sequence
+ *   @param  out_size - size of the buffer in bytes
+ *
+ *   @return size of the new sequence in bytes, 0 when it has no tile left or does not fit.
+ */
+uint32_t acamera_gdc_seq_split( const gdc_seq_t *seq, uint8_t channel_mask, uint32_t *out, uint32_t out_size );
+
+/**
+ *   Firmware file name of a configuration sequence
+ *
+ *   @param  name - buffer for the name, ACAMERA_GDC_SEQ_NAME_SIZE bytes are enough for any format up to 32 characters
+ *   @param  size - size of the buffer
+ *   @param  format - frame format of the sequence, for example semiplanar_yuv420
+ *   @param  width - output resolution the sequence was generated for
+ *   @param  height
+ *
+ *   @return 0 - success
+ *           -1 - name does not fit.
+ */
+int acamera_gdc_seq_firmware_name( char *name, uint32_t size, const char *format, uint32_t width, uint32_t height );
+
+#endif
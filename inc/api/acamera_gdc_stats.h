@@ -0,0 +1,106 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __ACAMERA_GDC_STATS_H__
+#define __ACAMERA_GDC_STATS_H__
+
+#include "sys/system_stdlib.h"
+
+/*
+ * Latency histograms of the jobs of a gdc core.
+ *
+ * A job is timestamped when it is submitted, when the block starts it, when
+ * its interrupt is latched and when its callbacks returned. The time between
+ * two of those points goes into a histogram with log2 buckets, bucket n
+ * counts latencies of 2^n up to 2^(n+1) - 1 ns and the last bucket everything
+ * longer.
+ *
+ * Each stage is recorded from one place only, serialised by the job queue lock
+ * or the completing flag of the queue, so recording takes no lock of its own.
+ * Readers copy the histograms without any lock; a copy taken while a job is
+ * recorded may count it in some stages only.
+ */
+
+#define ACAMERA_GDC_STATS_BUCKETS 32
+
+enum {
+    ACAMERA_GDC_STAGE_QUEUE,        //submit to the start of the block
+    ACAMERA_GDC_STAGE_PROCESS,      //start to the interrupt
+    ACAMERA_GDC_STAGE_COMPLETE,     //interrupt to the end of the callbacks
+    ACAMERA_GDC_STAGE_TOTAL,        //submit to the end of the callbacks
+    ACAMERA_GDC_STAGES
+};
+
+typedef struct gdc_hist {
+    uint32_t buckets[ACAMERA_GDC_STATS_BUCKETS];
+    uint32_t count;         //latencies recorded
+    u64 max_ns;             //longest latency recorded
+} gdc_hist_t;
+
+// latency of every stage of the jobs of a core
+typedef struct gdc_stats {
+    gdc_hist_t stages[ACAMERA_GDC_STAGES];
+} gdc_stats_t;
+
+/**
+ *   Count a latency
+ *
+ *   @param  hist - histogram of the stage
+ *   @param  ns - latency in ns
+ */
+void acamera_gdc_stats_add( gdc_hist_t *hist, u64 ns );
+
+/**
+ *   Latency below which a share of the recorded latencies falls
+ *
+ *   The result is the upper end of the bucket holding the percentile, but
+ *   no more than the longest latency recorded, so it errs on the long side.
+ *
+ *   @param  hist - histogram of the stage
+ *   @param  percent - 1..100
+ *
+ *   @return latency in ns, 0 when nothing was recorded
+ */
+u64 acamera_gdc_stats_percentile( const gdc_hist_t *hist, uint32_t percent );
+
+/**
+ *   Take a copy of the histograms
+ *
+ *   @param  stats - histograms being recorded
+ *   @param  copy - copy of them
+ */
+void acamera_gdc_stats_get( const gdc_stats_t *stats, gdc_stats_t *copy );
+
+/**
+ *   Drop the recorded latencies
+ *
+ *   @param  stats - histograms of a core
+ */
+void acamera_gdc_stats_clear( gdc_stats_t *stats );
+
+/**
+ *   Name of a stage for reports
+ *
+ *   @param  stage - ACAMERA_GDC_STAGE_*
+ *
+ *   @return name, "unknown" for an invalid stage
+ */
+const char *acamera_gdc_stats_stage_name( uint32_t stage );
+
+#endif
@@ -0,0 +1,100 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+
+#ifndef __ACAMERA_GDC_UPLOAD_H__
+#define __ACAMERA_GDC_UPLOAD_H__
+
+#include "sys/system_stdlib.h"
+
+/*
+ * Copy of configuration sequences into the ddr config region.
+ *
+ * The ddr memory is mapped uncached, so reading every word back costs about
+ * as much as writing it. The verification is selectable:
+ *
+ *   none     trust the copy
+ *   sampled  read back ACAMERA_GDC_UPLOAD_SAMPLES words spread over the
+ *            sequence plus the last one, the positions move on every upload
+ *   crc      compare the crc-32 of the source with one pass over the copy
+ *   full     compare every word, the original behaviour
+ *
+ * The copy itself can go through system_dma_memcpy, it falls back to
+ * system_memcpy when the platform has no dma engine or the transfer fails.
+ */
+
+#define ACAMERA_GDC_UPLOAD_SAMPLES 64
+
+typedef enum gdc_upload_verify {
+    GDC_UPLOAD_VERIFY_NONE = 0,
+    GDC_UPLOAD_VERIFY_SAMPLED,
+    GDC_UPLOAD_VERIFY_CRC,
+    GDC_UPLOAD_VERIFY_FULL,
+    GDC_UPLOAD_VERIFY_MAX
+} gdc_upload_verify_t;
+
+typedef struct gdc_upload {
+    gdc_upload_verify_t verify;
+    uint8_t use_dma;        //try system_dma_memcpy first, set when a dma channel was taken
+
+    uint32_t uploads;
+    uint32_t dma_copies;    //uploads copied by the dma engine
+    uint32_t failures;      //uploads that failed verification
+} gdc_upload_t;
+
+/**
+ *   Set up an uploader
+ *
+ *   @param  upload - uploader state
+ *   @param  verify - verification of every upload
+ *   @param  use_dma - 1 to copy with the dma engine when available
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int acamera_gdc_upload_init( gdc_upload_t *upload, gdc_upload_verify_t verify, uint8_t use_dma );
+
+/**
+ *   Release the dma channel of an uploader
+ *
+ *   @param  upload - uploader state
+ */
+void acamera_gdc_upload_deinit( gdc_upload_t *upload );
+
+/**
+ *   Copy a configuration sequence into ddr and verify it
+ *
+ *   A copy by the dma engine that fails verification is repeated with
+ *   system_memcpy once.
+ *
+ *   @param  upload - uploader state
+ *   @param  dst - destination in the ddr memory, 32 bit aligned
+ *   @param  src - sequence
+ *   @param  words - sequence size in 32 bit words
+ *
+ *   @return number of bytes written, 0 when verification failed
+ */
+uint32_t acamera_gdc_upload( gdc_upload_t *upload, uint32_t *dst, const uint32_t *src, uint32_t words );
+
+/**
+ *   Name of a verification mode, for logs and tools
+ */
+const char *acamera_gdc_upload_verify_name( gdc_upload_verify_t verify );
+
+#endif
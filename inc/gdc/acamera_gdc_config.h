@@ -500,7 +500,7 @@ static __inline void acamera_gdc_gdc_busy_write(uint32_t base, uint8_t data) {
     system_gdc_write_32(base+ACAMERA_GDC_GDC_BUSY_OFFSET, (((uint32_t) (data & ACAMERA_GDC_GDC_BUSY_MASK)) << 0) | (curr & (~ACAMERA_GDC_GDC_BUSY_MASK)));
 }
 static __inline uint8_t acamera_gdc_gdc_busy_read(uint32_t base) {
-    return (uint8_t)((system_gdc_read_32(0x208060L) & ACAMERA_GDC_GDC_BUSY_MASK) >> 0);
+    return (uint8_t)((system_gdc_read_32(base+ACAMERA_GDC_GDC_BUSY_OFFSET) & ACAMERA_GDC_GDC_BUSY_MASK) >> 0);
 }
 // ------------------------------------------------------------------------------ //
 // Register: error
@@ -518,10 +518,10 @@ static __inline uint8_t acamera_gdc_gdc_busy_read(uint32_t base) {
 // args: data (1-bit)
 static __inline void acamera_gdc_gdc_error_write(uint32_t base, uint8_t data) {
     uint32_t curr = system_gdc_read_32(base+ACAMERA_GDC_GDC_ERROR_OFFSET);
-    system_gdc_write_32(base+ACAMERA_GDC_GDC_ERROR_OFFSET, (((uint32_t) (data & 0x1)) << 1) | (curr & ACAMERA_GDC_GDC_ERROR_MASK));
+    system_gdc_write_32(base+ACAMERA_GDC_GDC_ERROR_OFFSET, (((uint32_t) (data & 0x1)) << 1) | (curr & (~ACAMERA_GDC_GDC_ERROR_MASK)));
 }
 static __inline uint8_t acamera_gdc_gdc_error_read(uint32_t base) {
-    return (uint8_t)((system_gdc_read_32(0x208060L) & ACAMERA_GDC_GDC_ERROR_MASK) >> 1);
+    return (uint8_t)((system_gdc_read_32(base+ACAMERA_GDC_GDC_ERROR_OFFSET) & ACAMERA_GDC_GDC_ERROR_MASK) >> 1);
 }
 // ------------------------------------------------------------------------------ //
 // Register: Reserved for future use 1
@@ -764,7 +764,7 @@ static __inline void acamera_gdc_gdc_reserved_for_future_use_3_write(uint32_t ba
 			(curr & (~ACAMERA_GDC_GDC_RESERVED_FOR_FUTURE_USE_3_MASK)));
 }
 static __inline uint32_t acamera_gdc_gdc_reserved_for_future_use_3_read(uint32_t base) {
-    return (uint32_t)((system_gdc_read_32(0x208064L) & ACAMERA_GDC_GDC_RESERVED_FOR_FUTURE_USE_3_MASK) >> ACAMERA_GDC_GDC_RESERVED_FOR_FUTURE_USE_3_DATA_SHIFT);
+    return (uint32_t)((system_gdc_read_32(base+ACAMERA_GDC_GDC_RESERVED_FOR_FUTURE_USE_3_OFFSET) & ACAMERA_GDC_GDC_RESERVED_FOR_FUTURE_USE_3_MASK) >> ACAMERA_GDC_GDC_RESERVED_FOR_FUTURE_USE_3_DATA_SHIFT);
 }
 // ------------------------------------------------------------------------------ //
 // Register: Capability mask
@@ -966,7 +966,7 @@ static __inline void acamera_gdc_gdc_bicubic_interpolation_supported_write(uint3
     system_gdc_write_32(base+ACAMERA_GDC_GDC_BICUBIC_INTERPOLATION_SUPPORTED_OFFSET, (((uint32_t) (data & 0x1)) << 8) | (curr & (~ACAMERA_GDC_GDC_BICUBIC_INTERPOLATION_SUPPORTED_MASK)));
 }
 static __inline uint8_t acamera_gdc_gdc_bicubic_interpolation_supported_read(uint32_t base) {
-    return (uint8_t)((system_gdc_read_32(0x208068L) & ACAMERA_GDC_GDC_BICUBIC_INTERPOLATION_SUPPORTED_MASK) >> 8);
+    return (uint8_t)((system_gdc_read_32(base+ACAMERA_GDC_GDC_BICUBIC_INTERPOLATION_SUPPORTED_OFFSET) & ACAMERA_GDC_GDC_BICUBIC_INTERPOLATION_SUPPORTED_MASK) >> 8);
 }
 // ------------------------------------------------------------------------------ //
 // Register: Bilinear interpolation mode 1 supported
@@ -0,0 +1,63 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __SYSTEM_DEBUGFS_H__
+#define __SYSTEM_DEBUGFS_H__
+
+#include "system_stdlib.h"
+
+/*
+ * Text files exporting driver state. The kernel creates them in <debugfs>/gdc,
+ * the host build keeps them in a list read back with system_debugfs_sim_read.
+ */
+
+//largest text a file shows
+#define SYSTEM_DEBUGFS_SIZE 4096
+
+//opaque file handle, allocated by system_debugfs_create
+typedef void *sys_debugfs;
+
+//writes the text of the file into buf and returns its length, at most size
+typedef uint32_t ( *system_debugfs_show_t )( void *param, char *buf, uint32_t size );
+
+//called when anything is written to the file
+typedef void ( *system_debugfs_clear_t )( void *param );
+
+/**
+ *   Create a text file
+ *
+ *   @param   file - filled with the new file
+ *   @param   name - file name
+ *   @param   show - produces the text of the file when it is read
+ *   @param   clear - called on a write, NULL makes the file read only
+ *   @param   param - passed to show and clear
+ *
+ *   @return  0 - success
+ *           -1 - on error
+ */
+int32_t system_debugfs_create( sys_debugfs *file, const char *name, system_debugfs_show_t show, system_debugfs_clear_t clear, void *param );
+
+/**
+ *   Remove a file created by system_debugfs_create
+ *
+ *   @param   file - file handle, NULL is ignored
+ */
+void system_debugfs_remove( sys_debugfs file );
+
+#endif // __SYSTEM_DEBUGFS_H__
@@ -0,0 +1,116 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __SYSTEM_DMA_ALLOC_H__
+#define __SYSTEM_DMA_ALLOC_H__
+
+#include "system_stdlib.h"
+
+/*
+ * Memory the gdc reads and writes: configuration sequences, input and output frames.
+ *
+ * Every allocation is physically contiguous, mapped for the cpu and placed
+ * below 4 GiB so the 32 bit address registers of the block reach it. The
+ * platform keeps track of the allocations and hands back the address the
+ * block uses, so the buffers need no fixed place in the memory map and only
+ * what is allocated is taken from other dma users.
+ */
+
+//opaque handle of an allocation
+typedef void *sys_dma_mem;
+
+/**
+ *   Set the device the memory is allocated for
+ *
+ *   The kernel platform takes the struct device of the gdc, a memory-region
+ *   of the device tree node becomes the pool the memory comes from. The host
+ *   platform ignores it.
+ *
+ *   @param  device - platform device
+ *
+ *   @return 0 - success
+ *           -1 - the device cannot address memory below 4 GiB.
+ */
+int32_t system_dma_alloc_init( void *device );
+
+/**
+ *   Drop the device once every allocation is freed
+ */
+void system_dma_alloc_deinit( void );
+
+/**
+ *   Allocate contiguous memory for the gdc
+ *
+ *   The memory is zeroed and aligned to a page.
+ *
+ *   @param  mem - filled with the handle of the allocation
+ *   @param  size - size in bytes
+ *   @param  virt - filled with the cpu address
+ *   @param  addr - filled with the gdc address
+ *
+ *   @return 0 - success
+ *           -1 - out of memory.
+ */
+int32_t system_dma_alloc( sys_dma_mem *mem, uint32_t size, void **virt, uint32_t *addr );
+
+/**
+ *   Free memory allocated by system_dma_alloc
+ *
+ *   @param  mem - handle of the allocation, NULL is ignored
+ */
+void system_dma_free( sys_dma_mem mem );
+
+/**
+ *   Find the allocation holding a range of gdc addresses
+ *
+ *   @param  addr - gdc address of the range
+ *   @param  size - size of the range in bytes
+ *   @param  virt - filled with the cpu address of addr
+ *
+ *   @return 0 - success
+ *           -1 - the range is not inside one allocation.
+ */
+int32_t system_dma_alloc_lookup( uint32_t addr, uint32_t size, void **virt );
+
+/**
+ *   Find the whole allocation holding a range of gdc addresses
+ *
+ *   The dma api maps and describes only whole allocations, a range inside
+ *   one is an offset into what this returns.
+ *
+ *   @param  addr - gdc address of the range
+ *   @param  size - size of the range in bytes
+ *   @param  base_virt - filled with the cpu address of the allocation
+ *   @param  base_addr - filled with the gdc address of the allocation
+ *   @param  base_size - filled with the size of the allocation in bytes
+ *
+ *   @return 0 - success
+ *           -1 - the range is not inside one allocation.
+ */
+int32_t system_dma_alloc_find( uint32_t addr, uint32_t size, void **base_virt, uint32_t *base_addr, uint32_t *base_size );
+
+/**
+ *   Allocations currently held
+ *
+ *   @param  count - filled with the number of allocations
+ *   @param  bytes - filled with their total size
+ */
+void system_dma_alloc_usage( uint32_t *count, uint32_t *bytes );
+
+#endif // __SYSTEM_DMA_ALLOC_H__
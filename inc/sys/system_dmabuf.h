@@ -0,0 +1,91 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __SYSTEM_DMABUF_H__
+#define __SYSTEM_DMABUF_H__
+
+#include "system_stdlib.h"
+
+/*
+ * Buffers shared with other devices through dma-buf file descriptors.
+ *
+ * An imported buffer is attached to the gdc device and mapped for its dma,
+ * the gdc address of the mapping goes into the plane address registers. The
+ * block addresses planes with 32 bit registers and no scatter list, so the
+ * mapping must be contiguous and below 4 GiB. An exported buffer is a range
+ * of the gdc memory that other devices map and the cpu can mmap.
+ */
+
+//opaque handle of an imported buffer
+typedef void *sys_dmabuf;
+
+/**
+ *   Set the device the buffers are attached to
+ *
+ *   The kernel platform takes the struct device of the gdc, the host platform
+ *   ignores it.
+ *
+ *   @param  device - platform device, NULL keeps the current one
+ */
+void system_dmabuf_init( void *device );
+
+/**
+ *   Attach to a dma-buf and map it for the gdc
+ *
+ *   @param  buf - filled with the handle of the import
+ *   @param  fd - dma-buf file descriptor, it may be closed once imported
+ *   @param  write - 1 when the gdc writes the buffer, 0 when it reads it
+ *   @param  addr - filled with the gdc address of the buffer
+ *   @param  size - filled with the size of the buffer in bytes
+ *
+ *   @return 0 - success
+ *           -1 - not a dma-buf, the device cannot map it or the mapping is not contiguous below 4 GiB.
+ */
+int32_t system_dmabuf_import( sys_dmabuf *buf, int fd, int write, uint32_t *addr, uint32_t *size );
+
+/**
+ *   Unmap, detach and drop a buffer imported by system_dmabuf_import
+ *
+ *   The gdc must not access the buffer anymore. Unmapping may sleep, called
+ *   from interrupt or timer context the release is left to a worker.
+ *
+ *   @param  buf - handle of the import, NULL is ignored
+ */
+void system_dmabuf_release( sys_dmabuf buf );
+
+/**
+ *   Wait for the releases left to the worker
+ */
+void system_dmabuf_flush( void );
+
+/**
+ *   Export a range of the gdc memory as a dma-buf
+ *
+ *   The memory stays owned by the driver, the buffer only lends it out.
+ *
+ *   @param  addr - gdc address of the range
+ *   @param  size - size of the range in bytes
+ *   @param  fd - filled with the new file descriptor
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int32_t system_dmabuf_export( uint32_t addr, uint32_t size, int *fd );
+
+#endif // __SYSTEM_DMABUF_H__
@@ -0,0 +1,138 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __SYSTEM_FENCE_H__
+#define __SYSTEM_FENCE_H__
+
+#include "system_stdlib.h"
+
+/*
+ * Fences shared with other devices through sync_file descriptors.
+ *
+ * An in-fence is signalled by the producer of an input frame, a job waits
+ * for it before the gdc starts. An out-fence is created by the driver for a
+ * job and signalled once the frame is written, consumers wait on it instead
+ * of a callback from the driver.
+ */
+
+//opaque handle of a fence reference
+typedef void *sys_fence;
+
+//called once a fence has signalled, in a worker thread of the platform
+typedef void ( *system_fence_handler_t )( void *param );
+
+/**
+ *   Take a reference to the fence of a sync_file
+ *
+ *   @param  fence - filled with the handle
+ *   @param  fd - sync_file descriptor, it may be closed once imported
+ *
+ *   @return 0 - success
+ *           -1 - not a sync_file.
+ */
+int32_t system_fence_import( sys_fence *fence, int fd );
+
+/**
+ *   Create an unsignalled fence
+ *
+ *   @param  fence - filled with the handle
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int32_t system_fence_create( sys_fence *fence );
+
+/**
+ *   Take another reference to a fence
+ *
+ *   @param  fence - handle of the fence
+ *   @param  dup - filled with a new handle of the same fence
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int32_t system_fence_dup( sys_fence fence, sys_fence *dup );
+
+/**
+ *   Install a sync_file descriptor for a fence
+ *
+ *   The descriptor holds its own reference, the handle stays valid.
+ *
+ *   @param  fence - handle of the fence
+ *   @param  fd - filled with the descriptor
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int32_t system_fence_export( sys_fence fence, int *fd );
+
+/**
+ *   Signal a fence created by system_fence_create
+ *
+ *   May be called from interrupt context.
+ *
+ *   @param  fence - handle of the fence
+ *   @param  error - 0 for success, 1 when the work behind the fence failed
+ */
+void system_fence_signal( sys_fence fence, int error );
+
+/**
+ *   State of a fence
+ *
+ *   May be called from interrupt context.
+ *
+ *   @param  fence - handle of the fence
+ *
+ *   @return 0 - not signalled yet
+ *           1 - signalled
+ *           -1 - signalled with an error.
+ */
+int32_t system_fence_status( sys_fence fence );
+
+/**
+ *   Call a handler once the fence signals
+ *
+ *   One handler per handle. The handler is not called when the fence has
+ *   already signalled or the handle is dropped first.
+ *
+ *   @param  fence - handle of the fence
+ *   @param  handler - called in a worker thread
+ *   @param  param - passed to the handler
+ *
+ *   @return 0 - the handler will be called
+ *           -1 - the fence has signalled already.
+ */
+int32_t system_fence_notify( sys_fence fence, system_fence_handler_t handler, void *param );
+
+/**
+ *   Drop a fence reference
+ *
+ *   A pending handler is cancelled. From interrupt context the reference is
+ *   dropped by a worker.
+ *
+ *   @param  fence - handle of the fence, NULL is ignored
+ */
+void system_fence_put( sys_fence fence );
+
+/**
+ *   Wait for the fence references dropped by the worker and the running handlers
+ */
+void system_fence_flush( void );
+
+#endif // __SYSTEM_FENCE_H__
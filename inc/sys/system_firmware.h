@@ -0,0 +1,64 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __SYSTEM_FIRMWARE_H__
+#define __SYSTEM_FIRMWARE_H__
+
+#include "system_stdlib.h"
+
+// firmware file loaded by the platform
+typedef struct system_firmware {
+    const void *data;   //file contents, 32 bit aligned
+    uint32_t size;      //file size in bytes
+    void *priv;         //platform handle, released by system_firmware_release
+} system_firmware_t;
+
+/**
+ *   Set the platform context used to look up firmware files
+ *
+ *   The kernel platform takes the struct device passed to request_firmware,
+ *   the host platform takes the directory holding the firmware files.
+ *
+ *   @param  context - platform context, NULL keeps the default
+ *
+ *   @return none
+ */
+void system_firmware_init( void *context );
+
+/**
+ *   Load a firmware file
+ *
+ *   @param  fw - filled with the file contents on success
+ *   @param  name - file name relative to the firmware search path
+ *
+ *   @return 0 - success
+ *           -1 - file not found or cannot be read.
+ */
+int32_t system_firmware_request( system_firmware_t *fw, const char *name );
+
+/**
+ *   Release a firmware file loaded by system_firmware_request
+ *
+ *   @param  fw - firmware to release
+ *
+ *   @return none
+ */
+void system_firmware_release( system_firmware_t *fw );
+
+#endif // __SYSTEM_FIRMWARE_H__
@@ -22,6 +22,97 @@
 
 #include "system_stdlib.h"
 
+//offsets in gdc memory carry the io instance in their top bits, see SYSTEM_GDC_IO_BASE
+#define SYSTEM_GDC_IO_MAX_INSTANCES 4
+#define SYSTEM_GDC_IO_INSTANCE_SHIFT 24
+#define SYSTEM_GDC_IO_OFFSET_MASK ( ( 1U << SYSTEM_GDC_IO_INSTANCE_SHIFT ) - 1 )
+#define SYSTEM_GDC_IO_BASE( instance ) ( (uint32_t)( instance ) << SYSTEM_GDC_IO_INSTANCE_SHIFT )
+#define SYSTEM_GDC_IO_INSTANCE( addr ) ( (uint32_t)( addr ) >> SYSTEM_GDC_IO_INSTANCE_SHIFT )
+
+//gdc cores behind the register window of one instance
+#define SYSTEM_GDC_IO_MAX_CORES 2
+
+// one probed gdc device
+typedef struct system_gdc_io_ctx {
+    void *hw_base;          //mapped registers, NULL while the instance is closed
+    uint32_t hw_size;
+    void *ddr_base;         //mapped ddr window of the device, NULL when it has none
+    phys_addr_t ddr_phys;
+    uint32_t ddr_size;
+    uint32_t num_cores;     //cores at GDC_CORE_BASE_STRIDE steps from the start of the window
+    uint32_t first_core;    //driver wide number of core 0, also its interrupt id
+    int irq[SYSTEM_GDC_IO_MAX_CORES];
+    int irq_flags[SYSTEM_GDC_IO_MAX_CORES];
+} system_gdc_io_ctx_t;
+
+// one entry of a register list
+typedef struct system_gdc_reg_write {
+    uint32_t addr;  //offset in GDC memory
+    uint32_t data;
+} system_gdc_reg_write_t;
+
+
+/**
+ *   Map the registers of a gdc device
+ *
+ *   The registers are then reached at SYSTEM_GDC_IO_BASE( instance ) + offset.
+ *   Instances are opened in order, the cores of an instance are numbered after
+ *   the cores of the instances before it.
+ *
+ *   @param instance - io instance 0..SYSTEM_GDC_IO_MAX_INSTANCES-1
+ *   @param addr - physical address of the register window
+ *   @param size - size of the register window
+ *   @param num_cores - gdc cores in the window
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int32_t system_gdc_io_open( uint32_t instance, resource_size_t addr, resource_size_t size, uint32_t num_cores );
+
+
+/**
+ *   Map the ddr window a gdc device reads and writes
+ *
+ *   @param instance - opened io instance
+ *   @param addr - physical address of the window
+ *   @param size - size of the window
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int32_t system_gdc_io_map_ddr( uint32_t instance, phys_addr_t addr, uint32_t size );
+
+
+/**
+ *   Unmap the registers and the ddr window of an instance
+ *
+ *   @param instance - io instance
+ */
+void system_gdc_io_close( uint32_t instance );
+
+
+/**
+ *   Context of an io instance
+ *
+ *   @param instance - io instance
+ *
+ *   @return the context, NULL when the instance is not opened
+ */
+system_gdc_io_ctx_t *system_gdc_io_get( uint32_t instance );
+
+
+/**
+ *   Locate a gdc core
+ *
+ *   @param core - driver wide core number
+ *   @param base - filled with the register base of the core for the accessors
+ *   @param ddr - filled with the ddr window of its device, NULL when it has none
+ *
+ *   @return 0 - success
+ *           -1 - no opened instance holds the core.
+ */
+int32_t system_gdc_io_core( uint32_t core, uint32_t *base, void **ddr );
+
 
 /**
  *   Read 32 bit word from gdc memory
@@ -46,4 +137,69 @@ uint32_t system_gdc_read_32( uint32_t addr );
 void system_gdc_write_32( uint32_t addr, uint32_t data );
 
 
+/**
+ *   Write 32 bits word to gdc memory without ordering
+ *
+ *   The write may reach the block after later writes of other registers, use
+ *   system_gdc_write_barrier before a write that depends on it.
+ *
+ *   @param addr - the offset in GDC memory to write data.
+ *   @param data - data to be written
+ */
+void system_gdc_write_32_relaxed( uint32_t addr, uint32_t data );
+
+
+/**
+ *   Order all previous gdc writes before the following ones
+ */
+void system_gdc_write_barrier( void );
+
+
+/**
+ *   Write a list of registers in order
+ *
+ *   Platforms with a register list dma engine hand the list to it, the others
+ *   write the registers back to back. With GDC_RELAXED_MMIO the writes are not
+ *   ordered, call system_gdc_write_barrier before starting the block.
+ *
+ *   @param list - registers and values
+ *   @param count - number of entries
+ */
+void system_gdc_write_list( const system_gdc_reg_write_t *list, uint32_t count );
+
+
+/**
+ *   Keep a shadow copy of a register window
+ *
+ *   Once software has written a register of the window its reads are served from
+ *   the copy, so the read of a read-modify-write field update does not reach the bus.
+ *   Registers the hardware changes must be excluded with system_gdc_shadow_volatile.
+ *   Adding a window again drops its copy. Windows are added and removed while the
+ *   block is idle.
+ *
+ *   @param addr - offset of the window in GDC memory
+ *   @param size - size of the window in bytes
+ *
+ *   @return 0 - success
+ *           -1 - no shadow space left.
+ */
+int32_t system_gdc_shadow_add( uint32_t addr, uint32_t size );
+
+
+/**
+ *   Stop shadowing the window added at addr
+ *
+ *   @param addr - offset the window was added with
+ */
+void system_gdc_shadow_remove( uint32_t addr );
+
+
+/**
+ *   Read and write a register of a shadowed window always on the bus
+ *
+ *   @param addr - offset of the register in GDC memory
+ */
+void system_gdc_shadow_volatile( uint32_t addr );
+
+
 #endif /* __SYSTEM_GDC_IO_H__ */
@@ -0,0 +1,126 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __SYSTEM_GDC_TRACE_H__
+#define __SYSTEM_GDC_TRACE_H__
+
+#include "acamera_driver_config.h"
+#include "system_stdlib.h"
+
+/*
+ * Recorder of the gdc register accesses, built with GDC_MMIO_TRACE.
+ *
+ * Every access of the io layer is timestamped into a ring of
+ * SYSTEM_GDC_TRACE_SIZE records, the oldest records are overwritten. Writers
+ * only take a slot with an atomic increment, so the recorder can be used from
+ * the interrupt handler and from several cores at once. The kernel exports the
+ * ring as text in <debugfs>/gdc/mmio_trace, writing to the file clears it. The
+ * host build saves it with system_gdc_trace_save. One access per line:
+ *
+ *   <time ns> <duration ns> <op> <addr> <data> <caller>
+ *
+ * op is R read, S read served by the shadow copy, W write, w relaxed write or
+ * B write barrier. host/tools/gdc_mmio_trace summarizes and replays the text.
+ */
+
+//records in the ring, power of two
+#define SYSTEM_GDC_TRACE_SIZE ( 1 << 16 )
+
+#define SYSTEM_GDC_TRACE_READ 'R'
+#define SYSTEM_GDC_TRACE_SHADOW 'S'
+#define SYSTEM_GDC_TRACE_WRITE 'W'
+#define SYSTEM_GDC_TRACE_WRITE_RELAXED 'w'
+#define SYSTEM_GDC_TRACE_BARRIER 'B'
+
+typedef struct system_gdc_trace_record {
+    u64 time;          //ns when the access started
+    uint32_t duration;      //ns the access took
+    uint32_t addr;
+    uint32_t data;
+    uint32_t op;            //SYSTEM_GDC_TRACE_*
+    const void *caller;     //return address of the io function
+    uint32_t seq;           //index of the record + 1 once it is complete, 0 while it is written
+} system_gdc_trace_record_t;
+
+/**
+ *   Allocate the ring and start recording
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int32_t system_gdc_trace_init( void );
+
+/**
+ *   Stop recording and release the ring
+ */
+void system_gdc_trace_deinit( void );
+
+/**
+ *   Timestamp for system_gdc_trace_add
+ *
+ *   @return monotonic time in ns
+ */
+u64 system_gdc_trace_time( void );
+
+/**
+ *   Record an access, does nothing before system_gdc_trace_init
+ *
+ *   @param op - SYSTEM_GDC_TRACE_*
+ *   @param addr - offset in GDC memory
+ *   @param data - value read or written
+ *   @param start - system_gdc_trace_time before the access
+ *   @param caller - code that issued the access
+ */
+void system_gdc_trace_add( uint32_t op, uint32_t addr, uint32_t data, u64 start, const void *caller );
+
+/**
+ *   Copy a record out of the ring
+ *
+ *   @param index - record number, see system_gdc_trace_range
+ *   @param record - copy of the record
+ *
+ *   @return 0 - success
+ *           -1 - the record was overwritten or is still being written.
+ */
+int32_t system_gdc_trace_get( uint32_t index, system_gdc_trace_record_t *record );
+
+/**
+ *   Range of the records held by the ring
+ *
+ *   @param first - number of the oldest record still in the ring
+ *
+ *   @return number of the next record, the ring holds first up to this minus one
+ */
+uint32_t system_gdc_trace_range( uint32_t *first );
+
+/**
+ *   Drop the recorded accesses
+ */
+void system_gdc_trace_clear( void );
+
+//hooks of the io layer, compiled out without GDC_MMIO_TRACE
+#if GDC_MMIO_TRACE
+#define SYSTEM_GDC_TRACE_START( t ) u64 t = system_gdc_trace_time()
+#define SYSTEM_GDC_TRACE( op, addr, data, t ) system_gdc_trace_add( op, addr, data, t, __builtin_return_address( 0 ) )
+#else
+#define SYSTEM_GDC_TRACE_START( t )
+#define SYSTEM_GDC_TRACE( op, addr, data, t )
+#endif
+
+#endif /* __SYSTEM_GDC_TRACE_H__ */
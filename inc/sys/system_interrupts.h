@@ -58,6 +58,22 @@ void system_interrupts_deinit( int id );
  */
 void system_interrupt_set_handler( int id, system_interrupt_handler_t handler, void *param );
 
+/**
+ *   Set a threaded interrupt handler
+ *
+ *   The handler set with system_interrupt_set_handler runs first, in interrupt context.
+ *   This one runs afterwards in a thread where it may take longer and sleep. Interrupts
+ *   raised while the thread runs wake it only once more, so it must handle everything
+ *   the interrupt handler left for it.
+ *
+ *   @param
+ *          handler - a callback to finish the interrupts, NULL to run only the interrupt handler
+ *          param - pointer to a context which must be send to the threaded handler
+ *
+ *   @return none
+ */
+void system_interrupt_set_thread_handler( int id, system_interrupt_handler_t handler, void *param );
+
 /**
  *   Set IRQ number
  *
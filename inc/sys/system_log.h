@@ -43,9 +43,9 @@ enum {
 #endif
 extern const char *const log_level[LOG_MAX];
 
-#define FILE ( strrchr( __FILE__, '/' ) ? strrchr( __FILE__, '/' ) + 1 : __FILE__ )
+#define LOG_FILE ( strrchr( __FILE__, '/' ) ? strrchr( __FILE__, '/' ) + 1 : __FILE__ )
 
 #define LOG( level, fmt, ... ) \
-    if ( ( level ) <= FW_LOG_LEVEL ) printf( "%s: %s(%d) %s: " fmt "\n", FILE, __func__, __LINE__, log_level[level], ##__VA_ARGS__ )
+    if ( ( level ) <= FW_LOG_LEVEL ) printf( "%s: %s(%d) %s: " fmt "\n", LOG_FILE, __func__, __LINE__, log_level[level], ##__VA_ARGS__ )
 
 #endif // __SYSTEM_LOG_H__
@@ -0,0 +1,65 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+
+#ifndef __SYSTEM_SPINLOCK_H__
+#define __SYSTEM_SPINLOCK_H__
+
+#include "system_stdlib.h"
+
+//opaque lock handle, allocated by system_spinlock_init
+typedef void *sys_spinlock;
+
+/**
+ *   Create a spinlock
+ *
+ *   The lock may be taken from process context and from the interrupt handler.
+ *
+ *   @param   lock - filled with the new lock
+ *
+ *   @return  0 - success
+ *           -1 - on error
+ */
+int32_t system_spinlock_init( sys_spinlock *lock );
+
+/**
+ *   Take a spinlock and disable local interrupts
+ *
+ *   @param   lock - lock from system_spinlock_init
+ *
+ *   @return  saved interrupt state for system_spinlock_unlock
+ */
+unsigned long system_spinlock_lock( sys_spinlock lock );
+
+/**
+ *   Release a spinlock and restore local interrupts
+ *
+ *   @param   lock - lock from system_spinlock_init
+ *   @param   flags - value returned by system_spinlock_lock
+ */
+void system_spinlock_unlock( sys_spinlock lock, unsigned long flags );
+
+/**
+ *   Free a spinlock
+ *
+ *   @param   lock - lock from system_spinlock_init
+ */
+void system_spinlock_destroy( sys_spinlock lock );
+
+#endif // __SYSTEM_SPINLOCK_H__
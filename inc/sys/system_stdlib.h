@@ -28,11 +28,14 @@
 #undef NULL
 #define NULL ((void *)0)
 
+typedef signed char int8_t;
+typedef short int16_t;
 typedef int int32_t;
 typedef unsigned short uint16_t;
 typedef unsigned int uint32_t;
 typedef unsigned char uint8_t;
 typedef unsigned long long u64;
+typedef unsigned long uintptr_t;
 typedef u64 phys_addr_t;
 typedef phys_addr_t resource_size_t;
 //#include <asm/string.h>
@@ -78,4 +81,71 @@ int32_t system_memcpy( void *dst, const void *src, uint32_t size );
 
 int32_t system_memset( void *ptr, uint8_t value, uint32_t size );
 
+
+/**
+ *   Take a dma engine channel for system_dma_memcpy
+ *
+ *   The channel is kept until the last user calls system_dma_memcpy_deinit.
+ *
+ *   @return  0 - success
+ *           -1 - no dma engine, system_dma_memcpy always fails
+ */
+int32_t system_dma_memcpy_init( void );
+
+/**
+ *   Release the channel taken by system_dma_memcpy_init
+ */
+void system_dma_memcpy_deinit( void );
+
+/**
+ *   Copy block of memory into gdc memory with a dma engine
+ *
+ *   The destination must lie inside one allocation of system_dma_alloc, the
+ *   source is read in place. Needs system_dma_memcpy_init. The call sleeps
+ *   until the transfer has completed.
+ *
+ *   @param   dst - cpu address inside an allocation
+ *   @param   src - pointer to source of data to be copied
+ *   @param   size - number of bytes to copy
+ *
+ *   @return  0 - success
+ *           -1 - no dma engine or the transfer failed, the caller copies with system_memcpy
+ */
+
+int32_t system_dma_memcpy( void *dst, const void *src, uint32_t size );
+
+
+/**
+ *   Update a crc-32 (ieee 802.3) with a block of memory
+ *
+ *   @param   crc - crc of the preceding data, 0 for the first block
+ *   @param   data - pointer to the block
+ *   @param   size - number of bytes in the block
+ *
+ *   @return  updated crc
+ */
+
+uint32_t system_crc32( uint32_t crc, const void *data, uint32_t size );
+
+
+/**
+ *   Monotonic time
+ *
+ *   @return  time in nanoseconds
+ */
+
+u64 system_time_ns( void );
+
+
+/**
+ *   Wait for some time
+ *
+ *   Waits of a few microseconds spin, longer ones sleep on a high resolution
+ *   timer, so the caller must be allowed to sleep.
+ *
+ *   @param   ns - time to wait in nanoseconds
+ */
+
+void system_sleep_ns( u64 ns );
+
 #endif // __SYSTEM_STDLIB_H__
@@ -0,0 +1,82 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __SYSTEM_TIMER_H__
+#define __SYSTEM_TIMER_H__
+
+#include "system_stdlib.h"
+
+//opaque timer handle, allocated by system_timer_init
+typedef void *sys_timer;
+
+//timer callback, runs in interrupt context
+typedef void ( *system_timer_handler_t )( void *param );
+
+/**
+ *   Create a one shot timer
+ *
+ *   @param   timer - filled with the new timer
+ *   @param   handler - called when the timer expires, NULL when only a thread handler is used
+ *   @param   param - passed to the handler
+ *
+ *   @return  0 - success
+ *           -1 - on error
+ */
+int32_t system_timer_init( sys_timer *timer, system_timer_handler_t handler, void *param );
+
+/**
+ *   Set a handler finishing the expiry in a thread
+ *
+ *   The handler given to system_timer_init runs first, in interrupt context, and
+ *   should only record what is due. This one runs afterwards from a work item where
+ *   it may take longer. Expiries while it runs wake it only once more.
+ *
+ *   @param   timer - timer from system_timer_init
+ *   @param   handler - called after every expiry, NULL to run only the first handler
+ */
+void system_timer_set_thread_handler( sys_timer timer, system_timer_handler_t handler );
+
+/**
+ *   Start the timer or move its expiry
+ *
+ *   May be called from the handler of the timer.
+ *
+ *   @param   timer - timer from system_timer_init
+ *   @param   timeout_ns - time from now until the handler runs
+ */
+void system_timer_arm( sys_timer timer, u64 timeout_ns );
+
+/**
+ *   Stop the timer without waiting for a running handler
+ *
+ *   May be called from the handlers of the timer. A handler already running
+ *   still completes, so it must check whether its work is still due.
+ *
+ *   @param   timer - timer from system_timer_init
+ */
+void system_timer_cancel( sys_timer timer );
+
+/**
+ *   Stop the timer, wait for its handlers and free it
+ *
+ *   @param   timer - timer from system_timer_init
+ */
+void system_timer_destroy( sys_timer timer );
+
+#endif // __SYSTEM_TIMER_H__
@@ -23,6 +23,104 @@
 #if HAS_FPGA_WRAPPER
 #include "acamera_fpga_config.h"
 #include "acamera_fpga.h"
+#include "system_spinlock.h"
+#include "system_log.h"
+
+//frame buffers the dma writers cycle through, each hardware bank points at one of them
+static struct {
+    uint32_t num_planes;
+    uint32_t num_buffers;
+    uint32_t num_banks;
+    uint32_t addr[ACAMERA_FPGA_RING_MAX_BUFFERS][ACAMERA_FPGA_MAX_PLANES];
+    uint32_t lineoffset[ACAMERA_FPGA_MAX_PLANES];
+    uint8_t owner[ACAMERA_FPGA_RING_MAX_BUFFERS]; //frames of the gdc still reading the buffer
+    uint8_t bank[ACAMERA_FPGA_MAX_BANKS];         //buffer behind each bank
+    uint8_t held;                                 //writes are cancelled, every buffer is busy
+    uint8_t seen_curr;                            //write bank seen last, a change is the start of a frame
+    uint8_t starts;                               //frame starts seen since init, up to 2
+    sys_spinlock lock;
+} fpga_ring;
+
+//point a bank of both writers at a buffer
+static void fpga_bank_write( uint32_t bank, uint32_t buffer )
+{
+    uint32_t base = 0;
+    uint32_t y = fpga_ring.addr[buffer][0];
+    uint32_t uv = fpga_ring.addr[buffer][1];
+
+    switch ( bank ) {
+    case 0:
+        acamera_fpga_fr_dma_writer_bank0_base_write( base, y );
+        acamera_fpga_fruv_dma_writer_bank0_base_write( base, uv );
+        break;
+    case 1:
+        acamera_fpga_fr_dma_writer_bank1_base_write( base, y );
+        acamera_fpga_fruv_dma_writer_bank1_base_write( base, uv );
+        break;
+    case 2:
+        acamera_fpga_fr_dma_writer_bank2_base_write( base, y );
+        acamera_fpga_fruv_dma_writer_bank2_base_write( base, uv );
+        break;
+    case 3:
+        acamera_fpga_fr_dma_writer_bank3_base_write( base, y );
+        acamera_fpga_fruv_dma_writer_bank3_base_write( base, uv );
+        break;
+    default:
+        acamera_fpga_fr_dma_writer_bank4_base_write( base, y );
+        acamera_fpga_fruv_dma_writer_bank4_base_write( base, uv );
+        break;
+    }
+}
+
+//buffer neither read by the gdc, being written nor holding the last frame, one no bank points at is preferred
+static int fpga_ring_spare( uint32_t curr, uint32_t last )
+{
+    int spare = -1;
+    uint32_t i, b;
+
+    for ( i = 0; i < fpga_ring.num_buffers; i++ ) {
+        if ( fpga_ring.owner[i] || i == fpga_ring.bank[curr] || i == fpga_ring.bank[last] )
+            continue;
+        for ( b = 0; b < fpga_ring.num_banks && fpga_ring.bank[b] != i; b++ )
+            ;
+        if ( b == fpga_ring.num_banks )
+            return i;
+        if ( spare < 0 )
+            spare = i;
+    }
+    return spare;
+}
+
+//the banks the writer goes to next must not point at a buffer the gdc reads,
+//they are moved to a spare buffer and the writes are held while there is none
+static void fpga_ring_update( void )
+{
+    uint32_t base = 0;
+    uint32_t curr = acamera_fpga_fr_dma_writer_wbank_curr_read( base ) % fpga_ring.num_banks;
+    uint32_t last = acamera_fpga_fr_dma_writer_wbank_last_read( base ) % fpga_ring.num_banks;
+    uint32_t b;
+    uint8_t hold = 0;
+
+    for ( b = 0; b < fpga_ring.num_banks; b++ ) {
+        int spare;
+        if ( b == curr || !fpga_ring.owner[fpga_ring.bank[b]] )
+            continue;
+        spare = fpga_ring_spare( curr, last );
+        if ( spare < 0 ) {
+            hold = 1;
+            continue;
+        }
+        fpga_ring.bank[b] = spare;
+        fpga_bank_write( b, spare );
+    }
+    if ( hold != fpga_ring.held ) {
+        if ( hold )
+            LOG( LOG_WARNING, "All %u fpga writer buffers are busy, capture is held", fpga_ring.num_buffers );
+        acamera_fpga_fr_dma_writer_frame_write_cancel_write( base, hold );
+        acamera_fpga_fruv_dma_writer_frame_write_cancel_write( base, hold );
+        fpga_ring.held = hold;
+    }
+}
 
 /**
  *   FPGA initialization with resolution and y and uv planar addresses
@@ -31,12 +129,32 @@
  *   @return 0 - success
  *           -1 - fail.
  */
-int acamera_fpga_init( uint32_t active_width, uint32_t active_height,uint32_t total_input,uint32_t * in_addr,uint32_t * in_lineoffset )
+int acamera_fpga_init( uint32_t active_width, uint32_t active_height,uint32_t total_input,uint32_t * in_addr,uint32_t * in_lineoffset,uint32_t num_buffers,uint32_t buffer_size )
 {
-    if ( active_width == 0 || active_height == 0 || total_input == 0)
+    if ( active_width == 0 || active_height == 0 || total_input == 0 || total_input > ACAMERA_FPGA_MAX_PLANES ||
+         num_buffers < 2 || num_buffers > ACAMERA_FPGA_RING_MAX_BUFFERS )
         return -1;
 
     uint32_t base =0;
+    uint32_t i, p;
+    if ( fpga_ring.lock == NULL && system_spinlock_init( &fpga_ring.lock ) != 0 )
+        return -1;
+    fpga_ring.num_planes = total_input;
+    fpga_ring.num_buffers = num_buffers;
+    fpga_ring.num_banks = num_buffers < ACAMERA_FPGA_MAX_BANKS ? num_buffers : ACAMERA_FPGA_MAX_BANKS;
+    fpga_ring.held = 0;
+    for ( i = 0; i < num_buffers; i++ ) {
+        fpga_ring.owner[i] = 0;
+        for ( p = 0; p < total_input; p++ )
+            fpga_ring.addr[i][p] = in_addr[p] + i * buffer_size;
+    }
+    //the writers cover two planes, a third plane uses the line offset of the second
+    for ( p = 0; p < total_input; p++ )
+        fpga_ring.lineoffset[p] = in_lineoffset[p < 2 ? p : 1];
+
+    //the fpga registers are only changed by software, keep a copy for the field updates
+    system_gdc_shadow_add( ACAMERA_FPGA_BASE_ADDR, ACAMERA_FPGA_SIZE );
+
     //configure fpga reader from here
     acamera_fpga_frame_reader_format_write( base, 13 );
 
@@ -53,11 +171,9 @@ int acamera_fpga_init( uint32_t active_width, uint32_t active_height,uint32_t to
     acamera_fpga_fr_dma_writer_active_width_write( base, active_width );
     acamera_fpga_fr_dma_writer_active_height_write( base, active_height );
 
-    //acamera_fpga_fr_dma_writer_bank0_base_write( base, y_base_addr );
-    acamera_fpga_fr_dma_writer_bank0_base_write( base, in_addr[0] );
     //acamera_fpga_fr_dma_writer_line_offset_write( base, y_line_offset );
     acamera_fpga_fr_dma_writer_line_offset_write( base, in_lineoffset[0] );
-    acamera_fpga_fr_dma_writer_max_bank_write(base,0);
+    acamera_fpga_fr_dma_writer_frame_write_cancel_write( base, 0 );
 
     if(total_input>=2){
 		acamera_fpga_frame_reader_uv_format_write( base, 77 );
@@ -77,16 +193,46 @@ int acamera_fpga_init( uint32_t active_width, uint32_t active_height,uint32_t to
 		acamera_fpga_fruv_dma_writer_active_width_write( base, active_width );
 		acamera_fpga_fruv_dma_writer_active_height_write( base, active_height );
 
-		//acamera_fpga_fruv_dma_writer_bank0_base_write( base, uv_base_addr );
-		acamera_fpga_fruv_dma_writer_bank0_base_write( base, in_addr[1] );
 		//acamera_fpga_fruv_dma_writer_line_offset_write( base, uv_line_offset );
 		acamera_fpga_fruv_dma_writer_line_offset_write( base, in_lineoffset[1] );
-		acamera_fpga_fruv_dma_writer_max_bank_write(base,0);
+		acamera_fpga_fruv_dma_writer_frame_write_cancel_write( base, 0 );
+    } else {
+        //the uv writer follows the y writer through the banks, keep it on the y buffers
+        for ( i = 0; i < num_buffers; i++ )
+            fpga_ring.addr[i][1] = fpga_ring.addr[i][0];
+    }
+
+    //the writers cycle through the banks, bank b starts on buffer b
+    for ( i = 0; i < fpga_ring.num_banks; i++ ) {
+        fpga_ring.bank[i] = i;
+        fpga_bank_write( i, i );
     }
+    acamera_fpga_fr_dma_writer_max_bank_write( base, fpga_ring.num_banks - 1 );
+    if ( total_input >= 2 )
+        acamera_fpga_fruv_dma_writer_max_bank_write( base, fpga_ring.num_banks - 1 );
+    //the buffers hold nothing yet, frames are handed out once the writers went through a bank
+    fpga_ring.seen_curr = acamera_fpga_fr_dma_writer_wbank_curr_read( base ) % fpga_ring.num_banks;
+    fpga_ring.starts = 0;
 
     return 0;
 }
 
+/**
+ *   Stop the dma writers and release the ring
+ *
+ */
+void acamera_fpga_deinit( void )
+{
+    uint32_t base = 0;
+
+    acamera_fpga_fr_dma_writer_frame_write_cancel_write( base, 1 );
+    acamera_fpga_fruv_dma_writer_frame_write_cancel_write( base, 1 );
+    if ( fpga_ring.lock ) {
+        system_spinlock_destroy( fpga_ring.lock );
+    }
+    system_memset( &fpga_ring, 0, sizeof( fpga_ring ) );
+}
+
 
 /**
  *   Update frame reader yuv address and the line offsets
@@ -114,7 +260,7 @@ void acamera_fpga_update_frame_reader(  uint32_t total_input, uint32_t * out_add
 
 
 /**
- *   Get the recent frame writer settings
+ *   Take the last frame written by the dma writers
  *
  *   @return 0 - success
  *           -1 - fail.
@@ -123,17 +269,77 @@ void acamera_fpga_update_frame_reader(  uint32_t total_input, uint32_t * out_add
 int acamera_fpga_get_frame_writer( uint32_t total_input,uint32_t * in_addr,uint32_t * in_lineoffset )
 {
 	uint32_t base =0;
-	if(total_input>=1){
-		in_addr[0] = acamera_fpga_fr_dma_writer_wbase_last_read( base );
-		in_lineoffset[0] = acamera_fpga_fr_dma_writer_line_offset_read( base );
+	uint32_t curr, last, buffer, p;
+	unsigned long flags;
+
+	if ( fpga_ring.lock == NULL || total_input > fpga_ring.num_planes )
+		return -1;
+
+	flags = system_spinlock_lock( fpga_ring.lock );
+	curr = acamera_fpga_fr_dma_writer_wbank_curr_read( base ) % fpga_ring.num_banks;
+	last = acamera_fpga_fr_dma_writer_wbank_last_read( base ) % fpga_ring.num_banks;
+	//the bank started after init is complete once the writer starts the next one,
+	//a start missed between two calls only delays the first frame
+	if ( curr != fpga_ring.seen_curr ) {
+		fpga_ring.seen_curr = curr;
+		if ( fpga_ring.starts < 2 )
+			fpga_ring.starts++;
 	}
-	if(total_input>=2){
-		in_addr[1] = acamera_fpga_fruv_dma_writer_wbase_last_read( base );
-		in_lineoffset[1] = acamera_fpga_fruv_dma_writer_line_offset_read( base );
+	//no frame written since init yet, or the uv writer is still on the last one
+	if ( fpga_ring.starts < 2 || fpga_ring.bank[last] == fpga_ring.bank[curr] ||
+	     ( fpga_ring.num_planes >= 2 && acamera_fpga_fruv_dma_writer_wbank_last_read( base ) != last ) ) {
+		system_spinlock_unlock( fpga_ring.lock, flags );
+		return -1;
+	}
+	buffer = fpga_ring.bank[last];
+	fpga_ring.owner[buffer]++;
+	fpga_ring_update();
+	//the writer went on to a bank still pointing at the buffer before it was moved
+	if ( fpga_ring.bank[acamera_fpga_fr_dma_writer_wbank_curr_read( base ) % fpga_ring.num_banks] == buffer ) {
+		fpga_ring.owner[buffer]--;
+		system_spinlock_unlock( fpga_ring.lock, flags );
+		return -1;
 	}
+	for ( p = 0; p < total_input; p++ ) {
+		in_addr[p] = fpga_ring.addr[buffer][p];
+		in_lineoffset[p] = fpga_ring.lineoffset[p];
+	}
+	system_spinlock_unlock( fpga_ring.lock, flags );
 
     return 0;
 }
 
+/**
+ *   Give a frame taken by acamera_fpga_get_frame_writer back to the dma writers
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ *
+ */
+int acamera_fpga_release_frame( uint32_t addr )
+{
+	uint32_t i;
+	unsigned long flags;
+
+	if ( fpga_ring.lock == NULL )
+		return -1;
+
+	flags = system_spinlock_lock( fpga_ring.lock );
+	for ( i = 0; i < fpga_ring.num_buffers; i++ ) {
+		if ( fpga_ring.owner[i] && fpga_ring.addr[i][0] == addr )
+			break;
+	}
+	if ( i == fpga_ring.num_buffers ) {
+		system_spinlock_unlock( fpga_ring.lock, flags );
+		return -1;
+	}
+	//the last reader gone, a held writer can go on
+	if ( --fpga_ring.owner[i] == 0 && fpga_ring.held )
+		fpga_ring_update();
+	system_spinlock_unlock( fpga_ring.lock, flags );
+
+	return 0;
+}
+
 #endif
 
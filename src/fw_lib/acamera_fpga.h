@@ -23,19 +23,40 @@
 //configure the output gdc configuration address/size and buffer address/size; and resolution
 #include "system_stdlib.h"
 
+//banks of the dma writers, set by max_bank
+#define ACAMERA_FPGA_MAX_BANKS 5
+
+//frame buffers the banks can point at, buffers beyond the banks replace those the gdc still reads
+#define ACAMERA_FPGA_RING_MAX_BUFFERS 16
+
+//planes of a frame, the y and uv writers fill the first two
+#define ACAMERA_FPGA_MAX_PLANES 3
+
 /**
  *   FPGA initialization with resolution and input planar addresses
  *
+ *   The dma writers cycle through up to ACAMERA_FPGA_MAX_BANKS banks. A buffer
+ *   taken by the gdc is not written until it is released, a bank pointing at it
+ *   is moved to a spare buffer and capture is held while there is none.
+ *
  *   @param  active_width - frame reader output width resolution
  *   @param  active_height - frame reader output width resolution
  *   @param  total_input - number of addresses as input
  *   @param  in_addr - array of address
  *   @param  in_lineoffset - array of line offsets
+ *   @param  num_buffers - frame buffers of the ring, 2 to ACAMERA_FPGA_RING_MAX_BUFFERS, in_addr is the first one
+ *   @param  buffer_size - distance of the buffers in bytes
  *
  *   @return 0 - success
  *           -1 - fail.
  */
-int acamera_fpga_init( uint32_t active_width, uint32_t active_height,uint32_t total_input,uint32_t * in_addr,uint32_t * in_lineoffset );
+int acamera_fpga_init( uint32_t active_width, uint32_t active_height,uint32_t total_input,uint32_t * in_addr,uint32_t * in_lineoffset,uint32_t num_buffers,uint32_t buffer_size );
+
+/**
+ *   Stop the dma writers and release the ring
+ *
+ */
+void acamera_fpga_deinit( void );
 /**
  *   Update frame reader yuv address and the line offsets
  *
@@ -47,16 +68,32 @@ int acamera_fpga_init( uint32_t active_width, uint32_t active_height,uint32_t to
 
 void acamera_fpga_update_frame_reader(  uint32_t total_input, uint32_t * out_addr, uint32_t * out_lineoffset );
 /**
- *   Get the recent frame writer settings
+ *   Take the last frame written by the dma writers
+ *
+ *   The buffer belongs to the gdc until acamera_fpga_release_frame, the same
+ *   frame can be taken more than once. Fails until the writers completed a
+ *   frame after acamera_fpga_init, and when the writer started on the buffer
+ *   while it was taken, the caller tries again later.
  *
  *   @param  total_input - number of addresses as input
  *   @param  in_addr - array of address is saved here
  *   @param  in_lineoffset - array of line offsets is saved here
  *
  *   @return 0 - success
- *           -1 - fail.
+ *           -1 - no complete frame.
  *
  */
 int acamera_fpga_get_frame_writer( uint32_t total_input,uint32_t * in_addr,uint32_t * in_lineoffset );
 
+/**
+ *   Give a frame taken by acamera_fpga_get_frame_writer back to the dma writers
+ *
+ *   @param  addr - address of the first plane
+ *
+ *   @return 0 - success
+ *           -1 - the frame was not taken.
+ *
+ */
+int acamera_fpga_release_frame( uint32_t addr );
+
 #endif
@@ -22,11 +22,26 @@
 
 //data types and prototypes
 #include "acamera_gdc_api.h"
+#include "acamera_gdc_seq.h"
+#include "acamera_gdc_pool.h"
 
 //system_memcpy
 #include "system_stdlib.h"
+#include "system_spinlock.h"
 #include "system_log.h"
 
+//status bits reporting why a job failed, ACAMERA_GDC_GDC_ERROR_MASK summarises them
+#define GDC_STATUS_ERRORS ( ACAMERA_GDC_GDC_ERROR_MASK | ACAMERA_GDC_GDC_CONFIGURATION_ERROR_MASK | ACAMERA_GDC_GDC_USER_ABORT_MASK |     \
+                            ACAMERA_GDC_GDC_AXI_READER_ERROR_MASK | ACAMERA_GDC_GDC_AXI_WRITER_ERROR_MASK |                       \
+                            ACAMERA_GDC_GDC_UNALIGNED_ACCESS_MASK | ACAMERA_GDC_GDC_INCOMPATIBLE_CONFIGURATION_MASK |             \
+                            ACAMERA_GDC_STATUS_TIMEOUT | ACAMERA_GDC_STATUS_FENCE_ERROR )
+
+//errors running the same job again cannot fix
+#define GDC_STATUS_FATAL ( ACAMERA_GDC_GDC_CONFIGURATION_ERROR_MASK | ACAMERA_GDC_GDC_UNALIGNED_ACCESS_MASK | ACAMERA_GDC_GDC_INCOMPATIBLE_CONFIGURATION_MASK )
+
+static void gdc_watchdog_expired( void *param );
+static void gdc_watchdog_thread( void *param );
+
 
 /**
  *   Configure the output gdc configuration address/size and buffer address/size; and resolution.
@@ -51,11 +66,39 @@ int acamera_gdc_init( gdc_settings_t *gdc_settings )
         LOG( LOG_ERR, "Wrong GDC output resolution.\n" );
         return -1;
     }
+    if ( gdc_settings->job_queue.lock == NULL && system_spinlock_init( &gdc_settings->job_queue.lock ) != 0 ) {
+        LOG( LOG_ERR, "Failed to create the GDC job queue lock.\n" );
+        return -1;
+    }
+    gdc_settings->job_queue.head = 0;
+    gdc_settings->job_queue.tail = 0;
+    gdc_settings->job_queue.done_head = 0;
+    gdc_settings->job_queue.done_tail = 0;
+    gdc_settings->job_queue.completing = 0;
+    acamera_gdc_stats_clear( &gdc_settings->stats );
+    gdc_settings->watchdog.retries = 0;
+    gdc_settings->watchdog.aborted = 0;
+    gdc_settings->watchdog.expired = 0;
+    if ( gdc_settings->watchdog.timer == NULL ) {
+        if ( system_timer_init( &gdc_settings->watchdog.timer, gdc_watchdog_expired, gdc_settings ) != 0 ) {
+            LOG( LOG_WARNING, "Failed to create the GDC watchdog, hung jobs will not be recovered.\n" );
+            gdc_settings->watchdog.timer = NULL;
+        } else {
+            system_timer_set_thread_handler( gdc_settings->watchdog.timer, gdc_watchdog_thread );
+        }
+    }
+    //field updates merge into a copy of the registers, the status is owned by the block
+    if ( system_gdc_shadow_add( gdc_settings->base_gdc, ACAMERA_GDC_REGS_SIZE ) != 0 ) {
+        LOG( LOG_WARNING, "No shadow space for the GDC registers at 0x%x.\n", gdc_settings->base_gdc );
+    }
+    system_gdc_shadow_volatile( gdc_settings->base_gdc + ACAMERA_GDC_GDC_STATUS_OFFSET );
     //stop gdc
     acamera_gdc_gdc_start_flag_write( gdc_settings->base_gdc, 0 );
     //set the configuration address and size to the gdc block
     acamera_gdc_gdc_config_addr_write( gdc_settings->base_gdc, gdc_settings->gdc_config.config_addr );
     acamera_gdc_gdc_config_size_write( gdc_settings->base_gdc, gdc_settings->gdc_config.config_size );
+    gdc_settings->job_queue.hw_config_addr = gdc_settings->gdc_config.config_addr;
+    gdc_settings->job_queue.hw_config_size = gdc_settings->gdc_config.config_size;
 
     //set the gdc in and output resolution
     acamera_gdc_gdc_datain_width_write( gdc_settings->base_gdc, gdc_settings->gdc_config.input_width );
@@ -63,6 +106,86 @@ int acamera_gdc_init( gdc_settings_t *gdc_settings )
     acamera_gdc_gdc_dataout_width_write( gdc_settings->base_gdc, gdc_settings->gdc_config.output_width );
     acamera_gdc_gdc_dataout_height_write( gdc_settings->base_gdc, gdc_settings->gdc_config.output_height );
 
+    acamera_gdc_program_init( gdc_settings );
+
+    return 0;
+}
+
+//register offsets of the address and line offset registers of each plane
+static const uint32_t gdc_plane_regs[ACAMERA_GDC_MAX_INPUT][4] = {
+    {ACAMERA_GDC_GDC_DATA1IN_ADDR_OFFSET, ACAMERA_GDC_GDC_DATA1OUT_ADDR_OFFSET, ACAMERA_GDC_GDC_DATA1IN_LINE_OFFSET_OFFSET, ACAMERA_GDC_GDC_DATA1OUT_LINE_OFFSET_OFFSET},
+    {ACAMERA_GDC_GDC_DATA2IN_ADDR_OFFSET, ACAMERA_GDC_GDC_DATA2OUT_ADDR_OFFSET, ACAMERA_GDC_GDC_DATA2IN_LINE_OFFSET_OFFSET, ACAMERA_GDC_GDC_DATA2OUT_LINE_OFFSET_OFFSET},
+    {ACAMERA_GDC_GDC_DATA3IN_ADDR_OFFSET, ACAMERA_GDC_GDC_DATA3OUT_ADDR_OFFSET, ACAMERA_GDC_GDC_DATA3IN_LINE_OFFSET_OFFSET, ACAMERA_GDC_GDC_DATA3OUT_LINE_OFFSET_OFFSET},
+};
+
+void acamera_gdc_program_init( gdc_settings_t *gdc_settings )
+{
+    gdc_program_t *program = &gdc_settings->program;
+    gdc_config_t *config = &gdc_settings->gdc_config;
+    uint32_t base = gdc_settings->base_gdc;
+    uint32_t planes = config->total_planes;
+    uint32_t i;
+
+    if ( planes == 0 || planes > ACAMERA_GDC_MAX_INPUT ) {
+        planes = ACAMERA_GDC_MAX_INPUT;
+    }
+    program->num_planes = planes;
+    program->num_static = 2 * planes;
+    for ( i = 0; i < planes; i++ ) {
+        //planes after the first are narrower only when processed one by one
+        uint32_t shift = ( i && config->sequential_mode == 1 ) ? config->div_width : 0;
+        program->output_lineoffset[i] = config->output_width >> shift;
+        program->regs[2 * i].addr = base + gdc_plane_regs[i][2];
+        program->regs[2 * i].data = config->input_width >> shift;
+        program->regs[2 * i + 1].addr = base + gdc_plane_regs[i][3];
+        program->regs[2 * i + 1].data = program->output_lineoffset[i];
+        program->regs[program->num_static + 2 * i].addr = base + gdc_plane_regs[i][0];
+        program->regs[program->num_static + 2 * i].data = 0;
+        program->regs[program->num_static + 2 * i + 1].addr = base + gdc_plane_regs[i][1];
+        program->regs[program->num_static + 2 * i + 1].data = 0;
+    }
+    program->dirty = 1;
+}
+
+/**
+ *   Release the resources taken by acamera_gdc_init
+ *
+ *   @param  gdc_settings - overall gdc settings and state
+ */
+void acamera_gdc_deinit( gdc_settings_t *gdc_settings )
+{
+    acamera_gdc_stop( gdc_settings );
+    if ( gdc_settings->watchdog.timer ) {
+        system_timer_destroy( gdc_settings->watchdog.timer );
+        gdc_settings->watchdog.timer = NULL;
+    }
+    if ( gdc_settings->job_queue.lock ) {
+        system_spinlock_destroy( gdc_settings->job_queue.lock );
+        gdc_settings->job_queue.lock = NULL;
+    }
+    system_gdc_shadow_remove( gdc_settings->base_gdc );
+}
+
+//raises the stop flag and waits until the block no longer accesses memory, a block that
+//does not stop in time keeps the flag raised and is marked faulted
+static int gdc_halt( gdc_settings_t *gdc_settings )
+{
+    u64 deadline = system_time_ns() + ACAMERA_GDC_STOP_TIMEOUT_NS;
+
+    acamera_gdc_gdc_start_flag_write( gdc_settings->base_gdc, 0 );
+    acamera_gdc_gdc_stop_flag_write( gdc_settings->base_gdc, 1 );
+    while ( acamera_gdc_gdc_busy_read( gdc_settings->base_gdc ) ) {
+        if ( system_time_ns() >= deadline ) {
+            if ( !gdc_settings->watchdog.faulted ) {
+                LOG( LOG_CRIT, "GDC did not stop, the buffers of its job stay in use.\n" );
+            }
+            gdc_settings->watchdog.faulted = 1;
+            return -1;
+        }
+        system_sleep_ns( ACAMERA_GDC_STOP_POLL_NS );
+    }
+    acamera_gdc_gdc_stop_flag_write( gdc_settings->base_gdc, 0 );
+    gdc_settings->watchdog.faulted = 0;
     return 0;
 }
 
@@ -71,11 +194,39 @@ int acamera_gdc_init( gdc_settings_t *gdc_settings )
  *
  *   @param  gdc_settings - overall gdc settings and state
  *
+ *   @return 0 - success
+ *           -1 - the block did not stop.
  */
-void acamera_gdc_stop( gdc_settings_t *gdc_settings )
+int acamera_gdc_stop( gdc_settings_t *gdc_settings )
 {
-    gdc_settings->is_waiting_gdc = 0;
-    acamera_gdc_gdc_start_flag_write( gdc_settings->base_gdc, 0 );
+    unsigned long flags = 0;
+    int rc = 0;
+
+    //the block can be stopped before acamera_gdc_init created the lock
+    if ( gdc_settings->job_queue.lock ) {
+        flags = system_spinlock_lock( gdc_settings->job_queue.lock );
+    }
+    //a running job keeps reading and writing its buffers until the block is halted
+    if ( gdc_settings->is_waiting_gdc || gdc_settings->watchdog.faulted || acamera_gdc_gdc_busy_read( gdc_settings->base_gdc ) ) {
+        rc = gdc_halt( gdc_settings );
+        //its interrupt may still come
+        gdc_settings->watchdog.aborted = 1;
+    } else {
+        acamera_gdc_gdc_start_flag_write( gdc_settings->base_gdc, 0 );
+    }
+    //a block that did not stop still runs the job
+    if ( rc == 0 ) {
+        gdc_settings->is_waiting_gdc = 0;
+    }
+    gdc_settings->job_queue.tail = gdc_settings->job_queue.head;
+    gdc_settings->watchdog.retries = 0;
+    if ( gdc_settings->watchdog.timer ) {
+        system_timer_cancel( gdc_settings->watchdog.timer );
+    }
+    if ( gdc_settings->job_queue.lock ) {
+        system_spinlock_unlock( gdc_settings->job_queue.lock, flags );
+    }
+    return rc;
 }
 
 /**
@@ -88,11 +239,165 @@ void acamera_gdc_stop( gdc_settings_t *gdc_settings )
  */
 void acamera_gdc_start( gdc_settings_t *gdc_settings )
 {
+    //the frame registers may have been written relaxed, they must land before the start flag
+    system_gdc_write_barrier();
     acamera_gdc_gdc_start_flag_write( gdc_settings->base_gdc, 0 ); //do a stop for sync
     acamera_gdc_gdc_start_flag_write( gdc_settings->base_gdc, 1 );
     gdc_settings->is_waiting_gdc = 1;
 }
 
+//output pixels of a job over all its planes
+static uint32_t gdc_job_pixels( const gdc_settings_t *gdc_settings, const gdc_job_t *job )
+{
+    const gdc_config_t *config = &gdc_settings->gdc_config;
+    uint32_t pixels = config->output_width * config->output_height;
+    uint32_t i;
+
+    for ( i = 1; i < job->num_input; i++ ) {
+        pixels += ( config->output_width >> config->div_width ) * ( config->output_height >> config->div_height );
+    }
+    return pixels;
+}
+
+//time the running job is allowed before the watchdog stops it
+static u64 gdc_watchdog_timeout( const gdc_settings_t *gdc_settings, const gdc_job_t *job )
+{
+    u64 kpixel_ns = gdc_settings->watchdog.kpixel_ns ? gdc_settings->watchdog.kpixel_ns : ACAMERA_GDC_WATCHDOG_KPIXEL_NS;
+    u64 timeout = ( ( kpixel_ns * gdc_job_pixels( gdc_settings, job ) ) >> 10 ) * ACAMERA_GDC_WATCHDOG_MARGIN;
+
+    if ( timeout < ACAMERA_GDC_WATCHDOG_MIN_NS ) {
+        timeout = ACAMERA_GDC_WATCHDOG_MIN_NS;
+    }
+    if ( timeout > ACAMERA_GDC_WATCHDOG_MAX_NS ) {
+        timeout = ACAMERA_GDC_WATCHDOG_MAX_NS;
+    }
+    return timeout;
+}
+
+//folds the time of a job that completed without error into the processing time per pixel
+static void gdc_watchdog_update( gdc_settings_t *gdc_settings, const gdc_job_t *job, u64 end_ns )
+{
+    gdc_watchdog_t *watchdog = &gdc_settings->watchdog;
+    uint32_t kpixels = gdc_job_pixels( gdc_settings, job ) >> 10;
+    u64 elapsed = end_ns - watchdog->start_ns;
+    uint32_t kpixel_ns;
+
+    //a job longer than the largest timeout was not measured, it was stopped
+    if ( kpixels == 0 || elapsed > ACAMERA_GDC_WATCHDOG_MAX_NS ) {
+        return;
+    }
+    kpixel_ns = (uint32_t)elapsed / kpixels;
+    if ( kpixel_ns == 0 ) {
+        kpixel_ns = 1;
+    }
+    if ( watchdog->kpixel_ns == 0 ) {
+        watchdog->kpixel_ns = kpixel_ns;
+    } else {
+        watchdog->kpixel_ns += ( (int32_t)( kpixel_ns - watchdog->kpixel_ns ) ) >> ACAMERA_GDC_WATCHDOG_HISTORY_SHIFT;
+    }
+}
+
+//programs the addresses of a job and starts the block, called with the job queue lock held
+static void gdc_start_job( gdc_settings_t *gdc_settings, const gdc_job_t *job )
+{
+    gdc_job_t *running = &gdc_settings->job_queue.running;
+    gdc_program_t *program = &gdc_settings->program;
+    uint32_t num_input = job->num_input;
+    uint32_t i;
+    u64 now, timeout;
+
+    *running = *job;
+
+    //switch the configuration sequence when the job brings its own
+    if ( job->config_addr && ( job->config_addr != gdc_settings->job_queue.hw_config_addr || job->config_size != gdc_settings->job_queue.hw_config_size ) ) {
+        acamera_gdc_gdc_config_addr_write( gdc_settings->base_gdc, job->config_addr );
+        acamera_gdc_gdc_config_size_write( gdc_settings->base_gdc, job->config_size );
+        gdc_settings->job_queue.hw_config_addr = job->config_addr;
+        gdc_settings->job_queue.hw_config_size = job->config_size;
+    }
+
+    //patch the buffer addresses into the program, the line offsets only go out after a rebuild
+    if ( num_input > program->num_planes ) {
+        num_input = program->num_planes;
+    }
+    for ( i = 0; i < num_input; i++ ) {
+        program->regs[program->num_static + 2 * i].data = job->input_addr[i];
+        program->regs[program->num_static + 2 * i + 1].data = job->output_addr[i];
+        running->output_lineoffset[i] = program->output_lineoffset[i];
+    }
+    if ( program->dirty ) {
+        system_gdc_write_list( program->regs, program->num_static + 2 * num_input );
+        program->dirty = 0;
+    } else {
+        system_gdc_write_list( &program->regs[program->num_static], 2 * num_input );
+    }
+
+    LOG( LOG_DEBUG, "acamera_gdc_start" );
+
+    acamera_gdc_start( gdc_settings );
+    now = system_time_ns();
+    running->start_ns = now;
+    if ( gdc_settings->poll.enabled ) {
+        gdc_settings->poll.start_ns = now;
+    }
+    gdc_settings->watchdog.start_ns = now;
+    if ( gdc_settings->watchdog.timer ) {
+        timeout = gdc_watchdog_timeout( gdc_settings, running );
+        gdc_settings->watchdog.deadline_ns = now + timeout;
+        system_timer_arm( gdc_settings->watchdog.timer, timeout );
+    }
+}
+
+/**
+ *   This function queues a job for the gdc block
+ *
+ *   @return 0 - success
+ *           -1 - invalid job or the queue is full.
+ */
+int acamera_gdc_submit( gdc_settings_t *gdc_settings, const gdc_job_t *job )
+{
+    gdc_job_queue_t *queue = &gdc_settings->job_queue;
+    unsigned long flags;
+    gdc_job_t queued;
+    int rc = 0;
+
+    if ( job->num_input == 0 || job->num_input > ACAMERA_GDC_MAX_INPUT ) {
+        LOG( LOG_CRIT, "GDC number of input invalid %d.\n", job->num_input );
+        return -1;
+    }
+    if ( job->num_input != gdc_settings->gdc_config.total_planes ) {
+        LOG( LOG_CRIT, "GDC number of input less than planes %d.\n", job->num_input );
+        return -1;
+    }
+    if ( queue->lock == NULL ) {
+        LOG( LOG_ERR, "GDC is not initialised.\n" );
+        return -1;
+    }
+    queued = *job;
+    if ( queued.submit_ns == 0 ) {
+        queued.submit_ns = system_time_ns();
+    }
+
+    flags = system_spinlock_lock( queue->lock );
+    if ( queue->head - queue->tail + 1 + queue->done_head - queue->done_tail >= ACAMERA_GDC_DONE_QUEUE_SIZE ) {
+        //completed jobs are not handed to their callbacks fast enough
+        rc = -1;
+    } else if ( !gdc_settings->is_waiting_gdc ) {
+        LOG( LOG_DEBUG, "starting GDC process.\n" );
+        gdc_start_job( gdc_settings, &queued );
+    } else if ( queue->head - queue->tail < ACAMERA_GDC_JOB_QUEUE_SIZE ) {
+        queue->jobs[queue->head & ( ACAMERA_GDC_JOB_QUEUE_SIZE - 1 )] = queued;
+        queue->head++;
+    } else {
+        rc = -1;
+    }
+    system_spinlock_unlock( queue->lock, flags );
+
+    if ( rc != 0 ) {
+        LOG( LOG_ERR, "GDC job queue is full.\n" );
+    }
+    return rc;
+}
 
 /**
  *   This function points gdc to its input resolution and yuv address and offsets
@@ -101,133 +406,523 @@ void acamera_gdc_start( gdc_settings_t *gdc_settings )
  *
  *
  *   @return 0 - success
- *           -1 - no interrupt from GDC.
+ *           -1 - invalid input or the job queue is full.
  */
 
 int acamera_gdc_process( gdc_settings_t *gdc_settings, uint32_t num_input, uint32_t * input_addr)
 {
-    if ( !gdc_settings->is_waiting_gdc ) {
-        LOG(LOG_DEBUG,"starting GDC process.\n");
-        uint32_t frame_size=0;
-        if(num_input==0 || num_input>ACAMERA_GDC_MAX_INPUT){
-        	LOG(LOG_CRIT,"GDC number of input invalid %d.\n",num_input);
-        	return -1;
-        }
+    gdc_job_t job;
+    uint32_t i;
+
+    if ( num_input == 0 || num_input > ACAMERA_GDC_MAX_INPUT ) {
+        LOG( LOG_CRIT, "GDC number of input invalid %d.\n", num_input );
+        return -1;
+    }
+
+    job.num_input = num_input;
+    for ( i = 0; i < num_input; i++ ) {
+        job.input_addr[i] = input_addr[i];
+        job.output_addr[i] = gdc_settings->outbuffers[i];
+    }
+    if ( gdc_settings->pool && acamera_gdc_pool_acquire( gdc_settings->pool, job.output_addr ) != 0 ) {
+        LOG( LOG_ERR, "GDC has no free output buffer.\n" );
+        return -1;
+    }
+    job.config_addr = gdc_settings->gdc_config.config_addr;
+    job.config_size = gdc_settings->gdc_config.config_size;
+    job.stream = 0;
+    job.frame = 0;
+    job.submit_ns = 0;
 
-        //uint32_t total_planes=0;
-		//int index_plane=0;
-		/*if(gdc_settings->gdc_config.sequential_mode==1){
-			total_planes=1; //do sequential processing by toggling all planes
-			index_plane=gdc_settings->seq_planes_pos++;
-			if(gdc_settings->seq_planes_pos>=gdc_settings->gdc_config.total_planes)
-				gdc_settings->seq_planes_pos=0;
-		}else{
-			total_planes=gdc_settings->gdc_config.total_planes;
-			index_plane=gdc_settings->gdc_config.toggle_planes_pos;
-		}*/
-
-		if(num_input != gdc_settings->gdc_config.total_planes){
-			LOG(LOG_CRIT,"GDC number of input less than planes %d.\n",num_input);
-			return -1;
-		}
-
-		uint32_t lineoffset,height;
-        //process input addresses
-        if(num_input>=1){
-        	lineoffset = gdc_settings->gdc_config.input_width;
-        	height=gdc_settings->gdc_config.input_height;
-			acamera_gdc_gdc_data1in_addr_write( gdc_settings->base_gdc,input_addr[0]);
-			acamera_gdc_gdc_data1in_line_offset_write( gdc_settings->base_gdc, lineoffset );
-
-        	if(gdc_settings->gdc_config.sequential_mode==1){
-					lineoffset = gdc_settings->gdc_config.input_width >> gdc_settings->gdc_config.div_width;
-        			height = gdc_settings->gdc_config.input_height >> gdc_settings->gdc_config.div_height;
-
-        	}
+    if ( acamera_gdc_submit( gdc_settings, &job ) != 0 ) {
+        if ( gdc_settings->pool ) {
+            acamera_gdc_pool_release( gdc_settings->pool, job.output_addr[0] );
         }
+        return -1;
+    }
+    gdc_settings->current_addr = job.output_addr[0];
+    return 0;
+}
+
+/**
+ *   Decode a status register value
+ */
+void acamera_gdc_status_decode( uint32_t raw, gdc_status_t *status )
+{
+    status->raw = raw;
+    status->busy = ( raw & ACAMERA_GDC_GDC_BUSY_MASK ) != 0;
+    status->error = ( raw & GDC_STATUS_ERRORS ) != 0;
+    status->configuration_error = ( raw & ACAMERA_GDC_GDC_CONFIGURATION_ERROR_MASK ) != 0;
+    status->user_abort = ( raw & ACAMERA_GDC_GDC_USER_ABORT_MASK ) != 0;
+    status->axi_reader_error = ( raw & ACAMERA_GDC_GDC_AXI_READER_ERROR_MASK ) != 0;
+    status->axi_writer_error = ( raw & ACAMERA_GDC_GDC_AXI_WRITER_ERROR_MASK ) != 0;
+    status->unaligned_access = ( raw & ACAMERA_GDC_GDC_UNALIGNED_ACCESS_MASK ) != 0;
+    status->incompatible_configuration = ( raw & ACAMERA_GDC_GDC_INCOMPATIBLE_CONFIGURATION_MASK ) != 0;
+    status->timeout = ( raw & ACAMERA_GDC_STATUS_TIMEOUT ) != 0;
+    status->fence_error = ( raw & ACAMERA_GDC_STATUS_FENCE_ERROR ) != 0;
+}
 
-        if(num_input >=2) {
-            acamera_gdc_gdc_data2in_addr_write( gdc_settings->base_gdc,input_addr[1]);
-            acamera_gdc_gdc_data2in_line_offset_write( gdc_settings->base_gdc, lineoffset );
-		}		   
-        if(num_input >=3) { 
-            acamera_gdc_gdc_data3in_addr_write( gdc_settings->base_gdc,input_addr[2]);
-            acamera_gdc_gdc_data3in_line_offset_write( gdc_settings->base_gdc, lineoffset );
+/**
+ *   Take a snapshot of the status register with one read
+ */
+void acamera_gdc_status_read( gdc_settings_t *gdc_settings, gdc_status_t *status )
+{
+    acamera_gdc_status_decode( acamera_gdc_gdc_status_read( gdc_settings->base_gdc ), status );
+}
+
+//folds the time of the running job ending at end_ns into the predicted job time
+static void gdc_poll_update( gdc_poll_t *poll, u64 end_ns )
+{
+    long long elapsed = end_ns - poll->start_ns;
+
+    if ( poll->start_ns == 0 ) {
+        return;
+    }
+    if ( poll->job_ns == 0 ) {
+        poll->job_ns = elapsed;
+    } else {
+        poll->job_ns += ( elapsed - (long long)poll->job_ns ) >> ACAMERA_GDC_POLL_HISTORY_SHIFT;
+    }
+    //0 stands for no prediction
+    if ( poll->job_ns == 0 ) {
+        poll->job_ns = 1;
+    }
+}
+
+//stops the running job and makes the next start reprogram the block, called with the job queue lock held
+static int gdc_abort( gdc_settings_t *gdc_settings )
+{
+    if ( gdc_halt( gdc_settings ) != 0 ) {
+        return -1;
+    }
+
+    //the stop may have left the configuration half read, load it and the whole register program again
+    acamera_gdc_gdc_config_addr_write( gdc_settings->base_gdc, gdc_settings->job_queue.hw_config_addr );
+    acamera_gdc_gdc_config_size_write( gdc_settings->base_gdc, gdc_settings->job_queue.hw_config_size );
+    gdc_settings->program.dirty = 1;
+    return 0;
+}
+
+//the block did not stop, the job stays on it with its buffers and the watchdog tries again later
+static void gdc_abort_later( gdc_settings_t *gdc_settings )
+{
+    gdc_settings->watchdog.deadline_ns = system_time_ns();
+    if ( gdc_settings->watchdog.timer ) {
+        system_timer_arm( gdc_settings->watchdog.timer, ACAMERA_GDC_STOP_RETRY_NS );
+    }
+}
+
+//hands the running job ending with status to the done ring and starts the next one, called with the job queue lock held
+static void gdc_finish_job( gdc_settings_t *gdc_settings, const gdc_status_t *status )
+{
+    gdc_job_queue_t *queue = &gdc_settings->job_queue;
+    gdc_watchdog_t *watchdog = &gdc_settings->watchdog;
+    gdc_job_t *done;
+    gdc_job_t retry;
+
+    if ( status->error ) {
+        watchdog->errors++;
+    }
+    //timeouts and bus errors may be transient, run the job once more before failing it
+    if ( status->error && !( status->raw & GDC_STATUS_FATAL ) && watchdog->retries < ACAMERA_GDC_WATCHDOG_RETRIES ) {
+        if ( !status->timeout && gdc_abort( gdc_settings ) != 0 ) {
+            gdc_abort_later( gdc_settings );
+            return;
         }
+        watchdog->retries++;
+        watchdog->resubmits++;
+        retry = queue->running;
+        gdc_start_job( gdc_settings, &retry );
+        return;
+    }
 
-        //outputs
-        if(num_input>=1){
-        	lineoffset = gdc_settings->gdc_config.output_width;
-        	height=gdc_settings->gdc_config.output_height;
-			acamera_gdc_gdc_data1out_addr_write( gdc_settings->base_gdc, gdc_settings->outbuffers[0]);
-        	acamera_gdc_gdc_data1out_line_offset_write( gdc_settings->base_gdc, lineoffset );
-        	
-        	if(gdc_settings->gdc_config.sequential_mode==1){ //UV planes
-				lineoffset = gdc_settings->gdc_config.output_width >> gdc_settings->gdc_config.div_width;
-				height = gdc_settings->gdc_config.output_height >> gdc_settings->gdc_config.div_height;
-			}
-		}
-        if(num_input>=2){
-			acamera_gdc_gdc_data2out_addr_write( gdc_settings->base_gdc, gdc_settings->outbuffers[1]);
-        	acamera_gdc_gdc_data2out_line_offset_write( gdc_settings->base_gdc, lineoffset );        
-		} 
-        if(num_input>=3){
-			acamera_gdc_gdc_data3out_addr_write( gdc_settings->base_gdc, gdc_settings->outbuffers[2]);
-        	acamera_gdc_gdc_data3out_line_offset_write( gdc_settings->base_gdc, lineoffset );        
-		} 
-        
-        LOG( LOG_DEBUG, "acamera_gdc_start" );
-
-        acamera_gdc_start(gdc_settings);
+    if ( status->error ) {
+        watchdog->failed++;
+    } else {
+        gdc_watchdog_update( gdc_settings, &queue->running, queue->running.irq_ns );
+    }
+    watchdog->retries = 0;
+    acamera_gdc_stats_add( &gdc_settings->stats.stages[ACAMERA_GDC_STAGE_QUEUE], queue->running.start_ns - queue->running.submit_ns );
+    acamera_gdc_stats_add( &gdc_settings->stats.stages[ACAMERA_GDC_STAGE_PROCESS], queue->running.irq_ns - queue->running.start_ns );
 
-        return 0;
+    //the submit check keeps room for every job in flight
+    done = &queue->done[queue->done_head & ( ACAMERA_GDC_DONE_QUEUE_SIZE - 1 )];
+    *done = queue->running;
+    done->status = *status;
+    queue->done_head++;
+
+    //keep the block busy, the next job starts before the callbacks run
+    if ( queue->head != queue->tail ) {
+        gdc_start_job( gdc_settings, &queue->jobs[queue->tail & ( ACAMERA_GDC_JOB_QUEUE_SIZE - 1 )] );
+        queue->tail++;
     } else {
+        //done of the current frame and stop gdc block
+        gdc_settings->is_waiting_gdc = 0;
         acamera_gdc_gdc_start_flag_write( gdc_settings->base_gdc, 0 );
-        LOG( LOG_CRIT, "No interrupt from GDC block. Still waiting...\n" );
-        acamera_gdc_gdc_start_flag_write( gdc_settings->base_gdc, 1 );
+        if ( watchdog->timer ) {
+            system_timer_cancel( watchdog->timer );
+        }
+    }
+}
 
-        return -1;
+//watchdog timer handler, runs in interrupt context and only marks the running job as timed out
+static void gdc_watchdog_expired( void *param )
+{
+    gdc_settings_t *gdc_settings = param;
+    gdc_job_queue_t *queue = &gdc_settings->job_queue;
+    unsigned long flags;
+    u64 now = system_time_ns();
+
+    flags = system_spinlock_lock( queue->lock );
+    //the job completed, or the next one started, while the timer fired
+    if ( gdc_settings->is_waiting_gdc && now >= gdc_settings->watchdog.deadline_ns ) {
+        gdc_settings->watchdog.expired = 1;
     }
+    system_spinlock_unlock( queue->lock, flags );
+}
+
+//threaded part of the watchdog, stops the timed out job, waits for the block and completes the job
+static void gdc_watchdog_thread( void *param )
+{
+    gdc_settings_t *gdc_settings = param;
+    gdc_job_queue_t *queue = &gdc_settings->job_queue;
+    gdc_status_t status;
+    unsigned long flags;
+    uint32_t stream, frame;
+    int faulted;
+    u64 now = system_time_ns();
+
+    flags = system_spinlock_lock( queue->lock );
+    //the job may have completed between the timer and this thread
+    if ( !gdc_settings->watchdog.expired || !gdc_settings->is_waiting_gdc || now < gdc_settings->watchdog.deadline_ns ) {
+        gdc_settings->watchdog.expired = 0;
+        system_spinlock_unlock( queue->lock, flags );
+        return;
+    }
+    gdc_settings->watchdog.expired = 0;
+    stream = queue->running.stream;
+    frame = queue->running.frame;
+    acamera_gdc_status_decode( acamera_gdc_gdc_status_read( gdc_settings->base_gdc ) | ACAMERA_GDC_STATUS_TIMEOUT, &status );
+    //a faulted block already counted the timeout of its job
+    faulted = gdc_settings->watchdog.faulted;
+    if ( !faulted ) {
+        gdc_settings->watchdog.timeouts++;
+    }
+    if ( gdc_abort( gdc_settings ) != 0 ) {
+        gdc_abort_later( gdc_settings );
+        system_spinlock_unlock( queue->lock, flags );
+        if ( !faulted ) {
+            LOG( LOG_ERR, "GDC job of stream %u frame %u did not stop, trying again every %u ms.\n", stream, frame, ACAMERA_GDC_STOP_RETRY_NS / 1000000 );
+        }
+        return;
+    }
+    //an interrupt raised by the stop belongs to this job
+    gdc_settings->watchdog.aborted = 1;
+    queue->running.irq_ns = now;
+    gdc_finish_job( gdc_settings, &status );
+    system_spinlock_unlock( queue->lock, flags );
+
+    LOG( LOG_ERR, "GDC job of stream %u frame %u timed out, status 0x%x.\n", stream, frame, status.raw );
+    acamera_gdc_complete_frames( gdc_settings );
 }
 
 /**
- *   This function gets the GDC ouput frame addresses and offsets and updates the frame buffer via callback if it is available
+ *   Latch the completed job, to be called in interrupt context
  *
- *   Shown ouputs to GDC are Y and UV plane address and offsets
+ *   @return 0 - success
+ *           -1 - unexpected interrupt from GDC.
+ */
+int acamera_gdc_latch_frame( gdc_settings_t *gdc_settings )
+{
+    gdc_job_queue_t *queue = &gdc_settings->job_queue;
+    gdc_status_t status;
+    unsigned long flags;
+    u64 now = system_time_ns();
+
+    if ( queue->lock == NULL ) {
+        LOG( LOG_CRIT, "Unexpected interrupt from GDC.\n" );
+        return -1;
+    }
+
+    flags = system_spinlock_lock( queue->lock );
+    if ( !gdc_settings->is_waiting_gdc ) {
+        //the poll took the job before its interrupt came, or the watchdog stopped it
+        if ( gdc_settings->poll.enabled || gdc_settings->watchdog.aborted ) {
+            gdc_settings->watchdog.aborted = 0;
+            system_spinlock_unlock( queue->lock, flags );
+            return 0;
+        }
+        system_spinlock_unlock( queue->lock, flags );
+        LOG( LOG_CRIT, "Unexpected interrupt from GDC.\n" );
+        return -1;
+    }
+
+    //starting the next job changes the status, so it is taken first
+    acamera_gdc_status_read( gdc_settings, &status );
+    //the busy job is the next one, the poll or the watchdog took the job this interrupt was raised for
+    if ( status.busy ) {
+        system_spinlock_unlock( queue->lock, flags );
+        return 0;
+    }
+    gdc_settings->watchdog.aborted = 0;
+    //a polling caller measures the job itself
+    if ( gdc_settings->poll.enabled && !gdc_settings->poll.polling ) {
+        gdc_poll_update( &gdc_settings->poll, now );
+    }
+
+    queue->running.irq_ns = now;
+    gdc_finish_job( gdc_settings, &status );
+    system_spinlock_unlock( queue->lock, flags );
+    return 0;
+}
+
+/**
+ *   Run the callbacks of the jobs latched by acamera_gdc_latch_frame
  *
+ *   @return number of jobs completed
+ */
+uint32_t acamera_gdc_complete_frames( gdc_settings_t *gdc_settings )
+{
+    gdc_job_queue_t *queue = &gdc_settings->job_queue;
+    uint32_t out_addr[ACAMERA_GDC_MAX_INPUT];
+    uint32_t out_lineoffset[ACAMERA_GDC_MAX_INPUT];
+    uint32_t completed = 0, i;
+    unsigned long flags;
+    gdc_job_t done;
+    u64 now;
+
+    if ( queue->lock == NULL ) {
+        return 0;
+    }
+
+    flags = system_spinlock_lock( queue->lock );
+    //jobs latched meanwhile are picked up by the caller already completing
+    if ( queue->completing ) {
+        system_spinlock_unlock( queue->lock, flags );
+        return 0;
+    }
+    queue->completing = 1;
+    while ( queue->done_tail != queue->done_head ) {
+        done = queue->done[queue->done_tail & ( ACAMERA_GDC_DONE_QUEUE_SIZE - 1 )];
+        system_spinlock_unlock( queue->lock, flags );
+
+        //pass the frame buffer parameters if callback is available
+        for ( i = 0; i < done.num_input; i++ ) {
+            out_addr[i] = done.output_addr[i];
+            out_lineoffset[i] = done.output_lineoffset[i];
+        }
+        if ( gdc_settings->get_frame_buffer ) {
+            gdc_settings->get_frame_buffer( done.num_input, out_addr, out_lineoffset );
+        }
+        if ( gdc_settings->job_done ) {
+            gdc_settings->job_done( gdc_settings->job_done_ctx, &done );
+        }
+        completed++;
+
+        //one completing caller at a time records these stages
+        now = system_time_ns();
+        acamera_gdc_stats_add( &gdc_settings->stats.stages[ACAMERA_GDC_STAGE_COMPLETE], now - done.irq_ns );
+        acamera_gdc_stats_add( &gdc_settings->stats.stages[ACAMERA_GDC_STAGE_TOTAL], now - done.submit_ns );
+
+        //the slot is released after the callbacks, so pending jobs count the job until then
+        flags = system_spinlock_lock( queue->lock );
+        queue->done_tail++;
+    }
+    queue->completing = 0;
+    system_spinlock_unlock( queue->lock, flags );
+    return completed;
+}
+
+/**
+ *   This function completes the running job on the gdc interrupt
  *
  *   @return 0 - success
  *           -1 - unexpected interrupt from GDC.
  */
 int acamera_gdc_get_frame( gdc_settings_t *gdc_settings, uint32_t num_input )
 {
-    if ( gdc_settings->is_waiting_gdc ) {
-        //pass the frame buffer parameters if callback is available
-        if ( gdc_settings->get_frame_buffer ) {
-        	uint32_t out_addr[num_input];
-        	uint32_t out_lineoffset[num_input];
-
-        	if(num_input>=1){
-        		out_addr[0]=acamera_gdc_gdc_data1out_addr_read( gdc_settings->base_gdc );
-        		out_lineoffset[0]=acamera_gdc_gdc_data1out_line_offset_read( gdc_settings->base_gdc );
-        	}
-        	if(num_input>=2){
-				out_addr[1]=acamera_gdc_gdc_data2out_addr_read( gdc_settings->base_gdc );
-				out_lineoffset[1]=acamera_gdc_gdc_data2out_line_offset_read( gdc_settings->base_gdc );
-			}
-        	if(num_input>=3){
-				out_addr[2]=acamera_gdc_gdc_data3out_addr_read( gdc_settings->base_gdc );
-				out_lineoffset[2]=acamera_gdc_gdc_data3out_line_offset_read( gdc_settings->base_gdc );
-			}
-
-
-            gdc_settings->get_frame_buffer( num_input, out_addr, out_lineoffset );
+    if ( acamera_gdc_latch_frame( gdc_settings ) != 0 ) {
+        return -1;
+    }
+    acamera_gdc_complete_frames( gdc_settings );
+    return 0;
+}
+
+/**
+ *   Select polling completion for a core
+ */
+void acamera_gdc_set_polling( gdc_settings_t *gdc_settings, int enable, u64 max_wait_ns )
+{
+    gdc_poll_t *poll = &gdc_settings->poll;
+    unsigned long flags = 0;
+
+    if ( gdc_settings->job_queue.lock ) {
+        flags = system_spinlock_lock( gdc_settings->job_queue.lock );
+    }
+    //the running job has no start time, its interrupt completes it
+    if ( enable && !poll->enabled ) {
+        poll->start_ns = 0;
+        poll->job_ns = 0;
+    }
+    poll->enabled = enable;
+    poll->max_wait_ns = max_wait_ns ? max_wait_ns : ACAMERA_GDC_POLL_MAX_WAIT_NS;
+    if ( gdc_settings->job_queue.lock ) {
+        system_spinlock_unlock( gdc_settings->job_queue.lock, flags );
+    }
+}
+
+/**
+ *   Wait for the running job by polling the busy bit
+ *
+ *   @return 0 - the job completed, or no job was running
+ *           1 - the wait is left to the interrupt
+ *           -1 - polling is not enabled.
+ */
+int acamera_gdc_poll_frame( gdc_settings_t *gdc_settings )
+{
+    gdc_poll_t *poll = &gdc_settings->poll;
+    u64 start_ns, job_ns, now, interval;
+    unsigned long flags;
+    int running, seen_busy = 0;
+
+    if ( !poll->enabled || gdc_settings->job_queue.lock == NULL ) {
+        return -1;
+    }
+    flags = system_spinlock_lock( gdc_settings->job_queue.lock );
+    running = gdc_settings->is_waiting_gdc;
+    start_ns = poll->start_ns;
+    job_ns = poll->job_ns;
+    system_spinlock_unlock( gdc_settings->job_queue.lock, flags );
+
+    if ( !running ) {
+        acamera_gdc_complete_frames( gdc_settings );
+        return 0;
+    }
+    if ( job_ns == 0 || start_ns == 0 || job_ns > poll->max_wait_ns ) {
+        poll->fallbacks++;
+        return 1;
+    }
+
+    //sleep through most of the job, then read the busy bit often enough to see the end early
+    poll->polling = 1;
+    now = system_time_ns();
+    if ( start_ns + job_ns > now + ACAMERA_GDC_POLL_SLACK_NS ) {
+        system_sleep_ns( start_ns + job_ns - now - ACAMERA_GDC_POLL_SLACK_NS );
+    }
+    interval = job_ns >> ACAMERA_GDC_POLL_INTERVAL_SHIFT;
+    while ( acamera_gdc_gdc_busy_read( gdc_settings->base_gdc ) ) {
+        seen_busy = 1;
+        now = system_time_ns();
+        //the interrupt took the job and started the next one
+        if ( poll->start_ns != start_ns ) {
+            poll->polling = 0;
+            acamera_gdc_complete_frames( gdc_settings );
+            return 0;
         }
-        //done of the current frame and stop gdc block
-        acamera_gdc_stop(gdc_settings);
+        //a job taking twice the prediction is left to the interrupt
+        if ( now > start_ns + 2 * job_ns + ACAMERA_GDC_POLL_SLACK_NS ) {
+            poll->polling = 0;
+            poll->fallbacks++;
+            return 1;
+        }
+        if ( interval ) {
+            system_sleep_ns( interval );
+        }
+    }
+
+    //only an end seen while polling is a job time, otherwise the sleep overshot it and the prediction is too long
+    if ( seen_busy ) {
+        gdc_poll_update( poll, system_time_ns() );
+    } else if ( poll->job_ns > 1 ) {
+        poll->job_ns -= ( poll->job_ns >> ACAMERA_GDC_POLL_HISTORY_SHIFT ) + 1;
+    }
+
+    //the interrupt may have taken the job meanwhile, either way it is latched now
+    acamera_gdc_latch_frame( gdc_settings );
+    poll->polling = 0;
+    acamera_gdc_complete_frames( gdc_settings );
+    poll->polled++;
+    return 0;
+}
+
+/**
+ *   Number of jobs submitted and not completed yet, including the running one
+ *
+ *   @return pending jobs
+ */
+uint32_t acamera_gdc_pending_jobs( gdc_settings_t *gdc_settings )
+{
+    gdc_job_queue_t *queue = &gdc_settings->job_queue;
+    unsigned long flags;
+    uint32_t pending;
+
+    if ( queue->lock == NULL ) {
         return 0;
-    } else {
-        LOG( LOG_CRIT, "Unexpected interrupt from GDC.\n" );
+    }
+    flags = system_spinlock_lock( queue->lock );
+    pending = queue->head - queue->tail + ( gdc_settings->is_waiting_gdc ? 1 : 0 ) + queue->done_head - queue->done_tail;
+    system_spinlock_unlock( queue->lock, flags );
+    return pending;
+}
+
+/**
+ *   This function points the gdc block to another configuration sequence already in memory
+ *
+ *   @return 0 - success
+ *           -1 - fail.
+ */
+int acamera_gdc_set_config( gdc_settings_t *gdc_settings, uint32_t config_addr, uint32_t config_size )
+{
+    gdc_job_queue_t *queue = &gdc_settings->job_queue;
+    unsigned long flags = 0;
+
+    if ( config_addr == 0 || config_size == 0 ) {
+        LOG( LOG_ERR, "GDC configuration 0x%X of %u words is invalid.\n", config_addr, config_size );
         return -1;
     }
+    if ( queue->lock ) {
+        flags = system_spinlock_lock( queue->lock );
+    }
+    gdc_settings->gdc_config.config_addr = config_addr;
+    gdc_settings->gdc_config.config_size = config_size;
+    //a busy block picks the sequence up with the first job that carries it
+    if ( !gdc_settings->is_waiting_gdc ) {
+        acamera_gdc_gdc_config_addr_write( gdc_settings->base_gdc, config_addr );
+        acamera_gdc_gdc_config_size_write( gdc_settings->base_gdc, config_size );
+        queue->hw_config_addr = config_addr;
+        queue->hw_config_size = config_size;
+    }
+    if ( queue->lock ) {
+        system_spinlock_unlock( queue->lock, flags );
+    }
+    return 0;
+}
+
+/**
+ *   This function checks a configuration sequence before it is given to the gdc block
+ *
+ *   @return 0 - success
+ *           -1 - sequence is malformed or does not fit the block.
+ */
+int acamera_gdc_check_sequence( gdc_settings_t *gdc_settings, const uint32_t *sequence, uint32_t size )
+{
+    gdc_seq_t seq;
+    gdc_seq_limits_t limits;
+
+    if ( acamera_gdc_seq_parse( sequence, size, &seq ) != 0 ) {
+        return -1;
+    }
+
+    limits.input_width = gdc_settings->gdc_config.input_width;
+    limits.input_height = gdc_settings->gdc_config.input_height;
+    limits.output_width = gdc_settings->gdc_config.output_width;
+    limits.output_height = gdc_settings->gdc_config.output_height;
+    limits.total_planes = gdc_settings->gdc_config.total_planes;
+    limits.div_width = gdc_settings->gdc_config.div_width;
+    limits.div_height = gdc_settings->gdc_config.div_height;
+    //both capabilities are given as log2
+    limits.tile_cache_clusters = 1 << acamera_gdc_gdc_size_of_tile_cache_read( gdc_settings->base_gdc );
+    limits.num_filter_banks = 1 << acamera_gdc_gdc_nuimber_of_polyphase_filter_banks_read( gdc_settings->base_gdc );
+
+    return acamera_gdc_seq_validate( &seq, &limits );
 }
@@ -0,0 +1,134 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//data types and prototypes
+#include "acamera_gdc_cache.h"
+
+//system_memset
+#include "system_stdlib.h"
+#include "system_log.h"
+
+#define CACHE_FNV_OFFSET 0xcbf29ce484222325ULL
+#define CACHE_FNV_PRIME 0x100000001b3ULL
+
+u64 acamera_gdc_cache_hash( const uint32_t *sequence, uint32_t size )
+{
+    //four independent lanes over interleaved words keep the multiplier busy
+    u64 lane[4] = {CACHE_FNV_OFFSET, CACHE_FNV_OFFSET ^ 1, CACHE_FNV_OFFSET ^ 2, CACHE_FNV_OFFSET ^ 3};
+    uint32_t words = size / 4;
+    uint32_t i, l;
+    u64 hash;
+
+    for ( i = 0; i + 4 <= words; i += 4 ) {
+        for ( l = 0; l < 4; l++ ) {
+            lane[l] = ( lane[l] ^ sequence[i + l] ) * CACHE_FNV_PRIME;
+        }
+    }
+    for ( l = 0; i < words; i++, l++ ) {
+        lane[l] = ( lane[l] ^ sequence[i] ) * CACHE_FNV_PRIME;
+    }
+
+    hash = CACHE_FNV_OFFSET;
+    for ( l = 0; l < 4; l++ ) {
+        hash = ( hash ^ lane[l] ) * CACHE_FNV_PRIME;
+    }
+    return hash ^ size;
+}
+
+int acamera_gdc_cache_init( gdc_cache_t *cache, void *region_mem, uint32_t region_addr, uint32_t region_size, uint32_t num_slots, gdc_cache_load_t load )
+{
+    system_memset( cache, 0, sizeof( *cache ) );
+
+    if ( num_slots == 0 || num_slots > ACAMERA_GDC_CACHE_MAX_SLOTS || load == NULL || ( region_addr & ( ACAMERA_GDC_CACHE_SLOT_ALIGN - 1 ) ) ) {
+        LOG( LOG_ERR, "GDC config cache with %u slots at 0x%X is not supported.\n", num_slots, region_addr );
+        return -1;
+    }
+    cache->slot_size = ( region_size / num_slots ) & ~( ACAMERA_GDC_CACHE_SLOT_ALIGN - 1 );
+    if ( cache->slot_size == 0 ) {
+        LOG( LOG_ERR, "GDC config region of %u bytes is too small for %u slots.\n", region_size, num_slots );
+        return -1;
+    }
+    cache->region_mem = region_mem;
+    cache->region_addr = region_addr;
+    cache->num_slots = num_slots;
+    cache->load = load;
+    return 0;
+}
+
+void acamera_gdc_cache_invalidate( gdc_cache_t *cache )
+{
+    uint32_t i;
+    for ( i = 0; i < cache->num_slots; i++ ) {
+        cache->slots[i].size = 0;
+    }
+}
+
+int acamera_gdc_cache_lookup( gdc_cache_t *cache, u64 hash, uint32_t size, uint32_t *config_addr )
+{
+    uint32_t i;
+
+    cache->clock++;
+    for ( i = 0; i < cache->num_slots; i++ ) {
+        gdc_cache_slot_t *slot = &cache->slots[i];
+        if ( slot->size == size && slot->hash == hash ) {
+            slot->last_use = cache->clock;
+            cache->hits++;
+            *config_addr = cache->region_addr + i * cache->slot_size;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int acamera_gdc_cache_get( gdc_cache_t *cache, const uint32_t *sequence, uint32_t size, uint32_t *config_addr )
+{
+    u64 hash;
+    uint32_t i, victim = 0;
+
+    if ( size == 0 || ( size & 3 ) || size > cache->slot_size ) {
+        LOG( LOG_ERR, "GDC sequence of %u bytes does not fit a %u byte config slot.\n", size, cache->slot_size );
+        return -1;
+    }
+
+    hash = acamera_gdc_cache_hash( sequence, size );
+    if ( acamera_gdc_cache_lookup( cache, hash, size, config_addr ) == 0 ) {
+        return 0;
+    }
+
+    //free slots first, then the least recently used one
+    for ( i = 1; i < cache->num_slots; i++ ) {
+        const gdc_cache_slot_t *slot = &cache->slots[i];
+        if ( cache->slots[victim].size != 0 && ( slot->size == 0 || slot->last_use < cache->slots[victim].last_use ) ) {
+            victim = i;
+        }
+    }
+
+    //the slot is invalid while it is rewritten
+    cache->slots[victim].size = 0;
+    *config_addr = cache->region_addr + victim * cache->slot_size;
+    if ( cache->load( (uint32_t *)( (uintptr_t)cache->region_mem + victim * cache->slot_size ), (uint32_t *)sequence, size / 4 ) != size ) {
+        LOG( LOG_ERR, "GDC config slot %u load failed.\n", victim );
+        return -1;
+    }
+    cache->slots[victim].hash = hash;
+    cache->slots[victim].size = size;
+    cache->slots[victim].last_use = cache->clock;
+    cache->misses++;
+    return 1;
+}
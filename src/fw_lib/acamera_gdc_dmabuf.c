@@ -0,0 +1,91 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//data types and prototypes
+#include "acamera_gdc_dmabuf.h"
+
+#include "system_stdlib.h"
+#include "system_log.h"
+
+//bytes the block reads or writes for a plane of a frame
+static uint32_t dmabuf_plane_bytes( const gdc_settings_t *gdc_settings, uint32_t plane, int output )
+{
+    const gdc_config_t *config = &gdc_settings->gdc_config;
+    uint32_t height = output ? config->output_height : config->input_height;
+    uint32_t lineoffset = output ? gdc_settings->program.output_lineoffset[plane] : gdc_settings->program.regs[2 * plane].data;
+
+    return lineoffset * ( plane ? height >> config->div_height : height );
+}
+
+int acamera_gdc_dmabuf_import( gdc_dmabuf_frame_t *frame, const gdc_settings_t *gdc_settings, const int *fd, const uint32_t *offset, int output, uint32_t *addr )
+{
+    uint32_t base[ACAMERA_GDC_MAX_INPUT];
+    uint32_t size[ACAMERA_GDC_MAX_INPUT];
+    uint32_t i, j;
+
+    system_memset( frame, 0, sizeof( *frame ) );
+    if ( gdc_settings->program.num_planes == 0 ) {
+        return -1;
+    }
+    frame->num_planes = gdc_settings->program.num_planes;
+    for ( i = 0; i < frame->num_planes; i++ ) {
+        uint32_t start = offset ? offset[i] : 0;
+        uint32_t bytes = dmabuf_plane_bytes( gdc_settings, i, output );
+
+        //planes in the same buffer share its import
+        for ( j = 0; j < i && fd[j] != fd[i]; j++ )
+            ;
+        if ( j < i ) {
+            base[i] = base[j];
+            size[i] = size[j];
+        } else if ( system_dmabuf_import( &frame->planes[i], fd[i], output, &base[i], &size[i] ) != 0 ) {
+            break;
+        }
+        if ( start > size[i] || bytes > size[i] - start ) {
+            LOG( LOG_ERR, "GDC plane %u of %u bytes does not fit dma-buf %d of %u bytes at offset %u.\n", i, bytes, fd[i], size[i], start );
+            break;
+        }
+        addr[i] = base[i] + start;
+    }
+    if ( i < frame->num_planes ) {
+        acamera_gdc_dmabuf_release( frame );
+        return -1;
+    }
+    return 0;
+}
+
+void acamera_gdc_dmabuf_release( gdc_dmabuf_frame_t *frame )
+{
+    uint32_t i;
+
+    for ( i = 0; i < frame->num_planes; i++ ) {
+        system_dmabuf_release( frame->planes[i] );
+        frame->planes[i] = NULL;
+    }
+    frame->num_planes = 0;
+}
+
+int acamera_gdc_dmabuf_export_slot( const gdc_pool_t *pool, uint32_t slot, int *fd )
+{
+    if ( slot >= pool->num_slots ) {
+        LOG( LOG_ERR, "GDC output pool has no slot %u.\n", slot );
+        return -1;
+    }
+    return system_dmabuf_export( pool->base_addr + slot * pool->slot_size, pool->slot_size, fd ) == 0 ? 0 : -1;
+}
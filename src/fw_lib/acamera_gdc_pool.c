@@ -0,0 +1,152 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//data types and prototypes
+#include "acamera_gdc_pool.h"
+
+#include "system_stdlib.h"
+#include "system_spinlock.h"
+#include "system_log.h"
+
+#define POOL_ALIGN_UP( x ) ( ( ( x ) + ACAMERA_GDC_POOL_ALIGN - 1 ) & ~( ACAMERA_GDC_POOL_ALIGN - 1 ) )
+#define POOL_SLOT_ALIGN_UP( x ) ( ( ( x ) + ACAMERA_GDC_POOL_SLOT_ALIGN - 1 ) & ~( ACAMERA_GDC_POOL_SLOT_ALIGN - 1 ) )
+
+int acamera_gdc_pool_init( gdc_pool_t *pool, const gdc_settings_t *gdc_settings, uint32_t num_slots )
+{
+    const gdc_config_t *config = &gdc_settings->gdc_config;
+    uint32_t base = POOL_SLOT_ALIGN_UP( gdc_settings->buffer_addr );
+    uint32_t skipped = base - gdc_settings->buffer_addr;
+    uint32_t size = 0, fit, i;
+
+    system_memset( pool, 0, sizeof( *pool ) );
+    if ( num_slots > ACAMERA_GDC_POOL_MAX_SLOTS || gdc_settings->program.num_planes == 0 ) {
+        LOG( LOG_ERR, "GDC output pool with %u slots is not supported.\n", num_slots );
+        return -1;
+    }
+
+    //each plane starts on a burst boundary, the chroma planes have fewer lines
+    pool->num_planes = gdc_settings->program.num_planes;
+    for ( i = 0; i < pool->num_planes; i++ ) {
+        uint32_t lines = i ? config->output_height >> config->div_height : config->output_height;
+        pool->plane_offset[i] = size;
+        size += POOL_ALIGN_UP( gdc_settings->program.output_lineoffset[i] * lines );
+    }
+    size = POOL_SLOT_ALIGN_UP( size );
+    pool->slot_size = size;
+
+    fit = gdc_settings->buffer_size > skipped ? ( gdc_settings->buffer_size - skipped ) / size : 0;
+    if ( fit > ACAMERA_GDC_POOL_MAX_SLOTS ) {
+        fit = ACAMERA_GDC_POOL_MAX_SLOTS;
+    }
+    if ( num_slots == 0 ) {
+        num_slots = fit;
+    }
+    if ( num_slots == 0 || num_slots > fit ) {
+        LOG( LOG_ERR, "GDC output buffer of %u bytes holds %u frames of %u bytes, %u are needed.\n", gdc_settings->buffer_size, fit, size,
+             num_slots ? num_slots : 1 );
+        return -1;
+    }
+    if ( system_spinlock_init( &pool->lock ) != 0 ) {
+        LOG( LOG_ERR, "Failed to create the GDC output pool lock.\n" );
+        return -1;
+    }
+    pool->base_addr = base;
+    pool->num_slots = num_slots;
+    pool->free_mask = ( 1U << num_slots ) - 1;
+    return 0;
+}
+
+void acamera_gdc_pool_deinit( gdc_pool_t *pool )
+{
+    if ( pool->lock ) {
+        system_spinlock_destroy( pool->lock );
+        pool->lock = NULL;
+    }
+    pool->free_mask = 0;
+}
+
+int acamera_gdc_pool_acquire( gdc_pool_t *pool, uint32_t *output_addr )
+{
+    unsigned long flags;
+    uint32_t slot, i;
+
+    if ( pool->lock == NULL ) {
+        return -1;
+    }
+    flags = system_spinlock_lock( pool->lock );
+    for ( i = 0; i < pool->num_slots; i++ ) {
+        slot = ( pool->next + i ) % pool->num_slots;
+        if ( pool->free_mask & ( 1U << slot ) ) {
+            break;
+        }
+    }
+    if ( i == pool->num_slots ) {
+        pool->exhausted++;
+        system_spinlock_unlock( pool->lock, flags );
+        return -1;
+    }
+    pool->free_mask &= ~( 1U << slot );
+    pool->next = slot + 1;
+    system_spinlock_unlock( pool->lock, flags );
+
+    for ( i = 0; i < pool->num_planes; i++ ) {
+        output_addr[i] = pool->base_addr + slot * pool->slot_size + pool->plane_offset[i];
+    }
+    return 0;
+}
+
+int acamera_gdc_pool_release( gdc_pool_t *pool, uint32_t addr )
+{
+    unsigned long flags;
+    uint32_t slot;
+    int rc = 0;
+
+    if ( pool->lock == NULL || addr < pool->base_addr || ( addr - pool->base_addr ) % pool->slot_size ) {
+        LOG( LOG_ERR, "GDC output buffer 0x%x is not in the pool.\n", addr );
+        return -1;
+    }
+    slot = ( addr - pool->base_addr ) / pool->slot_size;
+
+    flags = system_spinlock_lock( pool->lock );
+    if ( slot >= pool->num_slots || ( pool->free_mask & ( 1U << slot ) ) ) {
+        rc = -1;
+    } else {
+        pool->free_mask |= 1U << slot;
+    }
+    system_spinlock_unlock( pool->lock, flags );
+
+    if ( rc != 0 ) {
+        LOG( LOG_ERR, "GDC output buffer 0x%x is not in use.\n", addr );
+    }
+    return rc;
+}
+
+uint32_t acamera_gdc_pool_free_slots( gdc_pool_t *pool )
+{
+    unsigned long flags;
+    uint32_t mask;
+
+    if ( pool->lock == NULL ) {
+        return 0;
+    }
+    flags = system_spinlock_lock( pool->lock );
+    mask = pool->free_mask;
+    system_spinlock_unlock( pool->lock, flags );
+    return __builtin_popcount( mask );
+}
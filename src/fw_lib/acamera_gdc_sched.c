@@ -0,0 +1,294 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+
+//data types and prototypes
+#include "acamera_gdc_sched.h"
+
+#include "system_stdlib.h"
+#include "system_spinlock.h"
+#include "system_fence.h"
+#include "system_log.h"
+
+//sched_dispatch keeps a bit per queued job and per stream
+#if ACAMERA_GDC_SCHED_QUEUE_SIZE > 32 || ACAMERA_GDC_SCHED_MAX_STREAMS > 32
+#error "the scheduler queue and the streams must fit a 32 bit mask"
+#endif
+
+//least loaded core with room for another job, NULL when all are full
+static gdc_sched_core_t *sched_pick_core( gdc_sched_t *sched )
+{
+    gdc_sched_core_t *best = NULL;
+    uint32_t core;
+
+    for ( core = 0; core < sched->num_cores; core++ ) {
+        gdc_sched_core_t *c = &sched->cores[core];
+        if ( c->in_flight < ACAMERA_GDC_SCHED_CORE_DEPTH && ( best == NULL || c->in_flight < best->in_flight ) ) {
+            best = c;
+        }
+    }
+    return best;
+}
+
+//hands waiting frames to the least loaded cores with room, called with the scheduler lock held.
+//a frame waiting for its input holds back the later frames of its stream only, the other
+//streams go past it and the queue is compacted around the frames taken out of the middle
+static void sched_dispatch( gdc_sched_t *sched )
+{
+    uint32_t blocked = 0;   //bit n set once a frame of stream n waits for its input
+    uint32_t taken = 0;     //bit n set for the job at tail + n handed on
+    uint32_t pos, i, kept;
+
+    for ( i = 0; sched->tail + i != sched->head; i++ ) {
+        gdc_job_t *job = &sched->queue[( sched->tail + i ) & ( ACAMERA_GDC_SCHED_QUEUE_SIZE - 1 )];
+        gdc_sched_core_t *best;
+
+        if ( blocked & ( 1 << job->stream ) ) {
+            continue;
+        }
+        if ( job->in_fence ) {
+            int32_t fence = system_fence_status( job->in_fence );
+            if ( fence == 0 ) {
+                blocked |= 1 << job->stream;
+                continue;
+            }
+            if ( fence < 0 ) {
+                gdc_sched_stream_t *stream = &sched->streams[job->stream];
+                uint32_t slot = job->frame & ( ACAMERA_GDC_SCHED_WINDOW - 1 );
+                //the input was never produced, the frame fails without running
+                acamera_gdc_status_decode( stream->jobs[slot].status.raw | ACAMERA_GDC_STATUS_FENCE_ERROR, &stream->jobs[slot].status );
+                if ( stream->parts[slot] ) {
+                    stream->parts[slot]--;
+                }
+                taken |= 1 << i;
+                continue;
+            }
+        }
+        best = sched_pick_core( sched );
+        if ( best == NULL ) {
+            break;
+        }
+        if ( acamera_gdc_submit( best->settings, job ) != 0 ) {
+            LOG( LOG_ERR, "GDC core %d refused a frame.\n", (int)( best - sched->cores ) );
+            break;
+        }
+        best->in_flight++;
+        taken |= 1 << i;
+    }
+
+    //the frames left keep their order and move up to the head
+    pos = sched->head;
+    kept = 0;
+    for ( i = sched->head - sched->tail; i-- > 0; ) {
+        if ( !( taken & ( 1 << i ) ) ) {
+            pos--;
+            kept++;
+            if ( pos != sched->tail + i ) {
+                sched->queue[pos & ( ACAMERA_GDC_SCHED_QUEUE_SIZE - 1 )] = sched->queue[( sched->tail + i ) & ( ACAMERA_GDC_SCHED_QUEUE_SIZE - 1 )];
+            }
+        }
+    }
+    sched->tail = sched->head - kept;
+}
+
+//runs the done callback for every frame whose predecessors were delivered and releases the lock,
+//the callbacks run unlocked so they can submit the next frames
+static void sched_deliver( gdc_sched_t *sched, unsigned long flags )
+{
+    uint32_t s, delivered;
+
+    //frames completed meanwhile are picked up by the caller already delivering
+    if ( sched->delivering ) {
+        system_spinlock_unlock( sched->lock, flags );
+        return;
+    }
+    sched->delivering = 1;
+    do {
+        delivered = 0;
+        for ( s = 0; s < ACAMERA_GDC_SCHED_MAX_STREAMS; s++ ) {
+            gdc_sched_stream_t *stream = &sched->streams[s];
+            uint32_t slot = stream->next_done & ( ACAMERA_GDC_SCHED_WINDOW - 1 );
+            gdc_job_t job;
+
+            if ( stream->next_done == stream->next_frame || stream->parts[slot] ) {
+                continue;
+            }
+            job = stream->jobs[slot];
+            stream->next_done++;
+            delivered++;
+
+            system_spinlock_unlock( sched->lock, flags );
+            if ( job.out_fence ) {
+                system_fence_signal( job.out_fence, job.status.error );
+            }
+            if ( sched->done ) {
+                sched->done( sched->done_ctx, &job );
+            }
+            system_fence_put( job.in_fence );
+            system_fence_put( job.out_fence );
+            flags = system_spinlock_lock( sched->lock );
+        }
+    } while ( delivered );
+    sched->delivering = 0;
+    system_spinlock_unlock( sched->lock, flags );
+}
+
+//job_done callback of every core, run by acamera_gdc_complete_frames from the interrupt thread, the
+//polling caller or the watchdog thread, never in hard interrupt context, so the frames it delivers
+//may take other locks and submit the next frames
+static void sched_job_done( void *ctx, const gdc_job_t *job )
+{
+    gdc_sched_core_t *core = ctx;
+    gdc_sched_t *sched = core->sched;
+    gdc_sched_stream_t *stream = &sched->streams[job->stream % ACAMERA_GDC_SCHED_MAX_STREAMS];
+    uint32_t slot = job->frame & ( ACAMERA_GDC_SCHED_WINDOW - 1 );
+    unsigned long flags;
+
+    flags = system_spinlock_lock( sched->lock );
+    //a job submitted to the core directly is not tracked
+    if ( core->in_flight == 0 ) {
+        system_spinlock_unlock( sched->lock, flags );
+        LOG( LOG_WARNING, "GDC job completed outside the scheduler.\n" );
+        return;
+    }
+    core->in_flight--;
+    core->frames++;
+    //all parts are started with the same line offsets
+    system_memcpy( stream->jobs[slot].output_lineoffset, job->output_lineoffset, sizeof( job->output_lineoffset ) );
+    //the frame reports the errors of all its parts
+    acamera_gdc_status_decode( stream->jobs[slot].status.raw | job->status.raw, &stream->jobs[slot].status );
+    if ( stream->parts[slot] ) {
+        stream->parts[slot]--;
+    }
+    sched_dispatch( sched );
+    sched_deliver( sched, flags );
+}
+
+//an in-fence signalled, the frames waiting for it can start
+static void sched_fence_ready( void *param )
+{
+    gdc_sched_t *sched = param;
+    unsigned long flags;
+
+    flags = system_spinlock_lock( sched->lock );
+    sched_dispatch( sched );
+    sched_deliver( sched, flags );
+}
+
+int acamera_gdc_sched_init( gdc_sched_t *sched, gdc_settings_t **cores, uint32_t num_cores, gdc_sched_done_t done, void *ctx )
+{
+    uint32_t i;
+
+    system_memset( sched, 0, sizeof( *sched ) );
+    if ( num_cores == 0 || num_cores > ACAMERA_GDC_SCHED_MAX_CORES ) {
+        LOG( LOG_ERR, "GDC scheduler for %u cores is not supported.\n", num_cores );
+        return -1;
+    }
+    if ( system_spinlock_init( &sched->lock ) != 0 ) {
+        LOG( LOG_ERR, "Failed to create the GDC scheduler lock.\n" );
+        return -1;
+    }
+    sched->num_cores = num_cores;
+    sched->done = done;
+    sched->done_ctx = ctx;
+    for ( i = 0; i < num_cores; i++ ) {
+        sched->cores[i].sched = sched;
+        sched->cores[i].settings = cores[i];
+        cores[i]->job_done = sched_job_done;
+        cores[i]->job_done_ctx = &sched->cores[i];
+    }
+    return 0;
+}
+
+void acamera_gdc_sched_deinit( gdc_sched_t *sched )
+{
+    uint32_t i, s;
+
+    //frames never delivered fail their out-fences
+    for ( s = 0; s < ACAMERA_GDC_SCHED_MAX_STREAMS; s++ ) {
+        gdc_sched_stream_t *stream = &sched->streams[s];
+        for ( ; stream->next_done != stream->next_frame; stream->next_done++ ) {
+            gdc_job_t *job = &stream->jobs[stream->next_done & ( ACAMERA_GDC_SCHED_WINDOW - 1 )];
+            if ( job->out_fence ) {
+                system_fence_signal( job->out_fence, 1 );
+            }
+            system_fence_put( job->in_fence );
+            system_fence_put( job->out_fence );
+        }
+    }
+    sched->head = sched->tail = 0;
+    for ( i = 0; i < sched->num_cores; i++ ) {
+        sched->cores[i].settings->job_done = NULL;
+        sched->cores[i].settings->job_done_ctx = NULL;
+    }
+    sched->num_cores = 0;
+    if ( sched->lock ) {
+        system_spinlock_destroy( sched->lock );
+        sched->lock = NULL;
+    }
+}
+
+int acamera_gdc_sched_submit_split( gdc_sched_t *sched, uint32_t stream, const gdc_job_t *parts, uint32_t num_parts )
+{
+    gdc_sched_stream_t *s;
+    unsigned long flags;
+    uint32_t slot, i;
+    u64 now;
+
+    if ( stream >= ACAMERA_GDC_SCHED_MAX_STREAMS || sched->lock == NULL || num_parts == 0 || num_parts > ACAMERA_GDC_SCHED_MAX_CORES ) {
+        LOG( LOG_ERR, "GDC stream %u with %u parts is not available.\n", stream, num_parts );
+        return -1;
+    }
+    s = &sched->streams[stream];
+
+    flags = system_spinlock_lock( sched->lock );
+    if ( s->next_frame - s->next_done >= ACAMERA_GDC_SCHED_WINDOW || sched->head - sched->tail + num_parts > ACAMERA_GDC_SCHED_QUEUE_SIZE ) {
+        system_spinlock_unlock( sched->lock, flags );
+        LOG( LOG_ERR, "GDC stream %u has too many frames outstanding.\n", stream );
+        return -1;
+    }
+    slot = s->next_frame & ( ACAMERA_GDC_SCHED_WINDOW - 1 );
+    now = system_time_ns();
+    for ( i = 0; i < num_parts; i++ ) {
+        gdc_job_t *queued = &sched->queue[sched->head & ( ACAMERA_GDC_SCHED_QUEUE_SIZE - 1 )];
+        *queued = parts[i];
+        queued->stream = stream;
+        queued->frame = s->next_frame;
+        //the wait for a core counts as queueing
+        queued->submit_ns = now;
+        sched->head++;
+    }
+    s->jobs[slot] = sched->queue[( sched->head - num_parts ) & ( ACAMERA_GDC_SCHED_QUEUE_SIZE - 1 )];
+    system_memset( &s->jobs[slot].status, 0, sizeof( s->jobs[slot].status ) );
+    s->parts[slot] = num_parts;
+    s->next_frame++;
+    if ( parts[0].in_fence ) {
+        //an input already there is picked up by the dispatch below
+        system_fence_notify( parts[0].in_fence, sched_fence_ready, sched );
+    }
+    sched_dispatch( sched );
+    //frames failed by their in-fence are delivered at once
+    sched_deliver( sched, flags );
+    return 0;
+}
+
+int acamera_gdc_sched_submit( gdc_sched_t *sched, uint32_t stream, const gdc_job_t *job )
+{
+    return acamera_gdc_sched_submit_split( sched, stream, job, 1 );
+}
@@ -0,0 +1,363 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//data types and prototypes
+#include "acamera_gdc_seq.h"
+
+//system_memset
+#include "system_stdlib.h"
+#include "system_log.h"
+
+#define SEQ_HEADER_LENGTH( h ) ( ( h ) & 0xff )
+#define SEQ_HEADER_TYPE( h ) ( ( ( h ) >> 8 ) & 0xff )
+#define SEQ_MESH_WORDS( len ) ( ( ( len ) + 1 ) * 16 )
+
+//tile cache granularity and the extra source samples read around a tile by the 4 tap filters
+#define SEQ_CLUSTER_SIZE 16
+#define SEQ_FILTER_BEFORE 1
+#define SEQ_FILTER_AFTER ( ACAMERA_GDC_SEQ_TAPS - 2 )
+
+static int seq_parse_bank( gdc_seq_t *seq, uint32_t pos, uint32_t len )
+{
+    uint32_t phase, tap;
+    gdc_seq_bank_t *bank;
+
+    if ( len != ACAMERA_GDC_SEQ_PHASES + 1 ) {
+        LOG( LOG_ERR, "GDC sequence filter bank at word %u has %u words.\n", pos, len );
+        return -1;
+    }
+    if ( seq->num_banks >= ACAMERA_GDC_SEQ_MAX_BANKS ) {
+        LOG( LOG_ERR, "GDC sequence has more than %d filter banks.\n", ACAMERA_GDC_SEQ_MAX_BANKS );
+        return -1;
+    }
+
+    bank = &seq->banks[seq->num_banks++];
+    bank->index = seq->words[pos + 1];
+    for ( phase = 0; phase < ACAMERA_GDC_SEQ_PHASES; phase++ ) {
+        uint32_t word = seq->words[pos + 2 + phase];
+        for ( tap = 0; tap < ACAMERA_GDC_SEQ_TAPS; tap++ ) {
+            bank->taps[phase][tap] = (int8_t)( word >> ( tap * 8 ) );
+        }
+    }
+    return 0;
+}
+
+int acamera_gdc_seq_parse( const void *data, uint32_t size, gdc_seq_t *seq )
+{
+    uint32_t pos = 0;
+
+    system_memset( seq, 0, sizeof( *seq ) );
+    if ( data == NULL || size == 0 || ( size & 3 ) || ( (uintptr_t)data & 3 ) ) {
+        LOG( LOG_ERR, "GDC sequence must be a non empty array of 32 bit words.\n" );
+        return -1;
+    }
+    seq->words = (const uint32_t *)data;
+    seq->num_words = size / 4;
+
+    while ( pos < seq->num_words ) {
+        uint32_t header = seq->words[pos];
+        uint32_t len = SEQ_HEADER_LENGTH( header );
+
+        switch ( SEQ_HEADER_TYPE( header ) ) {
+        case ACAMERA_GDC_SEQ_TYPE_FILTER_BANK:
+            if ( pos + 1 + len > seq->num_words || seq_parse_bank( seq, pos, len ) != 0 ) {
+                return -1;
+            }
+            pos += 1 + len;
+            break;
+
+        case ACAMERA_GDC_SEQ_TYPE_MESH:
+            if ( seq->mesh_offset != 0 || pos + 1 + SEQ_MESH_WORDS( len ) > seq->num_words ) {
+                LOG( LOG_ERR, "GDC sequence mesh at word %u is duplicated or truncated.\n", pos );
+                return -1;
+            }
+            seq->mesh_offset = pos + 1;
+            seq->mesh_words = SEQ_MESH_WORDS( len );
+            pos += 1 + seq->mesh_words;
+            break;
+
+        case ACAMERA_GDC_SEQ_TYPE_TILES: {
+            gdc_seq_tile_list_t *list;
+            if ( seq->num_tile_lists >= ACAMERA_GDC_SEQ_MAX_TILE_LISTS || pos + 1 + len > seq->num_words ) {
+                LOG( LOG_ERR, "GDC sequence tile list at word %u is not supported.\n", pos );
+                return -1;
+            }
+            list = &seq->tile_lists[seq->num_tile_lists++];
+            list->offset = pos;
+            list->num_preamble = len;
+            list->preamble = &seq->words[pos + 1];
+            pos += 1 + len;
+            list->tiles = &seq->words[pos];
+            while ( pos + ACAMERA_GDC_SEQ_TILE_WORDS <= seq->num_words && ( seq->words[pos] & ACAMERA_GDC_SEQ_TILE_MARKER ) ) {
+                list->num_tiles++;
+                pos += ACAMERA_GDC_SEQ_TILE_WORDS;
+            }
+            if ( pos < seq->num_words && ( seq->words[pos] & ACAMERA_GDC_SEQ_TILE_MARKER ) ) {
+                LOG( LOG_ERR, "GDC sequence tile at word %u is truncated.\n", pos );
+                return -1;
+            }
+            break;
+        }
+
+        default:
+            LOG( LOG_ERR, "GDC sequence has unknown section 0x%X at word %u.\n", header, pos );
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void acamera_gdc_seq_tile_decode( const gdc_seq_tile_list_t *list, uint32_t index, gdc_seq_tile_t *tile )
+{
+    const uint32_t *w = &list->tiles[index * ACAMERA_GDC_SEQ_TILE_WORDS];
+
+    tile->flags = w[1] & 0x3;
+    tile->channel_mask = ( w[1] >> 12 ) & 0x7;
+    tile->hbank = ( w[1] >> 16 ) & 0x7;
+    tile->vbank = ( w[1] >> 20 ) & 0x7;
+    tile->out_x = w[2] & 0xffff;
+    tile->out_y = w[2] >> 16;
+    tile->out_width = w[3] & 0xffff;
+    tile->out_height = w[3] >> 16;
+    tile->in_x = w[4] & 0xffff;
+    tile->in_y = w[4] >> 16;
+    tile->in_width = w[5] & 0xffff;
+    tile->in_height = w[5] >> 16;
+}
+
+const gdc_seq_bank_t *acamera_gdc_seq_bank( const gdc_seq_t *seq, uint32_t index )
+{
+    uint32_t i;
+    for ( i = 0; i < seq->num_banks; i++ ) {
+        if ( seq->banks[i].index == index ) {
+            return &seq->banks[i];
+        }
+    }
+    return NULL;
+}
+
+void acamera_gdc_seq_plane_size( const gdc_seq_limits_t *limits, uint32_t channel, int output, uint32_t *width, uint32_t *height )
+{
+    uint32_t w = output ? limits->output_width : limits->input_width;
+    uint32_t h = output ? limits->output_height : limits->input_height;
+
+    if ( channel != 0 ) {
+        w >>= limits->div_width;
+        h >>= limits->div_height;
+        //semiplanar uv keeps the line length of the y plane
+        if ( limits->total_planes == 2 )
+            w /= 2;
+    }
+    *width = w;
+    *height = h;
+}
+
+//number of tile cache clusters covered by the input rectangle and its filter support
+static uint32_t seq_tile_clusters( const gdc_seq_tile_t *tile )
+{
+    uint32_t x0 = tile->in_x > SEQ_FILTER_BEFORE ? tile->in_x - SEQ_FILTER_BEFORE : 0;
+    uint32_t y0 = tile->in_y > SEQ_FILTER_BEFORE ? tile->in_y - SEQ_FILTER_BEFORE : 0;
+    uint32_t x1 = tile->in_x + tile->in_width + SEQ_FILTER_AFTER;
+    uint32_t y1 = tile->in_y + tile->in_height + SEQ_FILTER_AFTER;
+
+    return ( ( x1 + SEQ_CLUSTER_SIZE - 1 ) / SEQ_CLUSTER_SIZE - x0 / SEQ_CLUSTER_SIZE ) *
+           ( ( y1 + SEQ_CLUSTER_SIZE - 1 ) / SEQ_CLUSTER_SIZE - y0 / SEQ_CLUSTER_SIZE );
+}
+
+static int seq_validate_tile( const gdc_seq_t *seq, const gdc_seq_limits_t *limits, const gdc_seq_tile_t *tile, uint32_t list, uint32_t index )
+{
+    uint32_t c, w, h, clusters;
+
+    if ( tile->channel_mask == 0 || tile->out_width == 0 || tile->out_height == 0 || tile->in_width == 0 || tile->in_height == 0 ) {
+        LOG( LOG_ERR, "GDC sequence list %u tile %u is empty.\n", list, index );
+        return -1;
+    }
+    if ( acamera_gdc_seq_bank( seq, tile->hbank ) == NULL || acamera_gdc_seq_bank( seq, tile->vbank ) == NULL ) {
+        LOG( LOG_ERR, "GDC sequence list %u tile %u uses missing filter bank %u/%u.\n", list, index, tile->hbank, tile->vbank );
+        return -1;
+    }
+    if ( limits->num_filter_banks && ( tile->hbank >= limits->num_filter_banks || tile->vbank >= limits->num_filter_banks ) ) {
+        LOG( LOG_ERR, "GDC sequence list %u tile %u uses filter bank %u/%u, block has %u.\n", list, index, tile->hbank, tile->vbank, limits->num_filter_banks );
+        return -1;
+    }
+    clusters = seq_tile_clusters( tile );
+    if ( limits->tile_cache_clusters && clusters > limits->tile_cache_clusters ) {
+        LOG( LOG_ERR, "GDC sequence list %u tile %u needs %u tile cache clusters, block has %u.\n", list, index, clusters, limits->tile_cache_clusters );
+        return -1;
+    }
+
+    for ( c = 0; c < ACAMERA_GDC_SEQ_MAX_CHANNELS; c++ ) {
+        if ( !( tile->channel_mask & ( 1 << c ) ) )
+            continue;
+        //channels 1 and 2 share the second plane of two plane formats
+        if ( c >= limits->total_planes && !( c == 2 && limits->total_planes == 2 ) ) {
+            LOG( LOG_ERR, "GDC sequence list %u tile %u addresses channel %u, frame has %u planes.\n", list, index, c, limits->total_planes );
+            return -1;
+        }
+        acamera_gdc_seq_plane_size( limits, c, 1, &w, &h );
+        if ( tile->out_x + tile->out_width > w || tile->out_y + tile->out_height > h ) {
+            LOG( LOG_ERR, "GDC sequence list %u tile %u output %ux%u+%u+%u exceeds %ux%u.\n", list, index,
+                 tile->out_width, tile->out_height, tile->out_x, tile->out_y, w, h );
+            return -1;
+        }
+        acamera_gdc_seq_plane_size( limits, c, 0, &w, &h );
+        if ( tile->in_x + tile->in_width > w || tile->in_y + tile->in_height > h ) {
+            LOG( LOG_ERR, "GDC sequence list %u tile %u input %ux%u+%u+%u exceeds %ux%u.\n", list, index,
+                 tile->in_width, tile->in_height, tile->in_x, tile->in_y, w, h );
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int acamera_gdc_seq_validate( const gdc_seq_t *seq, const gdc_seq_limits_t *limits )
+{
+    uint32_t i, t;
+
+    if ( limits->total_planes == 0 || limits->total_planes > ACAMERA_GDC_SEQ_MAX_CHANNELS ) {
+        LOG( LOG_ERR, "GDC sequence checked against %u planes.\n", limits->total_planes );
+        return -1;
+    }
+    if ( seq->num_tile_lists == 0 ) {
+        LOG( LOG_ERR, "GDC sequence has no tiles.\n" );
+        return -1;
+    }
+    if ( limits->num_filter_banks && seq->num_banks > limits->num_filter_banks ) {
+        LOG( LOG_ERR, "GDC sequence has %u filter banks, block has %u.\n", seq->num_banks, limits->num_filter_banks );
+        return -1;
+    }
+    for ( i = 0; i < seq->num_banks; i++ ) {
+        uint32_t phase;
+        for ( phase = 0; phase < ACAMERA_GDC_SEQ_PHASES; phase++ ) {
+            const int8_t *taps = seq->banks[i].taps[phase];
+            if ( taps[0] + taps[1] + taps[2] + taps[3] != ( 1 << ACAMERA_GDC_SEQ_TAP_SHIFT ) ) {
+                LOG( LOG_ERR, "GDC sequence filter bank %u phase %u is not normalised.\n", seq->banks[i].index, phase );
+                return -1;
+            }
+        }
+    }
+
+    for ( i = 0; i < seq->num_tile_lists; i++ ) {
+        for ( t = 0; t < seq->tile_lists[i].num_tiles; t++ ) {
+            gdc_seq_tile_t tile;
+            acamera_gdc_seq_tile_decode( &seq->tile_lists[i], t, &tile );
+            if ( seq_validate_tile( seq, limits, &tile, i, t ) != 0 ) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+//appends a string at pos, returns the new position or size + 1 when it does not fit
+static uint32_t seq_append( char *name, uint32_t pos, uint32_t size, const char *str )
+{
+    while ( *str && pos < size ) {
+        name[pos++] = *str++;
+    }
+    return *str ? size + 1 : pos;
+}
+
+static uint32_t seq_append_uint( char *name, uint32_t pos, uint32_t size, uint32_t value )
+{
+    char digits[11];
+    uint32_t i = sizeof( digits ) - 1;
+
+    digits[i] = '\0';
+    do {
+        digits[--i] = '0' + value % 10;
+        value /= 10;
+    } while ( value );
+    return seq_append( name, pos, size, &digits[i] );
+}
+
+int acamera_gdc_seq_firmware_name( char *name, uint32_t size, const char *format, uint32_t width, uint32_t height )
+{
+    uint32_t pos;
+
+    if ( size == 0 ) {
+        return -1;
+    }
+    //keep the last byte for the terminator
+    size--;
+    pos = seq_append( name, 0, size, ACAMERA_GDC_SEQ_FIRMWARE_DIR "/" );
+    pos = seq_append( name, pos, size, format );
+    pos = seq_append( name, pos, size, "_" );
+    pos = seq_append_uint( name, pos, size, width );
+    pos = seq_append( name, pos, size, "x" );
+    pos = seq_append_uint( name, pos, size, height );
+    pos = seq_append( name, pos, size, ".bin" );
+    if ( pos > size ) {
+        name[size] = '\0';
+        LOG( LOG_ERR, "GDC sequence name for %s does not fit %u bytes.\n", format, size + 1 );
+        return -1;
+    }
+    name[pos] = '\0';
+    return 0;
+}
+
+uint32_t acamera_gdc_seq_split( const gdc_seq_t *seq, uint8_t channel_mask, uint32_t *out, uint32_t out_size )
+{
+    uint32_t pos = 0, len = 0, kept = 0;
+    uint32_t l, t;
+
+    //sections in stream order, the tile lists are the only ones that are filtered
+    for ( l = 0; l <= seq->num_tile_lists; l++ ) {
+        const gdc_seq_tile_list_t *list = l < seq->num_tile_lists ? &seq->tile_lists[l] : NULL;
+        uint32_t end = list ? list->offset : seq->num_words;
+        uint32_t list_start;
+
+        if ( len + ( end - pos ) > out_size / 4 ) {
+            return 0;
+        }
+        system_memcpy( &out[len], &seq->words[pos], ( end - pos ) * 4 );
+        len += end - pos;
+        if ( list == NULL ) {
+            break;
+        }
+
+        list_start = len;
+        if ( len + 1 + list->num_preamble > out_size / 4 ) {
+            return 0;
+        }
+        system_memcpy( &out[len], &seq->words[list->offset], ( 1 + list->num_preamble ) * 4 );
+        len += 1 + list->num_preamble;
+        for ( t = 0; t < list->num_tiles; t++ ) {
+            gdc_seq_tile_t tile;
+            acamera_gdc_seq_tile_decode( list, t, &tile );
+            if ( !( tile.channel_mask & channel_mask ) ) {
+                continue;
+            }
+            if ( len + ACAMERA_GDC_SEQ_TILE_WORDS > out_size / 4 ) {
+                return 0;
+            }
+            system_memcpy( &out[len], &list->tiles[t * ACAMERA_GDC_SEQ_TILE_WORDS], ACAMERA_GDC_SEQ_TILE_WORDS * 4 );
+            len += ACAMERA_GDC_SEQ_TILE_WORDS;
+            kept++;
+        }
+        //a list without tiles of the channels is left out
+        if ( len == list_start + 1 + list->num_preamble ) {
+            len = list_start;
+        }
+        pos = list->offset + 1 + list->num_preamble + list->num_tiles * ACAMERA_GDC_SEQ_TILE_WORDS;
+    }
+
+    return kept ? len * 4 : 0;
+}
@@ -0,0 +1,82 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//data types and prototypes
+#include "acamera_gdc_stats.h"
+
+#include "system_stdlib.h"
+
+static const char *const stats_stage_names[ACAMERA_GDC_STAGES] = {
+    "queue",
+    "process",
+    "complete",
+    "total",
+};
+
+void acamera_gdc_stats_add( gdc_hist_t *hist, u64 ns )
+{
+    uint32_t bucket = ns ? 63 - __builtin_clzll( ns ) : 0;
+
+    if ( bucket >= ACAMERA_GDC_STATS_BUCKETS ) {
+        bucket = ACAMERA_GDC_STATS_BUCKETS - 1;
+    }
+    hist->buckets[bucket]++;
+    hist->count++;
+    if ( ns > hist->max_ns ) {
+        hist->max_ns = ns;
+    }
+}
+
+u64 acamera_gdc_stats_percentile( const gdc_hist_t *hist, uint32_t percent )
+{
+    uint32_t rank, seen = 0, i;
+    u64 bound;
+
+    if ( hist->count == 0 ) {
+        return 0;
+    }
+    //rank of the latency counted last, rounded up so p100 is the longest one, in 32 bit to avoid a 64 bit division
+    rank = hist->count / 100 * percent + ( hist->count % 100 * percent + 99 ) / 100;
+    if ( rank == 0 ) {
+        rank = 1;
+    }
+    for ( i = 0; i < ACAMERA_GDC_STATS_BUCKETS - 1; i++ ) {
+        seen += hist->buckets[i];
+        if ( seen >= rank ) {
+            break;
+        }
+    }
+    bound = ( 2ULL << i ) - 1;
+    return bound < hist->max_ns ? bound : hist->max_ns;
+}
+
+void acamera_gdc_stats_get( const gdc_stats_t *stats, gdc_stats_t *copy )
+{
+    system_memcpy( copy, stats, sizeof( *copy ) );
+}
+
+void acamera_gdc_stats_clear( gdc_stats_t *stats )
+{
+    system_memset( stats, 0, sizeof( *stats ) );
+}
+
+const char *acamera_gdc_stats_stage_name( uint32_t stage )
+{
+    return stage < ACAMERA_GDC_STAGES ? stats_stage_names[stage] : "unknown";
+}
@@ -0,0 +1,137 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+
+//data types and prototypes
+#include "acamera_gdc_upload.h"
+
+//system_memcpy, system_dma_memcpy, system_crc32
+#include "system_stdlib.h"
+#include "system_log.h"
+
+static const char *const upload_verify_name[GDC_UPLOAD_VERIFY_MAX] = {"none", "sampled", "crc", "full"};
+
+const char *acamera_gdc_upload_verify_name( gdc_upload_verify_t verify )
+{
+    return verify < GDC_UPLOAD_VERIFY_MAX ? upload_verify_name[verify] : "unknown";
+}
+
+int acamera_gdc_upload_init( gdc_upload_t *upload, gdc_upload_verify_t verify, uint8_t use_dma )
+{
+    system_memset( upload, 0, sizeof( *upload ) );
+    if ( verify >= GDC_UPLOAD_VERIFY_MAX ) {
+        LOG( LOG_ERR, "GDC upload verification %d is not supported.\n", verify );
+        return -1;
+    }
+    upload->verify = verify;
+    //the channel is taken once, not on every upload
+    if ( use_dma && system_dma_memcpy_init() == 0 ) {
+        upload->use_dma = 1;
+    } else if ( use_dma ) {
+        LOG( LOG_INFO, "No dma engine for GDC config uploads, the cpu copies them.\n" );
+    }
+    return 0;
+}
+
+void acamera_gdc_upload_deinit( gdc_upload_t *upload )
+{
+    if ( upload->use_dma ) {
+        system_dma_memcpy_deinit();
+        upload->use_dma = 0;
+    }
+}
+
+static int upload_check_word( const uint32_t *dst, const uint32_t *src, uint32_t index )
+{
+    if ( dst[index] != src[index] ) {
+        LOG( LOG_CRIT, "GDC config mismatch index %u, values %X vs %X\n", index, dst[index], src[index] );
+        return -1;
+    }
+    return 0;
+}
+
+static int upload_verify( gdc_upload_t *upload, const uint32_t *dst, const uint32_t *src, uint32_t words )
+{
+    uint32_t i, stride, phase;
+    uint32_t crc_src, crc_dst;
+
+    switch ( upload->verify ) {
+    case GDC_UPLOAD_VERIFY_SAMPLED:
+        //one word per stride, the offset inside the stride changes with every upload
+        stride = words / ACAMERA_GDC_UPLOAD_SAMPLES;
+        if ( stride == 0 ) {
+            stride = 1;
+        }
+        phase = upload->uploads % stride;
+        for ( i = phase; i < words; i += stride ) {
+            if ( upload_check_word( dst, src, i ) != 0 ) {
+                return -1;
+            }
+        }
+        return upload_check_word( dst, src, words - 1 );
+
+    case GDC_UPLOAD_VERIFY_CRC:
+        crc_src = system_crc32( 0, src, words * 4 );
+        crc_dst = system_crc32( 0, dst, words * 4 );
+        if ( crc_src != crc_dst ) {
+            LOG( LOG_CRIT, "GDC config crc mismatch, values %X vs %X\n", crc_dst, crc_src );
+            return -1;
+        }
+        return 0;
+
+    case GDC_UPLOAD_VERIFY_FULL:
+        for ( i = 0; i < words; i++ ) {
+            if ( upload_check_word( dst, src, i ) != 0 ) {
+                return -1;
+            }
+        }
+        return 0;
+
+    default:
+        return 0;
+    }
+}
+
+uint32_t acamera_gdc_upload( gdc_upload_t *upload, uint32_t *dst, const uint32_t *src, uint32_t words )
+{
+    int rc = -1;
+
+    if ( words == 0 ) {
+        return 0;
+    }
+    upload->uploads++;
+
+    if ( upload->use_dma && system_dma_memcpy( dst, src, words * 4 ) == 0 ) {
+        upload->dma_copies++;
+        rc = upload_verify( upload, dst, src, words );
+        if ( rc != 0 ) {
+            LOG( LOG_WARNING, "GDC config dma copy failed verification, copying again.\n" );
+        }
+    }
+    if ( rc != 0 ) {
+        system_memcpy( dst, src, words * 4 );
+        rc = upload_verify( upload, dst, src, words );
+    }
+
+    if ( rc != 0 ) {
+        upload->failures++;
+        return 0;
+    }
+    return words * 4;
+}
@@ -17,17 +17,24 @@
 *
 */
 
+#include "acamera_driver_config.h"
 #include "system_control.h"
 #include "system_interrupts.h"
 
 
 void bsp_init( void )
 {
-    system_interrupts_init(0);
+    int core;
+    for ( core = 0; core < GDC_NUM_CORES; core++ ) {
+        system_interrupts_init(core);
+    }
 }
 
 void bsp_destroy( void )
 {
-	system_interrupts_disable(0);
-	system_interrupts_deinit(0);
+    int core;
+    for ( core = 0; core < GDC_NUM_CORES; core++ ) {
+        system_interrupts_disable(core);
+        system_interrupts_deinit(core);
+    }
 }
@@ -0,0 +1,118 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+
+#include "system_debugfs.h"
+#include "system_log.h"
+
+typedef struct system_debugfs {
+    struct dentry *dentry;
+    system_debugfs_show_t show;
+    system_debugfs_clear_t clear;
+    void *param;
+} system_debugfs_t;
+
+//the gdc directory may already exist for the mmio trace, it is removed with the last file when created here
+static struct dentry *debugfs_dir = NULL;
+static int debugfs_dir_owned = 0;
+static uint32_t debugfs_files = 0;
+
+static int debugfs_show( struct seq_file *m, void *v )
+{
+    system_debugfs_t *f = m->private;
+    char *buf = kmalloc( SYSTEM_DEBUGFS_SIZE, GFP_KERNEL );
+    uint32_t len;
+
+    if ( buf == NULL )
+        return -ENOMEM;
+    len = f->show( f->param, buf, SYSTEM_DEBUGFS_SIZE );
+    seq_write( m, buf, len < SYSTEM_DEBUGFS_SIZE ? len : SYSTEM_DEBUGFS_SIZE );
+    kfree( buf );
+    return 0;
+}
+
+static int debugfs_open( struct inode *inode, struct file *file )
+{
+    return single_open( file, debugfs_show, inode->i_private );
+}
+
+static ssize_t debugfs_write( struct file *file, const char __user *buf, size_t count, loff_t *ppos )
+{
+    system_debugfs_t *f = ( (struct seq_file *)file->private_data )->private;
+
+    if ( f->clear )
+        f->clear( f->param );
+    return count;
+}
+
+static const struct file_operations debugfs_fops = {
+    .owner = THIS_MODULE,
+    .open = debugfs_open,
+    .read = seq_read,
+    .write = debugfs_write,
+    .llseek = seq_lseek,
+    .release = single_release,
+};
+
+int32_t system_debugfs_create( sys_debugfs *file, const char *name, system_debugfs_show_t show, system_debugfs_clear_t clear, void *param )
+{
+    system_debugfs_t *f = kzalloc( sizeof( system_debugfs_t ), GFP_KERNEL );
+
+    *file = NULL;
+    if ( f == NULL )
+        return -1;
+    if ( debugfs_dir == NULL ) {
+        debugfs_dir = debugfs_lookup( "gdc", NULL );
+        debugfs_dir_owned = debugfs_dir == NULL;
+        if ( debugfs_dir == NULL )
+            debugfs_dir = debugfs_create_dir( "gdc", NULL );
+    }
+    f->show = show;
+    f->clear = clear;
+    f->param = param;
+    f->dentry = debugfs_create_file( name, clear ? 0600 : 0400, debugfs_dir, f, &debugfs_fops );
+    if ( IS_ERR_OR_NULL( f->dentry ) ) {
+        LOG( LOG_ERR, "Failed to create debugfs file %s", name );
+        kfree( f );
+        return -1;
+    }
+    debugfs_files++;
+    *file = f;
+    return 0;
+}
+
+void system_debugfs_remove( sys_debugfs file )
+{
+    system_debugfs_t *f = file;
+
+    if ( f == NULL )
+        return;
+    debugfs_remove( f->dentry );
+    kfree( f );
+    if ( --debugfs_files == 0 ) {
+        if ( debugfs_dir_owned )
+            debugfs_remove_recursive( debugfs_dir );
+        else
+            dput( debugfs_dir );
+        debugfs_dir = NULL;
+    }
+}
@@ -0,0 +1,303 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include <linux/slab.h>
+#include <linux/list.h>
+#include <linux/mutex.h>
+#include <linux/dma-mapping.h>
+#include <linux/dmaengine.h>
+#include <linux/scatterlist.h>
+#include <linux/completion.h>
+#include <linux/vmalloc.h>
+#include <linux/of_reserved_mem.h>
+
+#include "system_dma_alloc.h"
+#include "system_log.h"
+
+typedef struct system_dma_mem {
+    struct list_head list;
+    void *virt;
+    dma_addr_t dma;
+    uint32_t size;
+} system_dma_mem_t;
+
+static struct device *dma_alloc_dev;
+static LIST_HEAD( dma_alloc_list );
+static DEFINE_MUTEX( dma_alloc_lock );
+static uint32_t dma_alloc_count;
+static uint32_t dma_alloc_bytes;
+
+int32_t system_dma_alloc_init( void *device )
+{
+    struct device *dev = device;
+    int rc;
+
+    //a shared-dma-pool memory-region, the logic tile ddr for example, replaces cma for this device
+    rc = of_reserved_mem_device_init( dev );
+    if ( rc != 0 && rc != -ENODEV ) {
+        LOG( LOG_ERR, "Failed to use the memory-region of the gdc, rc = %d", rc );
+    }
+    if ( dma_set_mask_and_coherent( dev, DMA_BIT_MASK( 32 ) ) != 0 ) {
+        LOG( LOG_ERR, "GDC cannot address memory below 4 GiB" );
+        return -1;
+    }
+    dma_alloc_dev = dev;
+    return 0;
+}
+
+void system_dma_alloc_deinit( void )
+{
+    if ( dma_alloc_dev ) {
+        if ( dma_alloc_count ) {
+            LOG( LOG_ERR, "%u GDC allocations of %u bytes are still held", dma_alloc_count, dma_alloc_bytes );
+        }
+        of_reserved_mem_device_release( dma_alloc_dev );
+        dma_alloc_dev = NULL;
+    }
+}
+
+int32_t system_dma_alloc( sys_dma_mem *mem, uint32_t size, void **virt, uint32_t *addr )
+{
+    system_dma_mem_t *m;
+
+    *mem = NULL;
+    if ( dma_alloc_dev == NULL || size == 0 ) {
+        return -1;
+    }
+    m = kzalloc( sizeof( system_dma_mem_t ), GFP_KERNEL );
+    if ( m == NULL ) {
+        return -1;
+    }
+    m->size = PAGE_ALIGN( size );
+    m->virt = dma_alloc_coherent( dma_alloc_dev, m->size, &m->dma, GFP_KERNEL );
+    if ( m->virt == NULL ) {
+        LOG( LOG_ERR, "Failed to allocate %u bytes of GDC memory", size );
+        kfree( m );
+        return -1;
+    }
+
+    mutex_lock( &dma_alloc_lock );
+    list_add_tail( &m->list, &dma_alloc_list );
+    dma_alloc_count++;
+    dma_alloc_bytes += m->size;
+    mutex_unlock( &dma_alloc_lock );
+
+    *virt = m->virt;
+    *addr = (uint32_t)m->dma;
+    *mem = m;
+    return 0;
+}
+
+void system_dma_free( sys_dma_mem mem )
+{
+    system_dma_mem_t *m = mem;
+    if ( m == NULL ) {
+        return;
+    }
+    mutex_lock( &dma_alloc_lock );
+    list_del( &m->list );
+    dma_alloc_count--;
+    dma_alloc_bytes -= m->size;
+    mutex_unlock( &dma_alloc_lock );
+
+    dma_free_coherent( dma_alloc_dev, m->size, m->virt, m->dma );
+    kfree( m );
+}
+
+int32_t system_dma_alloc_lookup( uint32_t addr, uint32_t size, void **virt )
+{
+    system_dma_mem_t *m;
+    int32_t rc = -1;
+
+    mutex_lock( &dma_alloc_lock );
+    list_for_each_entry( m, &dma_alloc_list, list ) {
+        if ( addr >= m->dma && addr - m->dma < m->size && size <= m->size - ( addr - m->dma ) ) {
+            *virt = (uint8_t *)m->virt + ( addr - m->dma );
+            rc = 0;
+            break;
+        }
+    }
+    mutex_unlock( &dma_alloc_lock );
+    return rc;
+}
+
+int32_t system_dma_alloc_find( uint32_t addr, uint32_t size, void **base_virt, uint32_t *base_addr, uint32_t *base_size )
+{
+    system_dma_mem_t *m;
+    int32_t rc = -1;
+
+    mutex_lock( &dma_alloc_lock );
+    list_for_each_entry( m, &dma_alloc_list, list ) {
+        if ( addr >= m->dma && addr - m->dma < m->size && size <= m->size - ( addr - m->dma ) ) {
+            *base_virt = m->virt;
+            *base_addr = (uint32_t)m->dma;
+            *base_size = m->size;
+            rc = 0;
+            break;
+        }
+    }
+    mutex_unlock( &dma_alloc_lock );
+    return rc;
+}
+
+void system_dma_alloc_usage( uint32_t *count, uint32_t *bytes )
+{
+    mutex_lock( &dma_alloc_lock );
+    *count = dma_alloc_count;
+    *bytes = dma_alloc_bytes;
+    mutex_unlock( &dma_alloc_lock );
+}
+
+//channel of the dma engine taken for system_dma_memcpy, shared by the users of system_dma_memcpy_init
+static struct dma_chan *dma_copy_chan;
+static uint32_t dma_copy_users;
+
+//source pages one copy may span, larger sources are copied by the cpu
+#define DMA_COPY_MAX_PAGES 16
+
+//every fragment of a copy is queued, the last one completes this
+static void dma_copy_done( void *param )
+{
+    complete( param );
+}
+
+int32_t system_dma_memcpy_init( void )
+{
+    dma_cap_mask_t mask;
+    int32_t rc = 0;
+
+    mutex_lock( &dma_alloc_lock );
+    if ( dma_copy_chan == NULL ) {
+        dma_cap_zero( mask );
+        dma_cap_set( DMA_MEMCPY, mask );
+        dma_copy_chan = dma_request_channel( mask, NULL, NULL );
+    }
+    if ( dma_copy_chan ) {
+        dma_copy_users++;
+    } else {
+        rc = -1;
+    }
+    mutex_unlock( &dma_alloc_lock );
+    return rc;
+}
+
+void system_dma_memcpy_deinit( void )
+{
+    mutex_lock( &dma_alloc_lock );
+    if ( dma_copy_users && --dma_copy_users == 0 ) {
+        dma_release_channel( dma_copy_chan );
+        dma_copy_chan = NULL;
+    }
+    mutex_unlock( &dma_alloc_lock );
+}
+
+//the engine reads the source pages in place, the firmware data and static buffers are vmalloc memory
+int32_t system_dma_memcpy( void *dst, const void *src, uint32_t size )
+{
+    DECLARE_COMPLETION_ONSTACK( done );
+    struct dma_async_tx_descriptor *tx;
+    struct dma_chan *chan;
+    struct device *dev;
+    dma_addr_t src_dma[DMA_COPY_MAX_PAGES];
+    uint32_t src_len[DMA_COPY_MAX_PAGES];
+    dma_addr_t dst_dma;
+    dma_cookie_t cookie = -EINVAL;
+    system_dma_mem_t *m, *found = NULL;
+    struct sg_table sgt;
+    uint32_t pages = 0, pos, i;
+    int32_t result = -1;
+
+    //the allocation stays while it is written
+    mutex_lock( &dma_alloc_lock );
+    chan = dma_copy_chan;
+    if ( chan == NULL ) {
+        goto unlock;
+    }
+    dev = chan->device->dev;
+    list_for_each_entry( m, &dma_alloc_list, list ) {
+        if ( (uint8_t *)dst >= (uint8_t *)m->virt && (uint8_t *)dst - (uint8_t *)m->virt + size <= m->size ) {
+            found = m;
+            break;
+        }
+    }
+    m = found;
+    if ( m == NULL ) {
+        goto unlock;
+    }
+    //the allocation as the engine sees it, it has to be contiguous for one transfer
+    if ( dma_get_sgtable( dma_alloc_dev, &sgt, m->virt, m->dma, m->size ) != 0 ) {
+        goto unlock;
+    }
+    if ( dma_map_sg( dev, sgt.sgl, sgt.orig_nents, DMA_FROM_DEVICE ) != 1 ) {
+        goto free_sgt;
+    }
+    dst_dma = sg_dma_address( sgt.sgl ) + ( (uint8_t *)dst - (uint8_t *)m->virt );
+
+    //one transfer per source page, only the last one raises an interrupt
+    for ( pos = 0; pos < size; pos += PAGE_SIZE - offset_in_page( (const uint8_t *)src + pos ) ) {
+        const uint8_t *p = (const uint8_t *)src + pos;
+        uint32_t len = min_t( uint32_t, size - pos, PAGE_SIZE - offset_in_page( p ) );
+        struct page *page = virt_addr_valid( p ) ? virt_to_page( p ) : vmalloc_to_page( p );
+        unsigned long flags = DMA_CTRL_ACK;
+
+        if ( page == NULL || pages == DMA_COPY_MAX_PAGES ) {
+            goto terminate;
+        }
+        src_dma[pages] = dma_map_page( dev, page, offset_in_page( p ), len, DMA_TO_DEVICE );
+        if ( dma_mapping_error( dev, src_dma[pages] ) ) {
+            goto terminate;
+        }
+        src_len[pages++] = len;
+        if ( pos + len == size ) {
+            flags |= DMA_PREP_INTERRUPT;
+        }
+        tx = dmaengine_prep_dma_memcpy( chan, dst_dma + pos, src_dma[pages - 1], len, flags );
+        if ( tx == NULL ) {
+            goto terminate;
+        }
+        if ( pos + len == size ) {
+            tx->callback = dma_copy_done;
+            tx->callback_param = &done;
+        }
+        cookie = dmaengine_submit( tx );
+        if ( dma_submit_error( cookie ) ) {
+            goto terminate;
+        }
+    }
+
+    dma_async_issue_pending( chan );
+    if ( wait_for_completion_timeout( &done, msecs_to_jiffies( 100 ) ) != 0 &&
+         dmaengine_tx_status( chan, cookie, NULL ) == DMA_COMPLETE ) {
+        result = 0;
+    }
+terminate:
+    //fragments already queued must not run once their pages are unmapped
+    if ( result != 0 && pages ) {
+        dmaengine_terminate_sync( chan );
+    }
+    for ( i = 0; i < pages; i++ ) {
+        dma_unmap_page( dev, src_dma[i], src_len[i], DMA_TO_DEVICE );
+    }
+    dma_unmap_sg( dev, sgt.sgl, sgt.orig_nents, DMA_FROM_DEVICE );
+free_sgt:
+    sg_free_table( &sgt );
+unlock:
+    mutex_unlock( &dma_alloc_lock );
+    return result;
+}
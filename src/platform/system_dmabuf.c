@@ -0,0 +1,381 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include <linux/version.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
+#include <linux/fcntl.h>
+#include <linux/dma-buf.h>
+#include <linux/dma-mapping.h>
+#include <linux/scatterlist.h>
+#include <linux/llist.h>
+#include <linux/workqueue.h>
+
+#include "system_dmabuf.h"
+#include "system_gdc_io.h"
+#include "system_dma_alloc.h"
+#include "system_log.h"
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION( 6, 13, 0 )
+MODULE_IMPORT_NS( "DMA_BUF" );
+#elif LINUX_VERSION_CODE >= KERNEL_VERSION( 5, 16, 0 )
+MODULE_IMPORT_NS( DMA_BUF );
+#endif
+
+//buffer of another device mapped for the gdc
+typedef struct system_dmabuf {
+    struct dma_buf *dmabuf;
+    struct dma_buf_attachment *attach;
+    struct sg_table *sgt;
+    enum dma_data_direction dir;
+    struct llist_node release;
+} system_dmabuf_t;
+
+//range of the gdc memory lent out to other devices
+typedef struct system_dmabuf_export {
+    void *virt;             //cpu address of memory from system_dma_alloc, NULL for the ddr window
+    dma_addr_t addr;        //gdc address
+    phys_addr_t phys;       //ddr window only
+    uint32_t size;
+    //the system_dma_alloc allocation holding the range, the dma api only takes whole allocations
+    void *base_virt;
+    dma_addr_t base_addr;
+    uint32_t base_size;
+    struct sg_table base_sgt;   //pages of the whole allocation
+} system_dmabuf_export_t;
+
+static struct device *dmabuf_dev;
+
+//imports released from atomic context, unmapped by dmabuf_release_work
+static LLIST_HEAD( dmabuf_released );
+static void dmabuf_release_worker( struct work_struct *work );
+static DECLARE_WORK( dmabuf_release_work, dmabuf_release_worker );
+
+void system_dmabuf_init( void *device )
+{
+    if ( device ) {
+        dmabuf_dev = device;
+    }
+}
+
+static struct sg_table *dmabuf_map( struct dma_buf_attachment *attach, enum dma_data_direction dir )
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION( 6, 2, 0 )
+    return dma_buf_map_attachment_unlocked( attach, dir );
+#else
+    return dma_buf_map_attachment( attach, dir );
+#endif
+}
+
+static void dmabuf_unmap( struct dma_buf_attachment *attach, struct sg_table *sgt, enum dma_data_direction dir )
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION( 6, 2, 0 )
+    dma_buf_unmap_attachment_unlocked( attach, sgt, dir );
+#else
+    dma_buf_unmap_attachment( attach, sgt, dir );
+#endif
+}
+
+//the block has one address register per plane, the mapping must be a single range
+static int32_t dmabuf_contiguous( struct sg_table *sgt, dma_addr_t *addr, u64 *size )
+{
+    struct scatterlist *sg;
+    dma_addr_t next = 0;
+    unsigned int i;
+
+    *size = 0;
+    for_each_sgtable_dma_sg( sgt, sg, i ) {
+        if ( *size == 0 ) {
+            *addr = sg_dma_address( sg );
+        } else if ( sg_dma_address( sg ) != next ) {
+            return -1;
+        }
+        next = sg_dma_address( sg ) + sg_dma_len( sg );
+        *size += sg_dma_len( sg );
+    }
+    return *size ? 0 : -1;
+}
+
+int32_t system_dmabuf_import( sys_dmabuf *buf, int fd, int write, uint32_t *addr, uint32_t *size )
+{
+    system_dmabuf_t *b;
+    dma_addr_t dma = 0;
+    u64 len;
+
+    *buf = NULL;
+    if ( dmabuf_dev == NULL ) {
+        LOG( LOG_ERR, "No device to attach dma-buf %d to", fd );
+        return -1;
+    }
+    b = kzalloc( sizeof( system_dmabuf_t ), GFP_KERNEL );
+    if ( b == NULL ) {
+        return -1;
+    }
+    b->dir = write ? DMA_FROM_DEVICE : DMA_TO_DEVICE;
+
+    b->dmabuf = dma_buf_get( fd );
+    if ( IS_ERR( b->dmabuf ) ) {
+        LOG( LOG_ERR, "File descriptor %d is not a dma-buf", fd );
+        goto free_buf;
+    }
+    b->attach = dma_buf_attach( b->dmabuf, dmabuf_dev );
+    if ( IS_ERR( b->attach ) ) {
+        LOG( LOG_ERR, "Failed to attach dma-buf %d to GDC", fd );
+        goto put_buf;
+    }
+    b->sgt = dmabuf_map( b->attach, b->dir );
+    if ( IS_ERR_OR_NULL( b->sgt ) ) {
+        LOG( LOG_ERR, "Failed to map dma-buf %d for GDC", fd );
+        goto detach;
+    }
+    if ( dmabuf_contiguous( b->sgt, &dma, &len ) != 0 || dma + len - 1 > U32_MAX ) {
+        LOG( LOG_ERR, "dma-buf %d is not a contiguous range below 4 GiB for GDC", fd );
+        goto unmap;
+    }
+
+    *addr = (uint32_t)dma;
+    *size = (uint32_t)len;
+    *buf = b;
+    return 0;
+
+unmap:
+    dmabuf_unmap( b->attach, b->sgt, b->dir );
+detach:
+    dma_buf_detach( b->dmabuf, b->attach );
+put_buf:
+    dma_buf_put( b->dmabuf );
+free_buf:
+    kfree( b );
+    return -1;
+}
+
+static void dmabuf_free( system_dmabuf_t *b )
+{
+    dmabuf_unmap( b->attach, b->sgt, b->dir );
+    dma_buf_detach( b->dmabuf, b->attach );
+    dma_buf_put( b->dmabuf );
+    kfree( b );
+}
+
+static void dmabuf_release_worker( struct work_struct *work )
+{
+    system_dmabuf_t *b, *next;
+
+    llist_for_each_entry_safe( b, next, llist_del_all( &dmabuf_released ), release ) {
+        dmabuf_free( b );
+    }
+}
+
+void system_dmabuf_release( sys_dmabuf buf )
+{
+    system_dmabuf_t *b = buf;
+    if ( b == NULL ) {
+        return;
+    }
+    //the completion of a job can run in the watchdog timer, unmapping takes the reservation lock
+    if ( in_task() ) {
+        dmabuf_free( b );
+    } else if ( llist_add( &b->release, &dmabuf_released ) ) {
+        schedule_work( &dmabuf_release_work );
+    }
+}
+
+void system_dmabuf_flush( void )
+{
+    flush_work( &dmabuf_release_work );
+}
+
+//entries of the pages of the whole allocation that cover the exported range
+static int dmabuf_export_pages( system_dmabuf_export_t *e, struct sg_table *sgt )
+{
+    struct scatterlist *sg, *dst;
+    uint64_t start = e->addr - e->base_addr;
+    uint64_t end = start + e->size;
+    uint64_t pos = 0;
+    unsigned int i, n = 0;
+
+    for_each_sgtable_sg( &e->base_sgt, sg, i ) {
+        if ( pos < end && pos + sg->length > start ) {
+            n++;
+        }
+        pos += sg->length;
+    }
+    if ( n == 0 || sg_alloc_table( sgt, n, GFP_KERNEL ) != 0 ) {
+        return -1;
+    }
+    dst = sgt->sgl;
+    pos = 0;
+    for_each_sgtable_sg( &e->base_sgt, sg, i ) {
+        uint64_t from = max( pos, start );
+        uint64_t to = min( pos + sg->length, end );
+        if ( from < to ) {
+            sg_set_page( dst, sg_page( sg ), to - from, sg->offset + ( from - pos ) );
+            dst = sg_next( dst );
+        }
+        pos += sg->length;
+    }
+    return 0;
+}
+
+//allocated memory is described by the gdc device and mapped again for the importer
+static struct sg_table *dmabuf_export_map( struct dma_buf_attachment *attach, enum dma_data_direction dir )
+{
+    system_dmabuf_export_t *e = attach->dmabuf->priv;
+    struct sg_table *sgt;
+    dma_addr_t dma;
+
+    sgt = kzalloc( sizeof( struct sg_table ), GFP_KERNEL );
+    if ( sgt == NULL ) {
+        return ERR_PTR( -ENOMEM );
+    }
+    if ( e->virt ) {
+        if ( dmabuf_export_pages( e, sgt ) != 0 ) {
+            kfree( sgt );
+            return ERR_PTR( -ENOMEM );
+        }
+        if ( dma_map_sgtable( attach->dev, sgt, dir, 0 ) != 0 ) {
+            sg_free_table( sgt );
+            kfree( sgt );
+            return ERR_PTR( -EIO );
+        }
+        return sgt;
+    }
+
+    //the ddr window has no struct pages, importers map it as a device resource
+    if ( sg_alloc_table( sgt, 1, GFP_KERNEL ) != 0 ) {
+        kfree( sgt );
+        return ERR_PTR( -ENOMEM );
+    }
+    dma = dma_map_resource( attach->dev, e->phys, e->size, dir, 0 );
+    if ( dma_mapping_error( attach->dev, dma ) ) {
+        sg_free_table( sgt );
+        kfree( sgt );
+        return ERR_PTR( -EIO );
+    }
+    sg_dma_address( sgt->sgl ) = dma;
+    sg_dma_len( sgt->sgl ) = e->size;
+    return sgt;
+}
+
+static void dmabuf_export_unmap( struct dma_buf_attachment *attach, struct sg_table *sgt, enum dma_data_direction dir )
+{
+    system_dmabuf_export_t *e = attach->dmabuf->priv;
+
+    if ( e->virt ) {
+        dma_unmap_sgtable( attach->dev, sgt, dir, 0 );
+    } else {
+        dma_unmap_resource( attach->dev, sg_dma_address( sgt->sgl ), e->size, dir, 0 );
+    }
+    sg_free_table( sgt );
+    kfree( sgt );
+}
+
+static int dmabuf_export_mmap( struct dma_buf *dmabuf, struct vm_area_struct *vma )
+{
+    system_dmabuf_export_t *e = dmabuf->priv;
+    unsigned long len = vma->vm_end - vma->vm_start;
+
+    if ( vma->vm_pgoff >= PFN_UP( e->size ) || len > ( (unsigned long)PFN_UP( e->size ) - vma->vm_pgoff ) << PAGE_SHIFT ) {
+        return -EINVAL;
+    }
+    if ( e->virt ) {
+        //the range is an offset into the allocation, which is what the dma api maps
+        vma->vm_pgoff += PFN_DOWN( e->addr - e->base_addr );
+        return dma_mmap_coherent( dmabuf_dev, vma, e->base_virt, e->base_addr, e->base_size );
+    }
+    vma->vm_page_prot = pgprot_writecombine( vma->vm_page_prot );
+    return remap_pfn_range( vma, vma->vm_start, PHYS_PFN( e->phys ) + vma->vm_pgoff, len, vma->vm_page_prot );
+}
+
+static void dmabuf_export_release( struct dma_buf *dmabuf )
+{
+    system_dmabuf_export_t *e = dmabuf->priv;
+
+    if ( e->virt ) {
+        sg_free_table( &e->base_sgt );
+    }
+    kfree( e );
+}
+
+static const struct dma_buf_ops dmabuf_export_ops = {
+    .map_dma_buf = dmabuf_export_map,
+    .unmap_dma_buf = dmabuf_export_unmap,
+    .mmap = dmabuf_export_mmap,
+    .release = dmabuf_export_release,
+};
+
+int32_t system_dmabuf_export( uint32_t addr, uint32_t size, int *fd )
+{
+    DEFINE_DMA_BUF_EXPORT_INFO( info );
+    system_gdc_io_ctx_t *ctx = system_gdc_io_get( 0 );
+    system_dmabuf_export_t *e;
+    struct dma_buf *dmabuf;
+    void *virt = NULL;
+    int rc;
+
+    //memory from system_dma_alloc, otherwise an offset into the ddr window of the device
+    if ( size == 0 || !PAGE_ALIGNED( addr ) || !PAGE_ALIGNED( size ) ||
+         ( system_dma_alloc_lookup( addr, size, &virt ) != 0 &&
+           ( ctx == NULL || ctx->ddr_base == NULL || addr >= ctx->ddr_size || size > ctx->ddr_size - addr ) ) ) {
+        LOG( LOG_ERR, "GDC memory 0x%x of %u bytes cannot be exported", addr, size );
+        return -1;
+    }
+    e = kzalloc( sizeof( system_dmabuf_export_t ), GFP_KERNEL );
+    if ( e == NULL ) {
+        return -1;
+    }
+    e->virt = virt;
+    e->addr = addr;
+    e->phys = virt ? 0 : ctx->ddr_phys + addr;
+    e->size = size;
+    //the pages are described once for the whole allocation, every mapping takes its range from them
+    if ( virt ) {
+        uint32_t base_addr;
+        if ( system_dma_alloc_find( addr, size, &e->base_virt, &base_addr, &e->base_size ) != 0 ||
+             dma_get_sgtable( dmabuf_dev, &e->base_sgt, e->base_virt, base_addr, e->base_size ) != 0 ) {
+            LOG( LOG_ERR, "GDC memory 0x%x has no page list to export", addr );
+            kfree( e );
+            return -1;
+        }
+        e->base_addr = base_addr;
+    }
+
+    info.ops = &dmabuf_export_ops;
+    info.size = size;
+    info.flags = O_RDWR;
+    info.priv = e;
+    dmabuf = dma_buf_export( &info );
+    if ( IS_ERR( dmabuf ) ) {
+        LOG( LOG_ERR, "Failed to export GDC memory 0x%x", addr );
+        if ( virt ) {
+            sg_free_table( &e->base_sgt );
+        }
+        kfree( e );
+        return -1;
+    }
+    rc = dma_buf_fd( dmabuf, O_CLOEXEC );
+    if ( rc < 0 ) {
+        //the release op frees e
+        dma_buf_put( dmabuf );
+        return -1;
+    }
+    *fd = rc;
+    return 0;
+}
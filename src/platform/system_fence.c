@@ -0,0 +1,206 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include <linux/slab.h>
+#include <linux/file.h>
+#include <linux/fcntl.h>
+#include <linux/llist.h>
+#include <linux/workqueue.h>
+#include <linux/dma-fence.h>
+#include <linux/sync_file.h>
+
+#include "system_fence.h"
+#include "system_log.h"
+
+//fence signalled by the driver, base first so the default release frees it
+typedef struct gdc_dma_fence {
+    struct dma_fence base;
+    spinlock_t lock;
+} gdc_dma_fence_t;
+
+typedef struct system_fence {
+    struct dma_fence *fence;
+    struct dma_fence_cb cb;
+    struct work_struct work;    //runs the handler
+    system_fence_handler_t handler;
+    void *param;
+    int armed;                  //cb is on the fence
+    struct llist_node release;
+} system_fence_t;
+
+//references dropped from atomic context, freed by fence_release_work
+static LLIST_HEAD( fence_released );
+static void fence_release_worker( struct work_struct *work );
+static DECLARE_WORK( fence_release_work, fence_release_worker );
+
+static const char *gdc_fence_name( struct dma_fence *fence )
+{
+    return "gdc";
+}
+
+static const struct dma_fence_ops gdc_fence_ops = {
+    .get_driver_name = gdc_fence_name,
+    .get_timeline_name = gdc_fence_name,
+};
+
+static void fence_handler_work( struct work_struct *work )
+{
+    system_fence_t *f = container_of( work, system_fence_t, work );
+    f->handler( f->param );
+}
+
+//runs under the lock of the fence in the context of whoever signals it
+static void fence_signalled( struct dma_fence *fence, struct dma_fence_cb *cb )
+{
+    system_fence_t *f = container_of( cb, system_fence_t, cb );
+    schedule_work( &f->work );
+}
+
+static system_fence_t *fence_wrap( struct dma_fence *fence )
+{
+    system_fence_t *f = kzalloc( sizeof( system_fence_t ), GFP_KERNEL );
+    if ( f == NULL ) {
+        dma_fence_put( fence );
+        return NULL;
+    }
+    f->fence = fence;
+    INIT_WORK( &f->work, fence_handler_work );
+    return f;
+}
+
+int32_t system_fence_import( sys_fence *fence, int fd )
+{
+    struct dma_fence *f = sync_file_get_fence( fd );
+
+    *fence = NULL;
+    if ( f == NULL ) {
+        LOG( LOG_ERR, "File descriptor %d is not a sync_file", fd );
+        return -1;
+    }
+    *fence = fence_wrap( f );
+    return *fence ? 0 : -1;
+}
+
+int32_t system_fence_create( sys_fence *fence )
+{
+    gdc_dma_fence_t *f = kzalloc( sizeof( gdc_dma_fence_t ), GFP_KERNEL );
+
+    *fence = NULL;
+    if ( f == NULL ) {
+        return -1;
+    }
+    spin_lock_init( &f->lock );
+    //a context of its own, fences of different streams signal in any order
+    dma_fence_init( &f->base, &gdc_fence_ops, &f->lock, dma_fence_context_alloc( 1 ), 1 );
+    *fence = fence_wrap( &f->base );
+    return *fence ? 0 : -1;
+}
+
+int32_t system_fence_dup( sys_fence fence, sys_fence *dup )
+{
+    *dup = fence_wrap( dma_fence_get( ( (system_fence_t *)fence )->fence ) );
+    return *dup ? 0 : -1;
+}
+
+int32_t system_fence_export( sys_fence fence, int *fd )
+{
+    struct sync_file *sync_file;
+    int rc = get_unused_fd_flags( O_CLOEXEC );
+
+    if ( rc < 0 ) {
+        return -1;
+    }
+    sync_file = sync_file_create( ( (system_fence_t *)fence )->fence );
+    if ( sync_file == NULL ) {
+        put_unused_fd( rc );
+        return -1;
+    }
+    fd_install( rc, sync_file->file );
+    *fd = rc;
+    return 0;
+}
+
+void system_fence_signal( sys_fence fence, int error )
+{
+    struct dma_fence *f = ( (system_fence_t *)fence )->fence;
+    if ( error ) {
+        dma_fence_set_error( f, -EIO );
+    }
+    dma_fence_signal( f );
+}
+
+int32_t system_fence_status( sys_fence fence )
+{
+    int rc = dma_fence_get_status( ( (system_fence_t *)fence )->fence );
+    return rc < 0 ? -1 : rc;
+}
+
+int32_t system_fence_notify( sys_fence fence, system_fence_handler_t handler, void *param )
+{
+    system_fence_t *f = fence;
+
+    f->handler = handler;
+    f->param = param;
+    if ( dma_fence_add_callback( f->fence, &f->cb, fence_signalled ) != 0 ) {
+        return -1;
+    }
+    f->armed = 1;
+    return 0;
+}
+
+static void fence_free( system_fence_t *f )
+{
+    if ( f->armed ) {
+        dma_fence_remove_callback( f->fence, &f->cb );
+        //the handler may drop the handle it was called for
+        if ( current_work() != &f->work ) {
+            cancel_work_sync( &f->work );
+        }
+    }
+    dma_fence_put( f->fence );
+    kfree( f );
+}
+
+static void fence_release_worker( struct work_struct *work )
+{
+    system_fence_t *f, *next;
+
+    llist_for_each_entry_safe( f, next, llist_del_all( &fence_released ), release ) {
+        fence_free( f );
+    }
+}
+
+void system_fence_put( sys_fence fence )
+{
+    system_fence_t *f = fence;
+    if ( f == NULL ) {
+        return;
+    }
+    //cancelling the handler sleeps, completions can run in the watchdog timer
+    if ( in_task() ) {
+        fence_free( f );
+    } else if ( llist_add( &f->release, &fence_released ) ) {
+        schedule_work( &fence_release_work );
+    }
+}
+
+void system_fence_flush( void )
+{
+    flush_work( &fence_release_work );
+}
@@ -0,0 +1,58 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include <linux/device.h>
+#include <linux/firmware.h>
+
+#include "system_firmware.h"
+#include "system_log.h"
+
+static struct device *firmware_dev = NULL;
+
+void system_firmware_init( void *context )
+{
+    if ( context ) {
+        firmware_dev = context;
+    }
+}
+
+int32_t system_firmware_request( system_firmware_t *fw, const char *name )
+{
+    const struct firmware *blob = NULL;
+    int rc = request_firmware( &blob, name, firmware_dev );
+
+    if ( rc != 0 ) {
+        LOG( LOG_ERR, "Cannot load firmware %s, error %d.\n", name, rc );
+        return -1;
+    }
+    fw->data = blob->data;
+    fw->size = blob->size;
+    fw->priv = (void *)blob;
+    return 0;
+}
+
+void system_firmware_release( system_firmware_t *fw )
+{
+    if ( fw->priv ) {
+        release_firmware( (const struct firmware *)fw->priv );
+    }
+    fw->data = NULL;
+    fw->size = 0;
+    fw->priv = NULL;
+}
@@ -16,48 +16,165 @@
 * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 *
 */
-
+#include "acamera_driver_config.h"
 #include "system_log.h"
+#include "system_gdc_io_ctx.h"
+#include "system_gdc_shadow.h"
+#include "system_gdc_trace.h"
 
 #include <asm/io.h>
 
-static void *p_hw_base = NULL;
-
-int32_t init_gdc_io( resource_size_t addr , resource_size_t size )
+int32_t system_gdc_io_open( uint32_t instance, resource_size_t addr, resource_size_t size, uint32_t num_cores )
 {
-    p_hw_base = ioremap( addr, size );
+    system_gdc_io_ctx_t *ctx;
 
-    if(!p_hw_base){
-    	return -1;
+    if ( instance >= SYSTEM_GDC_IO_MAX_INSTANCES || num_cores > SYSTEM_GDC_IO_MAX_CORES || size > SYSTEM_GDC_IO_OFFSET_MASK + 1 ) {
+        LOG( LOG_ERR, "GDC io instance %u with %u cores and 0x%llx bytes is not supported", instance, num_cores, (u64)size );
+        return -1;
+    }
+    ctx = &system_gdc_io_ctx[instance];
+    if ( ctx->hw_base != NULL ) {
+        LOG( LOG_ERR, "GDC io instance %u is already open", instance );
+        return -1;
+    }
+    ctx->hw_base = ioremap( addr, size );
+    if ( !ctx->hw_base ) {
+        return -1;
     }
+#if GDC_MMIO_TRACE
+    if ( system_gdc_io_opened() == 1 && system_gdc_trace_init() != 0 ) {
+        LOG( LOG_WARNING, "Register accesses are not recorded" );
+    }
+#endif
+    ctx->hw_size = size;
+    ctx->num_cores = num_cores;
+    system_gdc_io_number_cores( instance );
+
+    return 0;
+}
+
+int32_t system_gdc_io_map_ddr( uint32_t instance, phys_addr_t addr, uint32_t size )
+{
+    system_gdc_io_ctx_t *ctx = system_gdc_io_get( instance );
 
+    if ( ctx == NULL || ctx->ddr_base != NULL ) {
+        return -1;
+    }
+    ctx->ddr_base = ioremap( addr, size );
+    if ( ctx->ddr_base == NULL ) {
+        return -1;
+    }
+    ctx->ddr_phys = addr;
+    ctx->ddr_size = size;
     return 0;
 }
 
+void system_gdc_io_close( uint32_t instance )
+{
+    system_gdc_io_ctx_t *ctx = system_gdc_io_get( instance );
+
+    if ( ctx == NULL ) {
+        return;
+    }
+    if ( ctx->ddr_base ) {
+        iounmap( ctx->ddr_base );
+    }
+    iounmap( ctx->hw_base );
+    system_memset( ctx, 0, sizeof( *ctx ) );
+#if GDC_MMIO_TRACE
+    if ( system_gdc_io_opened() == 0 ) {
+        system_gdc_trace_deinit();
+    }
+#endif
+}
+
+//single device setup of the original driver: instance 0 with all the cores
+int32_t init_gdc_io( resource_size_t addr , resource_size_t size )
+{
+    return system_gdc_io_open( 0, addr, size, GDC_NUM_CORES );
+}
+
 void close_gdc_io( void )
 {
+    uint32_t instance;
+
     LOG( LOG_DEBUG, "IO functionality has been closed" );
-    iounmap( p_hw_base );
+    system_gdc_shadow_clear();
+    for ( instance = 0; instance < SYSTEM_GDC_IO_MAX_INSTANCES; instance++ ) {
+        system_gdc_io_close( instance );
+    }
 }
 
 uint32_t system_gdc_read_32( uint32_t addr )
 {
   	uint32_t result = 0;
-    if ( p_hw_base != NULL ) {
-        result = ioread32( p_hw_base + addr );
+    void *ptr;
+    SYSTEM_GDC_TRACE_START( t0 );
+    if ( system_gdc_shadow_read( addr, &result ) == 0 ) {
+        SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_SHADOW, addr, result, t0 );
+        return result;
+    }
+    ptr = system_gdc_io_ptr( addr );
+    if ( ptr != NULL ) {
+        result = ioread32( ptr );
     } else {
         LOG( LOG_ERR, "Failed to read memory from address %d. Base pointer is null ", addr );
     }
+    SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_READ, addr, result, t0 );
     return result;
 }
 
 void system_gdc_write_32( uint32_t addr, uint32_t data )
 {
-    if ( p_hw_base != NULL ) {
-        void *ptr = (void *)( p_hw_base + addr );
+    void *ptr = system_gdc_io_ptr( addr );
+    if ( ptr != NULL ) {
+        SYSTEM_GDC_TRACE_START( t0 );
         iowrite32( data, ptr );
+        SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_WRITE, addr, data, t0 );
+        system_gdc_shadow_write( addr, data );
     } else {
         LOG( LOG_ERR, "Failed to write value %d to memory with offset %d. Base pointer is null ", data, addr );
     }
 }
 
+void system_gdc_write_32_relaxed( uint32_t addr, uint32_t data )
+{
+    void *ptr = system_gdc_io_ptr( addr );
+    if ( ptr != NULL ) {
+        SYSTEM_GDC_TRACE_START( t0 );
+        writel_relaxed( data, ptr );
+        SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_WRITE_RELAXED, addr, data, t0 );
+        system_gdc_shadow_write( addr, data );
+    } else {
+        LOG( LOG_ERR, "Failed to write value %d to memory with offset %d. Base pointer is null ", data, addr );
+    }
+}
+
+void system_gdc_write_barrier( void )
+{
+    SYSTEM_GDC_TRACE_START( t0 );
+    wmb();
+    SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_BARRIER, 0, 0, t0 );
+}
+
+void system_gdc_write_list( const system_gdc_reg_write_t *list, uint32_t count )
+{
+    uint32_t i;
+    //no register list engine on the juno fpga, write from the cpu
+    for ( i = 0; i < count; i++ ) {
+        void *ptr = system_gdc_io_ptr( list[i].addr );
+        SYSTEM_GDC_TRACE_START( t0 );
+        if ( ptr == NULL ) {
+            LOG( LOG_ERR, "Failed to write value %d to memory with offset %d. Base pointer is null ", list[i].data, list[i].addr );
+            continue;
+        }
+#if GDC_RELAXED_MMIO
+        writel_relaxed( list[i].data, ptr );
+        SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_WRITE_RELAXED, list[i].addr, list[i].data, t0 );
+#else
+        iowrite32( list[i].data, ptr );
+        SYSTEM_GDC_TRACE( SYSTEM_GDC_TRACE_WRITE, list[i].addr, list[i].data, t0 );
+#endif
+        system_gdc_shadow_write( list[i].addr, list[i].data );
+    }
+}
@@ -0,0 +1,66 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//io instance bookkeeping shared by the kernel and the host io layers
+
+#include "acamera_driver_config.h"
+#include "system_gdc_io_ctx.h"
+
+system_gdc_io_ctx_t system_gdc_io_ctx[SYSTEM_GDC_IO_MAX_INSTANCES];
+
+system_gdc_io_ctx_t *system_gdc_io_get( uint32_t instance )
+{
+    if ( instance >= SYSTEM_GDC_IO_MAX_INSTANCES || system_gdc_io_ctx[instance].hw_base == NULL )
+        return NULL;
+    return &system_gdc_io_ctx[instance];
+}
+
+void system_gdc_io_number_cores( uint32_t instance )
+{
+    uint32_t i, first = 0;
+    for ( i = 0; i < instance; i++ ) {
+        if ( system_gdc_io_ctx[i].hw_base != NULL )
+            first += system_gdc_io_ctx[i].num_cores;
+    }
+    system_gdc_io_ctx[instance].first_core = first;
+}
+
+uint32_t system_gdc_io_opened( void )
+{
+    uint32_t i, opened = 0;
+    for ( i = 0; i < SYSTEM_GDC_IO_MAX_INSTANCES; i++ ) {
+        if ( system_gdc_io_ctx[i].hw_base != NULL )
+            opened++;
+    }
+    return opened;
+}
+
+int32_t system_gdc_io_core( uint32_t core, uint32_t *base, void **ddr )
+{
+    uint32_t i;
+    for ( i = 0; i < SYSTEM_GDC_IO_MAX_INSTANCES; i++ ) {
+        const system_gdc_io_ctx_t *ctx = &system_gdc_io_ctx[i];
+        if ( ctx->hw_base == NULL || core < ctx->first_core || core >= ctx->first_core + ctx->num_cores )
+            continue;
+        *base = SYSTEM_GDC_IO_BASE( i ) + ( core - ctx->first_core ) * GDC_CORE_BASE_STRIDE;
+        *ddr = ctx->ddr_base;
+        return 0;
+    }
+    return -1;
+}
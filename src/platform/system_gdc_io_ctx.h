@@ -0,0 +1,55 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __SYSTEM_GDC_IO_CTX_H__
+#define __SYSTEM_GDC_IO_CTX_H__
+
+#include "system_gdc_io.h"
+
+//contexts of the io instances, owned by the platform io layer
+extern system_gdc_io_ctx_t system_gdc_io_ctx[SYSTEM_GDC_IO_MAX_INSTANCES];
+
+//mapped address of a register, NULL when its instance is closed or the offset is outside the window
+static inline void *system_gdc_io_ptr( uint32_t addr )
+{
+    uint32_t instance = SYSTEM_GDC_IO_INSTANCE( addr );
+    uint32_t offset = addr & SYSTEM_GDC_IO_OFFSET_MASK;
+    system_gdc_io_ctx_t *ctx;
+
+    if ( instance >= SYSTEM_GDC_IO_MAX_INSTANCES )
+        return NULL;
+    ctx = &system_gdc_io_ctx[instance];
+    if ( ctx->hw_base == NULL || offset + 4 > ctx->hw_size )
+        return NULL;
+    return (uint8_t *)ctx->hw_base + offset;
+}
+
+/**
+ *   Number the cores of an instance after the cores of the instances before it
+ *
+ *   @param instance - io instance being opened
+ */
+void system_gdc_io_number_cores( uint32_t instance );
+
+/**
+ *   Number of opened instances
+ */
+uint32_t system_gdc_io_opened( void );
+
+#endif
@@ -0,0 +1,132 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+//shadow copies of the gdc register windows, shared by the kernel and the host io layers
+
+#include "acamera_driver_config.h"
+#include "system_gdc_shadow.h"
+
+#define SHADOW_UNKNOWN 0  //not written since the window was added, read on the bus
+#define SHADOW_VALID 1
+#define SHADOW_VOLATILE 2
+
+typedef struct shadow_window {
+    uint32_t addr;
+    uint32_t words;   //0 for a free slot
+    uint32_t first;   //first word of the window in shadow_data
+} shadow_window_t;
+
+static shadow_window_t shadow_windows[SYSTEM_GDC_SHADOW_MAX_WINDOWS];
+static uint32_t shadow_data[SYSTEM_GDC_SHADOW_WORDS];
+//one byte per word so cores updating their own windows never share a read-modify-write
+static uint8_t shadow_state[SYSTEM_GDC_SHADOW_WORDS];
+
+//returns the index of the register in shadow_data, -1 when no window holds it
+static int32_t shadow_find( uint32_t addr )
+{
+    uint32_t i;
+    for ( i = 0; i < SYSTEM_GDC_SHADOW_MAX_WINDOWS; i++ ) {
+        const shadow_window_t *w = &shadow_windows[i];
+        uint32_t offset = addr - w->addr;
+        if ( offset < w->words * 4 && ( offset & 3 ) == 0 )
+            return w->first + ( offset >> 2 );
+    }
+    return -1;
+}
+
+//first fit placement of a window in shadow_data
+static int32_t shadow_place( uint32_t words )
+{
+    uint32_t first = 0, i;
+    int moved = 1;
+    while ( moved ) {
+        moved = 0;
+        for ( i = 0; i < SYSTEM_GDC_SHADOW_MAX_WINDOWS; i++ ) {
+            const shadow_window_t *w = &shadow_windows[i];
+            if ( w->words && first < w->first + w->words && w->first < first + words ) {
+                first = w->first + w->words;
+                moved = 1;
+            }
+        }
+    }
+    return first + words <= SYSTEM_GDC_SHADOW_WORDS ? (int32_t)first : -1;
+}
+
+int32_t system_gdc_shadow_add( uint32_t addr, uint32_t size )
+{
+#if GDC_REG_SHADOW
+    uint32_t words = size >> 2, i;
+    shadow_window_t *slot = NULL;
+    int32_t first;
+
+    system_gdc_shadow_remove( addr );
+    for ( i = 0; i < SYSTEM_GDC_SHADOW_MAX_WINDOWS && slot == NULL; i++ ) {
+        if ( shadow_windows[i].words == 0 )
+            slot = &shadow_windows[i];
+    }
+    first = words ? shadow_place( words ) : -1;
+    if ( slot == NULL || first < 0 )
+        return -1;
+
+    system_memset( &shadow_state[first], SHADOW_UNKNOWN, words );
+    slot->addr = addr;
+    slot->first = first;
+    slot->words = words;
+#endif
+    return 0;
+}
+
+void system_gdc_shadow_remove( uint32_t addr )
+{
+    uint32_t i;
+    for ( i = 0; i < SYSTEM_GDC_SHADOW_MAX_WINDOWS; i++ ) {
+        if ( shadow_windows[i].words && shadow_windows[i].addr == addr )
+            shadow_windows[i].words = 0;
+    }
+}
+
+void system_gdc_shadow_volatile( uint32_t addr )
+{
+    int32_t index = shadow_find( addr );
+    if ( index >= 0 )
+        shadow_state[index] = SHADOW_VOLATILE;
+}
+
+void system_gdc_shadow_clear( void )
+{
+    system_memset( shadow_windows, 0, sizeof( shadow_windows ) );
+}
+
+int32_t system_gdc_shadow_read( uint32_t addr, uint32_t *data )
+{
+    int32_t index = shadow_find( addr );
+    if ( index < 0 || shadow_state[index] != SHADOW_VALID )
+        return -1;
+    *data = shadow_data[index];
+    return 0;
+}
+
+void system_gdc_shadow_write( uint32_t addr, uint32_t data )
+{
+    int32_t index = shadow_find( addr );
+    if ( index >= 0 && shadow_state[index] != SHADOW_VOLATILE ) {
+        shadow_data[index] = data;
+        shadow_state[index] = SHADOW_VALID;
+    }
+}
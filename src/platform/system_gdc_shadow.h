@@ -0,0 +1,50 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef __SYSTEM_GDC_SHADOW_H__
+#define __SYSTEM_GDC_SHADOW_H__
+
+#include "system_gdc_io.h"
+
+//words of all shadowed windows together
+#define SYSTEM_GDC_SHADOW_WORDS 1024
+#define SYSTEM_GDC_SHADOW_MAX_WINDOWS 8
+
+/**
+ *   Look a register up in the shadow, used by system_gdc_read_32
+ *
+ *   @param addr - offset of the register in GDC memory
+ *   @param data - register value when it is shadowed
+ *
+ *   @return 0 - data is valid
+ *           -1 - the register has to be read on the bus.
+ */
+int32_t system_gdc_shadow_read( uint32_t addr, uint32_t *data );
+
+/**
+ *   Record a register write, used by system_gdc_write_32
+ */
+void system_gdc_shadow_write( uint32_t addr, uint32_t data );
+
+/**
+ *   Drop all windows, used when the io mapping goes away
+ */
+void system_gdc_shadow_clear( void );
+
+#endif
@@ -0,0 +1,178 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "acamera_driver_config.h"
+
+#if GDC_MMIO_TRACE
+#include <linux/atomic.h>
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
+#include <linux/seq_file.h>
+#include <linux/vmalloc.h>
+
+#include "system_gdc_trace.h"
+#include "system_log.h"
+
+static system_gdc_trace_record_t *trace_ring = NULL;
+static atomic_t trace_head = ATOMIC_INIT( 0 );
+static uint32_t trace_cleared = 0;
+static struct dentry *trace_dir = NULL;
+
+u64 system_gdc_trace_time( void )
+{
+    return ktime_get_ns();
+}
+
+void system_gdc_trace_add( uint32_t op, uint32_t addr, uint32_t data, u64 start, const void *caller )
+{
+    system_gdc_trace_record_t *record;
+    uint32_t index;
+
+    if ( trace_ring == NULL )
+        return;
+    index = (uint32_t)atomic_inc_return( &trace_head ) - 1;
+    record = &trace_ring[index & ( SYSTEM_GDC_TRACE_SIZE - 1 )];
+    WRITE_ONCE( record->seq, 0 );
+    smp_wmb();
+    record->time = start;
+    record->duration = (uint32_t)( ktime_get_ns() - start );
+    record->addr = addr;
+    record->data = data;
+    record->op = op;
+    record->caller = caller;
+    smp_wmb();
+    WRITE_ONCE( record->seq, index + 1 );
+}
+
+int32_t system_gdc_trace_get( uint32_t index, system_gdc_trace_record_t *record )
+{
+    const system_gdc_trace_record_t *slot;
+
+    if ( trace_ring == NULL )
+        return -1;
+    slot = &trace_ring[index & ( SYSTEM_GDC_TRACE_SIZE - 1 )];
+    if ( READ_ONCE( slot->seq ) != index + 1 )
+        return -1;
+    smp_rmb();
+    *record = *slot;
+    smp_rmb();
+    //a writer that took the slot meanwhile has cleared seq
+    return READ_ONCE( slot->seq ) == index + 1 ? 0 : -1;
+}
+
+uint32_t system_gdc_trace_range( uint32_t *first )
+{
+    uint32_t head = (uint32_t)atomic_read( &trace_head );
+    uint32_t oldest = head > SYSTEM_GDC_TRACE_SIZE ? head - SYSTEM_GDC_TRACE_SIZE : 0;
+    *first = oldest > trace_cleared ? oldest : trace_cleared;
+    return head;
+}
+
+void system_gdc_trace_clear( void )
+{
+    trace_cleared = (uint32_t)atomic_read( &trace_head );
+}
+
+//seq_file iterator over the record numbers, records lost while reading are skipped
+static void *trace_seq_next( struct seq_file *m, void *v, loff_t *pos )
+{
+    uint32_t first, head = system_gdc_trace_range( &first );
+    uint32_t *index = m->private;
+
+    if ( v != NULL ) {
+        ( *index )++;
+        ( *pos )++;
+    }
+    if ( *index < first )
+        *index = first;
+    return *index < head ? index : NULL;
+}
+
+static void *trace_seq_start( struct seq_file *m, loff_t *pos )
+{
+    if ( *pos == 0 )
+        system_gdc_trace_range( (uint32_t *)m->private );
+    return trace_seq_next( m, NULL, pos );
+}
+
+static void trace_seq_stop( struct seq_file *m, void *v )
+{
+}
+
+static int trace_seq_show( struct seq_file *m, void *v )
+{
+    system_gdc_trace_record_t record;
+    if ( system_gdc_trace_get( *(uint32_t *)v, &record ) == 0 )
+        seq_printf( m, "%llu %u %c 0x%06x 0x%08x %pS\n", record.time, record.duration, record.op, record.addr, record.data, record.caller );
+    return 0;
+}
+
+static const struct seq_operations trace_seq_ops = {
+    .start = trace_seq_start,
+    .next = trace_seq_next,
+    .stop = trace_seq_stop,
+    .show = trace_seq_show,
+};
+
+static int trace_open( struct inode *inode, struct file *file )
+{
+    return seq_open_private( file, &trace_seq_ops, sizeof( uint32_t ) );
+}
+
+static ssize_t trace_write( struct file *file, const char __user *buf, size_t count, loff_t *ppos )
+{
+    system_gdc_trace_clear();
+    return count;
+}
+
+static const struct file_operations trace_fops = {
+    .owner = THIS_MODULE,
+    .open = trace_open,
+    .read = seq_read,
+    .write = trace_write,
+    .llseek = seq_lseek,
+    .release = seq_release_private,
+};
+
+int32_t system_gdc_trace_init( void )
+{
+    trace_ring = vzalloc( SYSTEM_GDC_TRACE_SIZE * sizeof( system_gdc_trace_record_t ) );
+    if ( trace_ring == NULL ) {
+        LOG( LOG_ERR, "Failed to allocate the mmio trace ring" );
+        return -1;
+    }
+    atomic_set( &trace_head, 0 );
+    trace_cleared = 0;
+    trace_dir = debugfs_create_dir( "gdc", NULL );
+    debugfs_create_file( "mmio_trace", 0600, trace_dir, NULL, &trace_fops );
+    return 0;
+}
+
+void system_gdc_trace_deinit( void )
+{
+    system_gdc_trace_record_t *ring = trace_ring;
+
+    debugfs_remove_recursive( trace_dir );
+    trace_dir = NULL;
+    trace_ring = NULL;
+    //the io layer is closed, no access can be recording anymore
+    vfree( ring );
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include <linux/kernel.h>
 #include <linux/interrupt.h>
 #include "system_log.h"
+#include "system_gdc_io.h"
 
 typedef enum {
   GDC_IRQ_STATUS_DEINIT = 0,
@@ -29,12 +30,14 @@ typedef enum {
   GDC_IRQ_STATUS_MAX
 } irq_status;
 
-#define MAX_GDC_CORES	2
+#define MAX_GDC_CORES	( SYSTEM_GDC_IO_MAX_INSTANCES * SYSTEM_GDC_IO_MAX_CORES )
 typedef struct dev_info{
 	int irq;
 	int flags;
 	system_interrupt_handler_t app_handler;
 	void* app_param;
+	system_interrupt_handler_t thread_handler;
+	void* thread_param;
 	irq_status status;
 }dev_irq_info;
 static dev_irq_info gdc_irq[MAX_GDC_CORES] = {0};
@@ -42,12 +45,24 @@ static dev_irq_info gdc_irq[MAX_GDC_CORES] = {0};
 
 static irqreturn_t system_interrupt_handler(int irq, void *dev_id)
 {
-	int core_id = (int) dev_id;
+	int core_id = (long) dev_id;
 	LOG(LOG_DEBUG, "GDC core %d: interrupt comes in (irq = %d)", core_id, irq);
-	if(core_id < MAX_GDC_CORES && gdc_irq[core_id].app_handler)
+	if(core_id >= MAX_GDC_CORES)
+		return IRQ_NONE;
+	if(gdc_irq[core_id].app_handler)
 		gdc_irq[core_id].app_handler(gdc_irq[core_id].app_param, 1);
 
-  return IRQ_HANDLED;
+	//the rest of the work is done with interrupts enabled
+	return gdc_irq[core_id].thread_handler ? IRQ_WAKE_THREAD : IRQ_HANDLED;
+}
+
+static irqreturn_t system_interrupt_thread(int irq, void *dev_id)
+{
+	int core_id = (long) dev_id;
+	if(core_id < MAX_GDC_CORES && gdc_irq[core_id].thread_handler)
+		gdc_irq[core_id].thread_handler(gdc_irq[core_id].thread_param, 1);
+
+	return IRQ_HANDLED;
 }
 
 void system_interrupts_set_irq(int id, int irq_num, int flags)
@@ -79,7 +94,7 @@ void system_interrupts_init( int id)
 			gdc_irq[id].flags);
 
  	if(gdc_irq[id].irq >= 0) {
-		ret=request_irq(gdc_irq[id].irq, &system_interrupt_handler, gdc_irq[id].flags, "gdc", id);
+		ret=request_threaded_irq(gdc_irq[id].irq, &system_interrupt_handler, &system_interrupt_thread, gdc_irq[id].flags, "gdc", (void *)(long)id);
 		if(ret != 0) {
 			LOG(LOG_ERR, "Could not get interrupt %d (ret=%d)\n", gdc_irq[id].irq, ret);
 		} else {
@@ -98,6 +113,14 @@ void system_interrupt_set_handler(int id, system_interrupt_handler_t handler, vo
 	}
 }
 
+void system_interrupt_set_thread_handler(int id, system_interrupt_handler_t handler, void *param )
+{
+	if(id < MAX_GDC_CORES) {
+		gdc_irq[id].thread_handler = handler;
+		gdc_irq[id].thread_param = param;
+	}
+}
+
 void system_interrupts_deinit( int id )
 {
 	if(id < MAX_GDC_CORES) {
@@ -106,13 +129,15 @@ void system_interrupts_deinit( int id )
 			gdc_irq[id].irq, gdc_irq[id].status );
 		} else {
 			gdc_irq[id].status = GDC_IRQ_STATUS_DEINIT;
-			free_irq( gdc_irq[id].irq, NULL );
+			free_irq( gdc_irq[id].irq, (void *)(long)id );
 			LOG( LOG_INFO, "Interrupt %d released\n", gdc_irq[id].irq );
 			gdc_irq[id].irq = 0;
 			gdc_irq[id].flags = 0;
 		}
 		gdc_irq[id].app_handler = NULL;
 		gdc_irq[id].app_param = NULL;
+		gdc_irq[id].thread_handler = NULL;
+		gdc_irq[id].thread_param = NULL;
 	}
 
 }
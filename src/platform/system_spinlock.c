@@ -0,0 +1,53 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+
+#include "system_spinlock.h"
+
+int32_t system_spinlock_init( sys_spinlock *lock )
+{
+    spinlock_t *slock = kmalloc( sizeof( spinlock_t ), GFP_KERNEL );
+    if ( slock == NULL ) {
+        *lock = NULL;
+        return -1;
+    }
+    spin_lock_init( slock );
+    *lock = slock;
+    return 0;
+}
+
+unsigned long system_spinlock_lock( sys_spinlock lock )
+{
+    unsigned long flags = 0;
+    spin_lock_irqsave( (spinlock_t *)lock, flags );
+    return flags;
+}
+
+void system_spinlock_unlock( sys_spinlock lock, unsigned long flags )
+{
+    spin_unlock_irqrestore( (spinlock_t *)lock, flags );
+}
+
+void system_spinlock_destroy( sys_spinlock lock )
+{
+    kfree( lock );
+}
@@ -16,21 +16,28 @@
 * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 *
 */
-
+#include "acamera_driver_config.h"
 #include "system_stdlib.h"
+#include "system_gdc_io.h"
 #include "linux/string.h"
 
 #include <asm/io.h>
+#include <linux/crc32.h>
+#include <linux/delay.h>
+#include <linux/ktime.h>
 
+#define JUNO_LOGIC_TILE_DDR_OFFSET ( 0x64400000 )
+#define JUNO_LOGIC_TILE_DDR_SIZE ( 0x06FFFFFF )
 
+//ddr window of the first gdc device, the logic tile window unless the device tree gave one
 void * system_ddr_mem_init() {
-	void *p_base=0;
+	system_gdc_io_ctx_t *ctx = system_gdc_io_get( 0 );
 #if HAS_FPGA_WRAPPER
-#define JUNO_LOGIC_TILE_DDR_OFFSET ( 0x64400000 )
-#define JUNO_LOGIC_TILE_DDR_SIZE ( 0x06FFFFFF )
- 	p_base = ioremap(JUNO_LOGIC_TILE_DDR_OFFSET, JUNO_LOGIC_TILE_DDR_SIZE);
+	if ( ctx != NULL && ctx->ddr_base == NULL ) {
+		system_gdc_io_map_ddr( 0, JUNO_LOGIC_TILE_DDR_OFFSET, JUNO_LOGIC_TILE_DDR_SIZE );
+	}
 #endif
-	return p_base ;
+	return ctx ? ctx->ddr_base : NULL ;
 }
 
 int32_t system_memcpy( void* dst, const void* src, uint32_t size ) {
@@ -45,3 +52,26 @@ int32_t system_memset( void* ptr, uint8_t value, uint32_t size ) {
 	memset( ptr, value, size ) ;
 	return result ;
 }
+
+
+uint32_t system_crc32( uint32_t crc, const void *data, uint32_t size ) {
+	return ~crc32_le( ~crc, data, size ) ;
+}
+
+
+u64 system_time_ns( void ) {
+	return ktime_get_ns() ;
+}
+
+
+//below this a timer wakeup costs more than it saves
+#define SYSTEM_SLEEP_SPIN_NS ( 10000 )
+
+void system_sleep_ns( u64 ns ) {
+	if ( ns < SYSTEM_SLEEP_SPIN_NS ) {
+		ndelay( ns ) ;
+	} else {
+		//usleep_range sleeps on a hrtimer, the slack lets it merge with other wakeups
+		usleep_range( ns / 1000, ns / 1000 + 2 ) ;
+	}
+}
@@ -0,0 +1,92 @@
+/*
+*
+* SPDX-License-Identifier: GPL-2.0
+*
+* Copyright (C) 2011-2018 ARM or its affiliates
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; version 2.
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include <linux/slab.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/workqueue.h>
+
+#include "system_timer.h"
+
+typedef struct system_timer {
+    struct hrtimer timer;
+    system_timer_handler_t handler;
+    system_timer_handler_t thread_handler;
+    struct work_struct work;
+    void *param;
+} system_timer_t;
+
+static void system_timer_work( struct work_struct *work )
+{
+    system_timer_t *t = container_of( work, system_timer_t, work );
+    t->thread_handler( t->param );
+}
+
+static enum hrtimer_restart system_timer_expired( struct hrtimer *hrtimer )
+{
+    system_timer_t *t = container_of( hrtimer, system_timer_t, timer );
+    if ( t->handler ) {
+        t->handler( t->param );
+    }
+    if ( t->thread_handler ) {
+        queue_work( system_highpri_wq, &t->work );
+    }
+    return HRTIMER_NORESTART;
+}
+
+int32_t system_timer_init( sys_timer *timer, system_timer_handler_t handler, void *param )
+{
+    system_timer_t *t = kzalloc( sizeof( system_timer_t ), GFP_KERNEL );
+    if ( t == NULL ) {
+        *timer = NULL;
+        return -1;
+    }
+    hrtimer_init( &t->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL );
+    t->timer.function = system_timer_expired;
+    INIT_WORK( &t->work, system_timer_work );
+    t->handler = handler;
+    t->param = param;
+    *timer = t;
+    return 0;
+}
+
+void system_timer_set_thread_handler( sys_timer timer, system_timer_handler_t handler )
+{
+    ( (system_timer_t *)timer )->thread_handler = handler;
+}
+
+void system_timer_arm( sys_timer timer, u64 timeout_ns )
+{
+    hrtimer_start( &( (system_timer_t *)timer )->timer, ns_to_ktime( timeout_ns ), HRTIMER_MODE_REL );
+}
+
+void system_timer_cancel( sys_timer timer )
+{
+    //hrtimer_cancel would wait for the handler forever when called from it
+    hrtimer_try_to_cancel( &( (system_timer_t *)timer )->timer );
+}
+
+void system_timer_destroy( sys_timer timer )
+{
+    if ( timer ) {
+        hrtimer_cancel( &( (system_timer_t *)timer )->timer );
+        cancel_work_sync( &( (system_timer_t *)timer )->work );
+        kfree( timer );
+    }
+}